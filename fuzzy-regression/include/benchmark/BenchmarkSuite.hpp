@@ -0,0 +1,107 @@
+#ifndef FUZZY_REGRESSION_BENCHMARKSUITE_HPP
+#define FUZZY_REGRESSION_BENCHMARKSUITE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "regression/FuzzyRegression.hpp"
+
+struct BenchmarkCase{
+    std::size_t numberOfData;
+    std::size_t numberOfDescribingAttributes;
+    int numberOfClusters;
+    ClusteringEngine clusteringEngine;
+    ClusteringPrecision clusteringPrecision;
+};
+
+// durations are in nanoseconds
+struct BenchmarkStatistics{
+    std::string stage;
+    BenchmarkCase benchmarkCase;
+    std::size_t numberOfRepetitions;
+    double minimum;
+    double median;
+    double mean;
+    double standardDeviation;
+    double maximum;
+};
+
+struct BenchmarkSettings{
+    std::vector<std::size_t> dataSizes;
+    std::vector<std::size_t> describingAttributeCounts;
+    std::vector<int> clusterCounts;
+    std::vector<ClusteringEngine> clusteringEngines;
+    // precisions of the native engine, ksi::fcm always runs in double precision
+    std::vector<ClusteringPrecision> clusteringPrecisions;
+    std::size_t numberOfRepetitions;
+    std::uint64_t seed;
+};
+
+// Runs FuzzyRegression::processDataset over a grid of synthetic datasets and summarises the duration
+// of every stage (clustering, data preparation, regression, error calculation) and of the whole run.
+// Every dataset is generated by LinearRegressionDataGenerator from the same seed, so that results of
+// different builds are comparable. Cases clustered in mixed precision also report to the progress stream
+// how far their regression coefficients and error are from the native double-precision case, when that
+// case is benchmarked before them.
+class BenchmarkSuite{
+private:
+    const BenchmarkSettings settings;
+public:
+    explicit BenchmarkSuite(BenchmarkSettings settings);
+
+    [[nodiscard]]
+    std::vector<BenchmarkStatistics> run(std::ostream& progressStream) const;
+
+    // clusters every dataset of the grid with the native engine and with ksi::fcm, matches their clusters by
+    // nearest centres and prints the largest centre difference (relative to the largest magnitude of the
+    // attribute) and membership difference of every case; the weighted regression on the native centres is
+    // solved by WeightedLeastSquares and by the ksi regression, printing the largest coefficient difference
+    // relative to the largest coefficient; returns the number of comparisons above the tolerance
+    [[nodiscard]]
+    std::size_t verifyAgainstKsi(std::ostream& outputStream, double tolerance) const;
+
+    static void writeCsv(std::ostream& outputStream, const std::vector<BenchmarkStatistics>& results);
+    static void writeJson(std::ostream& outputStream, const std::vector<BenchmarkStatistics>& results);
+
+    // reads results written by writeCsv, throws std::runtime_error on malformed input
+    [[nodiscard]]
+    static std::vector<BenchmarkStatistics> readCsv(std::istream& inputStream);
+
+    // prints every stage whose median got slower than the baseline one by more than the tolerance (0.1 = 10%),
+    // returns the number of such stages
+    static std::size_t reportRegressions(std::ostream& outputStream,
+                                         const std::vector<BenchmarkStatistics>& baseline,
+                                         const std::vector<BenchmarkStatistics>& results,
+                                         double tolerance);
+
+    // "native-mixed" for native mixed-precision clustering
+    [[nodiscard]]
+    static std::string engineName(ClusteringEngine clusteringEngine,
+                                  ClusteringPrecision clusteringPrecision = ClusteringPrecision::DOUBLE);
+private:
+    [[nodiscard]]
+    std::vector<double> generateAttributeMajorData(const BenchmarkCase& benchmarkCase) const;
+
+    // lastResult gets the regression result of the last repetition
+    [[nodiscard]]
+    static std::vector<BenchmarkStatistics> runCase(const BenchmarkCase& benchmarkCase,
+                                                    const ksi::dataset* dataset,
+                                                    const MatrixView<const double>& attributeMajorData,
+                                                    std::size_t numberOfRepetitions,
+                                                    std::optional<RegressionResult>& lastResult);
+
+    static void reportAccuracy(std::ostream& progressStream,
+                               const RegressionResult& doublePrecisionResult,
+                               const RegressionResult& result);
+
+    [[nodiscard]]
+    static BenchmarkStatistics summarise(const std::string& stage,
+                                         const BenchmarkCase& benchmarkCase,
+                                         std::vector<double> samples);
+};
+
+#endif // FUZZY_REGRESSION_BENCHMARKSUITE_HPP
@@ -0,0 +1,66 @@
+#ifndef FUZZY_REGRESSION_RESULTCACHE_HPP
+#define FUZZY_REGRESSION_RESULTCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// everything needed to report one cluster count again without clustering
+struct CachedClusterRun{
+    std::vector<double> regressionCoefficients;
+    double regressionError;
+    // one row per cluster
+    std::vector<double> clusterCentres;
+    std::size_t numberOfAttributes;
+    int numberOfIterations;
+};
+
+// Directory of results addressed by a hash of their key, one file per entry.
+// Entries are written to a temporary file and renamed into place, so concurrent runs sharing the
+// directory only ever see whole entries. The modification time of an entry is its last use,
+// evictLeastRecentlyUsed removes the oldest entries until the directory fits its size bound.
+class ResultCache{
+public:
+    constexpr static const char* FILE_EXTENSION = ".frcache";
+    constexpr static const char* TEMPORARY_FILE_EXTENSION = ".tmp";
+    // part of every key, has to be increased whenever a change alters the results of the clustering or regression
+    constexpr static const int ENGINE_VERSION = 1;
+private:
+    constexpr static const char* MAGIC = "fuzzy-regression-cache";
+    constexpr static const int FORMAT_VERSION = 1;
+
+    const std::filesystem::path directory;
+    const std::uintmax_t maximalSizeInBytes;
+public:
+    ResultCache(std::filesystem::path directory, std::uintmax_t maximalSizeInBytes);
+
+    // marks the entry as recently used when it is found
+    [[nodiscard]]
+    std::optional<CachedClusterRun> find(const std::string& key) const;
+
+    void store(const std::string& key, const CachedClusterRun& cachedClusterRun) const;
+
+    // returns the number of removed entries
+    std::size_t evictLeastRecentlyUsed() const;
+
+    // FNV-1a, seed chains the hash over several pieces
+    [[nodiscard]]
+    static std::uint64_t hashBytes(const char* data, std::size_t size, std::uint64_t seed = 14695981039346656037ull);
+
+    [[nodiscard]]
+    static std::uint64_t hashFile(const std::filesystem::path& filePath);
+private:
+    [[nodiscard]]
+    std::filesystem::path entryPath(const std::string& key) const;
+
+    [[nodiscard]]
+    static std::optional<CachedClusterRun> parseEntry(const std::string& content, const std::string& key);
+
+    [[nodiscard]]
+    static std::string formatEntry(const std::string& key, const CachedClusterRun& cachedClusterRun);
+};
+
+#endif // FUZZY_REGRESSION_RESULTCACHE_HPP
@@ -0,0 +1,41 @@
+#ifndef FUZZY_REGRESSION_CORESET_HPP
+#define FUZZY_REGRESSION_CORESET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "matrix/MatrixView.hpp"
+
+// Weighted sample standing in for the whole dataset during clustering (lightweight coreset, Bachem, Lucic
+// and Krause, "Scalable k-means clustering via lightweight coresets"). Datum x is drawn with probability
+// q(x) = 1 / (2n) + d(x, mean)^2 / (2 sum of d^2) and weighted 1 / (m q(x)), so the weighted clustering
+// cost of any centres is an unbiased estimate of their cost on the whole data. For k-means
+// m in O((d k log k + log 1/delta) / eps^2) draws keep the error within eps (cost + cost of the mean)
+// with probability 1 - delta, for fuzzy c-means the error is measured instead, see FuzzyRegression.
+// Building it takes two passes over the data, datums drawn more than once are stored once.
+class Coreset{
+    constexpr static const std::uint64_t SEED_DEFAULT_VALUE = 5489u;
+private:
+    std::vector<double> attributeMajorPoints;
+    std::vector<double> weights;
+    std::size_t numberOfAttributes = 0;
+    std::size_t numberOfPoints = 0;
+public:
+    // numberOfDraws at least as large as the data keeps every datum with weight 1;
+    // rows of attributeMajorData have to be contiguous
+    [[nodiscard]]
+    static Coreset sample(const MatrixView<const double>& attributeMajorData,
+                          std::size_t numberOfDraws,
+                          std::uint64_t seed = SEED_DEFAULT_VALUE);
+
+    // one row per attribute, one column per point
+    [[nodiscard]]
+    MatrixView<const double> getPoints() const;
+
+    // sum to about the number of datums of the sampled data
+    [[nodiscard]]
+    const std::vector<double>& getWeights() const;
+};
+
+#endif // FUZZY_REGRESSION_CORESET_HPP
@@ -0,0 +1,47 @@
+#ifndef FUZZY_REGRESSION_FIXEDDIMENSIONKERNELS_HPP
+#define FUZZY_REGRESSION_FIXEDDIMENSIONKERNELS_HPP
+
+#include <cstddef>
+
+#include "matrix/MatrixView.hpp"
+
+// Kernels instantiated for every number of attributes up to MAX_SPECIALISED_DIMENSION.
+// With the dimension known at compile time the attribute loop is unrolled and every datum is finished
+// in registers, instead of one pass over a block per attribute as in SimdKernels. Results are bit
+// identical to the SimdKernels loops they replace, only the number of passes over memory changes.
+class FixedDimensionKernels{
+public:
+    constexpr static const std::size_t MAX_SPECIALISED_DIMENSION = 16;
+
+    // attributeMajorData has contiguous rows, one per attribute, the kernels work on columns
+    // blockStart ... blockStart + blockLength - 1 of it
+    struct Table{
+        // distances[i] = sum over attributes of (x - centre)^2
+        void (*squaredDistances)(const MatrixView<const double>& attributeMajorData,
+                                 std::size_t blockStart,
+                                 std::size_t blockLength,
+                                 const double* centre,
+                                 double* distances);
+
+        // squared distances inverted as in SimdKernels::invertAndAccumulate, reciprocalSums[i] += reciprocals[i]
+        void (*reciprocalSquaredDistances)(const MatrixView<const double>& attributeMajorData,
+                                           std::size_t blockStart,
+                                           std::size_t blockLength,
+                                           const double* centre,
+                                           double* reciprocals,
+                                           double* reciprocalSums);
+
+        // weightedSums[attribute] += sum of weights[i] * x[attribute][i], weights start at the block
+        void (*accumulateWeightedSums)(const MatrixView<const double>& attributeMajorData,
+                                       std::size_t blockStart,
+                                       std::size_t blockLength,
+                                       const double* weights,
+                                       double* weightedSums);
+    };
+
+    // nullptr for dimensions which are not specialised, callers fall back to SimdKernels then
+    [[nodiscard]]
+    static const Table* forDimension(std::size_t dimension);
+};
+
+#endif // FUZZY_REGRESSION_FIXEDDIMENSIONKERNELS_HPP
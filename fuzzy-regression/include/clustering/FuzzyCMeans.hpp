@@ -0,0 +1,149 @@
+#ifndef FUZZY_REGRESSION_FUZZYCMEANS_HPP
+#define FUZZY_REGRESSION_FUZZYCMEANS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <common/dataset.h>
+#include <partitions/partition.h>
+
+#include "matrix/MatrixView.hpp"
+
+// memberships which were not pruned, in compressed sparse rows: the entries of datum i are the positions
+// datumOffsets[i] to datumOffsets[i + 1] of clusterIndices and memberships, sorted by cluster
+struct SparseMembershipMatrix{
+    std::vector<std::size_t> datumOffsets;
+    std::vector<std::uint32_t> clusterIndices;
+    std::vector<double> memberships;
+
+    [[nodiscard]]
+    bool empty() const;
+
+    // adds to datumCountsPerCluster the number of datums with the highest kept membership in every cluster
+    void countHighestMemberships(std::size_t numberOfClusters, std::vector<std::size_t>& datumCountsPerCluster) const;
+};
+
+struct FuzzyPartition{
+    std::size_t numberOfClusters;
+    std::size_t numberOfAttributes;
+    std::size_t numberOfData;
+    // numberOfClusters x numberOfAttributes, one cluster centre after another
+    std::vector<double> clusterCentres;
+    // numberOfClusters x numberOfData, memberships of all datums to one cluster after another (ksi::partition layout)
+    std::vector<double> partitionMatrix;
+    int numberOfIterations;
+    // number of datums closest to every cluster, filled by engines which do not keep the partition matrix
+    std::vector<std::size_t> datumCountsPerCluster;
+    // filled instead of partitionMatrix by SparseFuzzyCMeans
+    SparseMembershipMatrix sparseMemberships;
+
+    [[nodiscard]]
+    static FuzzyPartition fromKsiPartition(const ksi::partition& partition);
+
+    // numberOfClusters x numberOfAttributes view of clusterCentres
+    [[nodiscard]]
+    MatrixView<const double> getClusterCentres() const;
+
+    // numberOfClusters x numberOfData view of partitionMatrix
+    [[nodiscard]]
+    MatrixView<const double> getPartitionMatrix() const;
+};
+
+// Fuzzy c-means working on contiguous buffers, drop-in replacement for ksi::fcm.
+// Data is kept attribute after attribute (structure of arrays) so that distance,
+// membership and centre update kernels run over contiguous memory and vectorise.
+class FuzzyCMeans{
+    constexpr static const double EPSILON_DEFAULT_VALUE = 1e-8;
+    constexpr static const double FUZZIFICATION_DEFAULT_VALUE = 2.0;
+    constexpr static const int MAXIMAL_NUMBER_OF_ITERATIONS_DEFAULT_VALUE = 100;
+    constexpr static const unsigned int SEED_DEFAULT_VALUE = 5489u;
+    // number of datums processed together so that their attributes, distances and memberships stay in cache
+    constexpr static const std::size_t DATUM_BLOCK_SIZE = 512;
+private:
+    int numberOfClusters;
+    double epsilon;
+    double fuzzification;
+    int maximalNumberOfIterations;
+    unsigned int seed;
+public:
+    FuzzyCMeans() noexcept;
+
+    void setNumberOfClusters(int numberOfClusters);
+    void setEpsilonForFrobeniusNorm(double epsilon);
+    void setFuzzification(double fuzzification);
+    void setMaximalNumberOfIterations(int maximalNumberOfIterations);
+    void setSeed(unsigned int seed);
+
+    [[nodiscard]]
+    FuzzyPartition doPartition(const ksi::dataset& dataset) const;
+
+    // attributeMajorData has one row per attribute and one column per datum, rows which are not
+    // contiguous in memory are copied once before clustering
+    [[nodiscard]]
+    FuzzyPartition doPartition(const MatrixView<const double>& attributeMajorData) const;
+
+    // starts from the given numberOfClusters x numberOfAttributes centres instead of a random partition
+    [[nodiscard]]
+    FuzzyPartition doPartition(const MatrixView<const double>& attributeMajorData,
+                               const std::vector<double>& initialClusterCentres) const;
+
+    // every datum counts datumWeights[datum] times in the centres, e.g. the points of a Coreset
+    [[nodiscard]]
+    FuzzyPartition doWeightedPartition(const MatrixView<const double>& attributeMajorData,
+                                       const std::vector<double>& datumWeights) const;
+
+    // fuzzy c-means objective of the centres with the memberships they induce,
+    // sum over datums of weight * (sum over clusters of d^(-2 / (m - 1)))^-(m - 1); no weights count every datum once
+    [[nodiscard]]
+    double calculateObjective(const MatrixView<const double>& attributeMajorData,
+                              const std::vector<double>& clusterCentres,
+                              const std::vector<double>& datumWeights = {}) const;
+
+    // centres for one cluster more than in partition: the cluster with the largest
+    // fuzzy within-cluster error is split in two along its per-attribute spread,
+    // rows of attributeMajorData have to be contiguous
+    [[nodiscard]]
+    std::vector<double> splitWorstFittingCluster(const MatrixView<const double>& attributeMajorData,
+                                                 const FuzzyPartition& partition) const;
+
+    // adds to datumCountsPerCluster the number of datums nearest to every centre, which is the cluster
+    // of their highest membership for any fuzzification exponent
+    static void countNearestDatums(const MatrixView<const double>& attributeMajorData,
+                                   const std::vector<double>& clusterCentres,
+                                   std::vector<std::size_t>& datumCountsPerCluster);
+
+    // adds to datumCountsPerCluster the number of datums with the highest membership in every cluster,
+    // partitionMatrix has one row per cluster and one column per datum and is read in a single pass
+    static void countHighestMemberships(const MatrixView<const double>& partitionMatrix,
+                                        std::vector<std::size_t>& datumCountsPerCluster);
+
+    [[nodiscard]]
+    static std::vector<double> flattenDatasetByAttributes(const ksi::dataset& dataset);
+
+    [[nodiscard]]
+    static std::vector<double> copyToContiguousRows(const MatrixView<const double>& matrix);
+
+private:
+    void validateParameters(std::size_t numberOfData) const;
+
+    void initialisePartitionMatrix(FuzzyPartition& partition) const;
+
+    // empty datumWeights weight every datum with 1
+    void iterateUntilConvergence(const MatrixView<const double>& attributeMajorData,
+                                 FuzzyPartition& partition,
+                                 const std::vector<double>& datumWeights = {}) const;
+
+    void updateClusterCentres(const MatrixView<const double>& attributeMajorData,
+                              FuzzyPartition& partition,
+                              std::vector<double>& scratch,
+                              const std::vector<double>& datumWeights) const;
+
+    [[nodiscard]]
+    double updatePartitionMatrix(const MatrixView<const double>& attributeMajorData,
+                                 FuzzyPartition& partition,
+                                 std::vector<double>& scratch,
+                                 std::vector<double>& reciprocalSums) const;
+};
+
+#endif // FUZZY_REGRESSION_FUZZYCMEANS_HPP
@@ -0,0 +1,43 @@
+#ifndef FUZZY_REGRESSION_MINIBATCHFUZZYCMEANS_HPP
+#define FUZZY_REGRESSION_MINIBATCHFUZZYCMEANS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "clustering/FuzzyCMeans.hpp"
+#include "streams/BatchSource.hpp"
+
+// Out-of-core fuzzy c-means. Every batch is clustered with FuzzyCMeans starting from the current
+// centres, the batch centres are then merged into the global ones weighted by the summed memberships
+// (single-pass FCM). A second pass counts the datums nearest to every final centre, so memory is
+// bounded by batch size x number of clusters and the partition matrix is never materialised.
+class MiniBatchFuzzyCMeans{
+    constexpr static const double EPSILON_DEFAULT_VALUE = 1e-8;
+    constexpr static const int NUMBER_OF_EPOCHS_DEFAULT_VALUE = 2;
+    constexpr static const int MAXIMAL_NUMBER_OF_ITERATIONS_PER_BATCH_DEFAULT_VALUE = 20;
+private:
+    int numberOfClusters;
+    double epsilon;
+    int numberOfEpochs;
+    int maximalNumberOfIterationsPerBatch;
+public:
+    MiniBatchFuzzyCMeans() noexcept;
+
+    void setNumberOfClusters(int numberOfClusters);
+    void setEpsilonForFrobeniusNorm(double epsilon);
+    void setNumberOfEpochs(int numberOfEpochs);
+    void setMaximalNumberOfIterationsPerBatch(int maximalNumberOfIterationsPerBatch);
+
+    // returned partition has cluster centres and datum counts, its partition matrix is empty
+    [[nodiscard]]
+    FuzzyPartition doPartition(BatchSource& batchSource) const;
+private:
+    [[nodiscard]]
+    FuzzyCMeans createBatchAlgorithm() const;
+
+    static void mergeBatchCentres(const FuzzyPartition& batchPartition,
+                                  std::vector<double>& clusterCentres,
+                                  std::vector<double>& accumulatedWeights);
+};
+
+#endif // FUZZY_REGRESSION_MINIBATCHFUZZYCMEANS_HPP
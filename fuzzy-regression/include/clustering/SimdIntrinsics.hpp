@@ -0,0 +1,52 @@
+#ifndef FUZZY_REGRESSION_SIMDINTRINSICS_HPP
+#define FUZZY_REGRESSION_SIMDINTRINSICS_HPP
+
+// Small intrinsic helpers shared by the vectorised kernels, only available when compiling for AVX2 or wider.
+#if defined(__AVX512F__) || defined(__AVX2__)
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12 reports the deliberately undefined vectors of its own AVX-512 header as uninitialised once inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__AVX2__)
+namespace SimdIntrinsics {
+    inline double horizontalSum(__m256d vector) {
+        __m128d lowerHalf = _mm256_castpd256_pd128(vector);
+        __m128d upperHalf = _mm256_extractf128_pd(vector, 1);
+        __m128d pairSum = _mm_add_pd(lowerHalf, upperHalf);
+        __m128d swapped = _mm_unpackhi_pd(pairSum, pairSum);
+        return _mm_cvtsd_f64(_mm_add_sd(pairSum, swapped));
+    }
+
+    inline __m256d multiplyAdd(__m256d first, __m256d second, __m256d addend) {
+#if defined(__FMA__)
+        return _mm256_fmadd_pd(first, second, addend);
+#else
+        return _mm256_add_pd(_mm256_mul_pd(first, second), addend);
+#endif
+    }
+
+    inline float horizontalSum(__m256 vector) {
+        __m128 pairSum = _mm_add_ps(_mm256_castps256_ps128(vector), _mm256_extractf128_ps(vector, 1));
+        __m128 quadSum = _mm_add_ps(pairSum, _mm_movehl_ps(pairSum, pairSum));
+        return _mm_cvtss_f32(_mm_add_ss(quadSum, _mm_movehdup_ps(quadSum)));
+    }
+
+    inline __m256 multiplyAdd(__m256 first, __m256 second, __m256 addend) {
+#if defined(__FMA__)
+        return _mm256_fmadd_ps(first, second, addend);
+#else
+        return _mm256_add_ps(_mm256_mul_ps(first, second), addend);
+#endif
+    }
+}
+#endif
+
+#endif // FUZZY_REGRESSION_SIMDINTRINSICS_HPP
@@ -0,0 +1,88 @@
+#ifndef FUZZY_REGRESSION_SIMDKERNELS_HPP
+#define FUZZY_REGRESSION_SIMDKERNELS_HPP
+
+#include <cstddef>
+
+// Contiguous array kernels used by the native clustering engine.
+// Every kernel has an AVX-512, an AVX2 and a scalar variant, the widest one
+// supported by the compilation target is selected at compile time.
+// Single-precision overloads process twice as many values per instruction.
+class SimdKernels{
+public:
+    constexpr static const double MINIMAL_DISTANCE = 1e-300;
+    // MINIMAL_DISTANCE is below the smallest float
+    constexpr static const float MINIMAL_SINGLE_PRECISION_DISTANCE = 1e-30f;
+
+    [[nodiscard]]
+    static const char* instructionSetName();
+
+    // accumulator[i] += (values[i] - reference)^2
+    static void accumulateSquaredDifferences(const double* values,
+                                             double reference,
+                                             double* accumulator,
+                                             std::size_t count);
+
+    // distances[i] = 1 / max(distances[i], MINIMAL_DISTANCE), reciprocalSums[i] += distances[i]
+    static void invertAndAccumulate(double* distances,
+                                    double* reciprocalSums,
+                                    std::size_t count);
+
+    // memberships[i] = reciprocals[i] / reciprocalSums[i], returns sum of squared membership changes
+    static double normaliseMemberships(const double* reciprocals,
+                                       const double* reciprocalSums,
+                                       double* memberships,
+                                       std::size_t count);
+
+    // where memberships[i] > highestMemberships[i]: highestMemberships[i] = memberships[i], highestClusters[i] = cluster
+    static void updateHighestMemberships(const double* memberships,
+                                         double cluster,
+                                         double* highestMemberships,
+                                         double* highestClusters,
+                                         std::size_t count);
+
+    // output[i] = values[i]^2
+    static void square(const double* values, double* output, std::size_t count);
+
+    [[nodiscard]]
+    static double sum(const double* values, std::size_t count);
+
+    [[nodiscard]]
+    static double dotProduct(const double* first, const double* second, std::size_t count);
+
+    // accumulator[i] += factor * values[i]
+    static void accumulateScaled(const double* values,
+                                 double factor,
+                                 double* accumulator,
+                                 std::size_t count);
+
+    // sum of (first[i] - second[i])^2
+    [[nodiscard]]
+    static double sumOfSquaredDifferences(const double* first, const double* second, std::size_t count);
+
+    static void accumulateSquaredDifferences(const float* values,
+                                             float reference,
+                                             float* accumulator,
+                                             std::size_t count);
+
+    // distances[i] = 1 / max(distances[i], MINIMAL_SINGLE_PRECISION_DISTANCE), reciprocalSums[i] += distances[i]
+    static void invertAndAccumulate(float* distances,
+                                    float* reciprocalSums,
+                                    std::size_t count);
+
+    static double normaliseMemberships(const float* reciprocals,
+                                       const float* reciprocalSums,
+                                       float* memberships,
+                                       std::size_t count);
+
+    static void square(const float* values, float* output, std::size_t count);
+
+    // summed in single precision like dotProduct
+    [[nodiscard]]
+    static float sum(const float* values, std::size_t count);
+
+    // summed in single precision, callers keep count small, e.g. one block of datums
+    [[nodiscard]]
+    static float dotProduct(const float* first, const float* second, std::size_t count);
+};
+
+#endif // FUZZY_REGRESSION_SIMDKERNELS_HPP
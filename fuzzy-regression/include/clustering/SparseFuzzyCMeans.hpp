@@ -0,0 +1,86 @@
+#ifndef FUZZY_REGRESSION_SPARSEFUZZYCMEANS_HPP
+#define FUZZY_REGRESSION_SPARSEFUZZYCMEANS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "clustering/FuzzyCMeans.hpp"
+
+// Fuzzy c-means keeping only the largest memberships of every datum. A membership update computes the
+// distances to all centres, keeps at most maximalNumberOfMemberships of the highest memberships which
+// are not below membershipThreshold and normalises them to sum to 1. The updates between two such full
+// updates only measure the distances to the kept clusters, as do the centre updates, so an iteration
+// costs O(n * k * d) instead of O(n * c * d) and the partition matrix takes O(n * k) memory.
+class SparseFuzzyCMeans{
+    constexpr static const double EPSILON_DEFAULT_VALUE = 1e-8;
+    constexpr static const double FUZZIFICATION_DEFAULT_VALUE = 2.0;
+    constexpr static const int MAXIMAL_NUMBER_OF_ITERATIONS_DEFAULT_VALUE = 100;
+    constexpr static const unsigned int SEED_DEFAULT_VALUE = 5489u;
+    // every that many iterations memberships are chosen again among all clusters
+    constexpr static const int FULL_UPDATE_INTERVAL_DEFAULT_VALUE = 4;
+    // number of datums whose distances to all centres are computed together
+    constexpr static const std::size_t DATUM_BLOCK_SIZE = 512;
+private:
+    int numberOfClusters;
+    double epsilon;
+    double fuzzification;
+    int maximalNumberOfIterations;
+    unsigned int seed;
+    std::size_t maximalNumberOfMemberships;
+    double membershipThreshold;
+    int fullUpdateInterval;
+public:
+    SparseFuzzyCMeans() noexcept;
+
+    void setNumberOfClusters(int numberOfClusters);
+    void setEpsilonForFrobeniusNorm(double epsilon);
+    void setFuzzification(double fuzzification);
+    void setMaximalNumberOfIterations(int maximalNumberOfIterations);
+    void setSeed(unsigned int seed);
+    // 0 keeps any number of memberships
+    void setMaximalNumberOfMemberships(std::size_t maximalNumberOfMemberships);
+    // compared with the membership among all clusters, the highest membership of a datum is always kept
+    void setMembershipThreshold(double membershipThreshold);
+    void setFullUpdateInterval(int fullUpdateInterval);
+
+    // rows of attributeMajorData which are not contiguous are copied once before clustering;
+    // returned partition has sparse memberships, its partition matrix is empty
+    [[nodiscard]]
+    FuzzyPartition doPartition(const MatrixView<const double>& attributeMajorData) const;
+private:
+    void validateParameters(std::size_t numberOfData) const;
+
+    // centres of the random partition FuzzyCMeans starts from, drawn datum by datum without storing it
+    [[nodiscard]]
+    std::vector<double> calculateInitialClusterCentres(const MatrixView<const double>& attributeMajorData) const;
+
+    void updateClusterCentres(const MatrixView<const double>& attributeMajorData, FuzzyPartition& partition) const;
+
+    // chooses the kept memberships among all clusters, returns the sum of squared membership changes
+    [[nodiscard]]
+    double selectMemberships(const MatrixView<const double>& attributeMajorData,
+                             FuzzyPartition& partition,
+                             SparseMembershipMatrix& previousMemberships) const;
+
+    // recomputes the kept memberships only, returns the sum of squared membership changes
+    [[nodiscard]]
+    double updateKeptMemberships(const MatrixView<const double>& attributeMajorData,
+                                 FuzzyPartition& partition) const;
+
+    // reciprocals has DATUM_BLOCK_SIZE entries per cluster, the keptLimit highest of every datum
+    // are written one datum after another in descending order
+    static void selectHighestReciprocals(const double* reciprocals,
+                                         std::size_t numberOfClusters,
+                                         std::size_t blockLength,
+                                         std::size_t keptLimit,
+                                         const SparseMembershipMatrix& previousMemberships,
+                                         std::size_t blockStart,
+                                         double* highestReciprocals,
+                                         std::uint32_t* highestClusters);
+
+    [[nodiscard]]
+    double reciprocalOfDistance(double squaredDistance) const;
+};
+
+#endif // FUZZY_REGRESSION_SPARSEFUZZYCMEANS_HPP
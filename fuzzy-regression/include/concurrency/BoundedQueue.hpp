@@ -0,0 +1,80 @@
+#ifndef FUZZY_REGRESSION_BOUNDEDQUEUE_HPP
+#define FUZZY_REGRESSION_BOUNDEDQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Blocking multi-producer multi-consumer queue connecting pipeline stages.
+// push blocks while the queue is full, pop blocks while it is empty and returns
+// an empty optional once the queue was closed and drained.
+template<typename Element>
+class BoundedQueue{
+private:
+    const std::size_t capacity;
+    std::deque<Element> elements;
+    std::mutex elementsMutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    bool closed = false;
+public:
+    explicit BoundedQueue(std::size_t capacity);
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // returns false when the queue was closed and the element was dropped
+    bool push(Element&& element);
+
+    std::optional<Element> pop();
+
+    void close();
+};
+
+template<typename Element>
+BoundedQueue<Element>::BoundedQueue(std::size_t capacity)
+: capacity(capacity == 0 ? 1 : capacity){}
+
+template<typename Element>
+bool BoundedQueue<Element>::push(Element&& element) {
+    {
+        std::unique_lock<std::mutex> lock(elementsMutex);
+        notFull.wait(lock, [this]() { return closed || elements.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        elements.push_back(std::move(element));
+    }
+    notEmpty.notify_one();
+    return true;
+}
+
+template<typename Element>
+std::optional<Element> BoundedQueue<Element>::pop() {
+    std::optional<Element> element;
+    {
+        std::unique_lock<std::mutex> lock(elementsMutex);
+        notEmpty.wait(lock, [this]() { return closed || !elements.empty(); });
+        if (elements.empty()) {
+            return std::nullopt;
+        }
+        element.emplace(std::move(elements.front()));
+        elements.pop_front();
+    }
+    notFull.notify_one();
+    return element;
+}
+
+template<typename Element>
+void BoundedQueue<Element>::close() {
+    {
+        std::lock_guard<std::mutex> lock(elementsMutex);
+        closed = true;
+    }
+    notFull.notify_all();
+    notEmpty.notify_all();
+}
+
+#endif // FUZZY_REGRESSION_BOUNDEDQUEUE_HPP
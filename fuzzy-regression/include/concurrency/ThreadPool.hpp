@@ -0,0 +1,63 @@
+#ifndef FUZZY_REGRESSION_THREADPOOL_HPP
+#define FUZZY_REGRESSION_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads taking tasks from a shared queue.
+// Tasks with a higher expected cost are started first, so that long runs
+// do not end up at the tail of a batch (longest processing time first).
+class ThreadPool{
+private:
+    struct QueuedTask{
+        double expectedCost;
+        unsigned long sequenceNumber;
+        std::function<void()> task;
+    };
+    struct LowerPriority{
+        bool operator()(const QueuedTask& first, const QueuedTask& second) const;
+    };
+
+    std::vector<std::thread> workers;
+    std::priority_queue<QueuedTask, std::vector<QueuedTask>, LowerPriority> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksAvailable;
+    unsigned long submittedTasks = 0;
+    bool stopping = false;
+public:
+    explicit ThreadPool(unsigned int numberOfThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename Task>
+    std::future<std::invoke_result_t<Task>> submit(Task&& task, double expectedCost = 0.0);
+
+    [[nodiscard]]
+    unsigned int getNumberOfThreads() const;
+
+    [[nodiscard]]
+    static unsigned int defaultNumberOfThreads();
+private:
+    void enqueue(std::function<void()>&& task, double expectedCost);
+    void workerLoop();
+};
+
+template<typename Task>
+std::future<std::invoke_result_t<Task>> ThreadPool::submit(Task&& task, double expectedCost) {
+    using Result = std::invoke_result_t<Task>;
+    auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+    std::future<Result> result = packagedTask->get_future();
+    enqueue([packagedTask]() { (*packagedTask)(); }, expectedCost);
+    return result;
+}
+
+#endif // FUZZY_REGRESSION_THREADPOOL_HPP
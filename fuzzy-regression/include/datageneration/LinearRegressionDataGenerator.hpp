@@ -1,27 +1,45 @@
 #ifndef FUZZY_REGRESSION_LINEARREGRESSIONDATAGENERATOR_HPP
 #define FUZZY_REGRESSION_LINEARREGRESSIONDATAGENERATOR_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <random>
 
+#include "datageneration/Philox4x32.hpp"
+
+// Tuples x1 ... xk y with y = sum(slope_i * x_i + deviation_i) + intercept deviation.
+// Tuple number i depends only on the seed and on i, so any range of tuples can be generated
+// independently, e.g. by several threads, and the same seed always gives the same data.
 class LinearRegressionDataGenerator {
 private:
-    std::mt19937 mersenneTwisterGenerator;
-    const std::vector<std::uniform_real_distribution<double>> uniformRealDistributionsForDeviation;
-    std::uniform_real_distribution<double> uniformRealDistributionForIntercept;
-    std::uniform_real_distribution<double> uniformRealDistributionForDomain;
-
+    const Philox4x32 randomNumberGenerator;
     const std::vector<double> slopeParameters;
-
-    static std::vector<std::uniform_real_distribution<double>>
-    generateDistributionsForSlopeDeviations(const std::vector<double> &slopeDeviationsVector);
+    const std::vector<double> slopeDeviations;
+    const double interceptDeviation;
+    const double domainMaxValue;
+    std::size_t nextTupleNumber = 0;
 public:
     LinearRegressionDataGenerator(const std::vector<double>&& slopeParameters,
                                   const std::vector<double>&& slopeDeviations,
                                   double interceptDeviation,
                                   double domainMaxValue);
 
+    // same tuples on every run for the same seed, e.g. for benchmarks
+    LinearRegressionDataGenerator(const std::vector<double>&& slopeParameters,
+                                  const std::vector<double>&& slopeDeviations,
+                                  double interceptDeviation,
+                                  double domainMaxValue,
+                                  std::uint64_t seed);
+
+    // returns the tuple following the one returned previously, starting with tuple 0
     std::vector<double> generateTupleValue();
+
+    // writes tuples firstTupleNumber ... firstTupleNumber + numberOfTuples - 1 one after another
+    // into output, which has to hold numberOfTuples * getNumberOfAttributes() values; safe to call concurrently
+    void generateTuples(std::size_t firstTupleNumber, std::size_t numberOfTuples, double* output) const;
+
+    [[nodiscard]]
+    std::size_t getNumberOfAttributes() const;
 };
 
 
@@ -0,0 +1,54 @@
+#ifndef FUZZY_REGRESSION_PHILOX4X32_HPP
+#define FUZZY_REGRESSION_PHILOX4X32_HPP
+
+#include <array>
+#include <cstdint>
+
+// Counter-based random number generator Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy
+// as 1, 2, 3"). A block of random bits is a pure function of a key and a counter, so every tuple can be
+// generated from its own index without any shared state, on any thread and in any order.
+class Philox4x32{
+public:
+    using Counter = std::array<std::uint32_t, 4>;
+private:
+    constexpr static const std::uint32_t MULTIPLIER_0 = 0xD2511F53;
+    constexpr static const std::uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+    constexpr static const std::uint32_t WEYL_0 = 0x9E3779B9;
+    constexpr static const std::uint32_t WEYL_1 = 0xBB67AE85;
+    constexpr static const int NUMBER_OF_ROUNDS = 10;
+
+    const std::uint32_t key0;
+    const std::uint32_t key1;
+public:
+    explicit Philox4x32(std::uint64_t seed) noexcept
+    : key0((std::uint32_t) seed), key1((std::uint32_t) (seed >> 32)){}
+
+    [[nodiscard]]
+    Counter operator()(Counter counter) const noexcept {
+        std::uint32_t roundKey0 = key0;
+        std::uint32_t roundKey1 = key1;
+        for (int round = 0; round < NUMBER_OF_ROUNDS; ++round) {
+            const std::uint64_t product0 = (std::uint64_t) MULTIPLIER_0 * counter[0];
+            const std::uint64_t product1 = (std::uint64_t) MULTIPLIER_1 * counter[2];
+            counter = {(std::uint32_t) (product1 >> 32) ^ counter[1] ^ roundKey0,
+                       (std::uint32_t) product1,
+                       (std::uint32_t) (product0 >> 32) ^ counter[3] ^ roundKey1,
+                       (std::uint32_t) product0};
+            roundKey0 += WEYL_0;
+            roundKey1 += WEYL_1;
+        }
+        return counter;
+    }
+
+    // two uniformly distributed doubles from [0, 1) with full 53 bit mantissas
+    [[nodiscard]]
+    std::array<double, 2> uniformPair(std::uint64_t stream, std::uint32_t block) const noexcept {
+        const Counter bits = (*this)({(std::uint32_t) stream, (std::uint32_t) (stream >> 32), block, 0});
+        const std::uint64_t first = ((std::uint64_t) bits[0] << 32) | bits[1];
+        const std::uint64_t second = ((std::uint64_t) bits[2] << 32) | bits[3];
+        constexpr double SCALE = 1.0 / (double) (1ull << 53);
+        return {(double) (first >> 11) * SCALE, (double) (second >> 11) * SCALE};
+    }
+};
+
+#endif // FUZZY_REGRESSION_PHILOX4X32_HPP
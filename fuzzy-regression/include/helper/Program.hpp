@@ -1,40 +1,189 @@
 #ifndef FUZZY_REGRESSION_PROGRAM_HPP
 #define FUZZY_REGRESSION_PROGRAM_HPP
 
+#include <cstdint>
 #include <iostream>
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 #include <unordered_set>
 
+#include "cache/ResultCache.hpp"
+#include "concurrency/ThreadPool.hpp"
+#include "regression/ClusterCountSearch.hpp"
 #include "regression/FuzzyRegression.hpp"
+#include "regression/RegressionModel.hpp"
+#include "server/JobServer.hpp"
+#include "server/ShardCoordinator.hpp"
+#include "streams/TupleReader.hpp"
+#include "streams/ColumnarDatasetFile.hpp"
+#include "telemetry/Telemetry.hpp"
+
+struct ClusterRunResult{
+    const int numberOfClusters;
+    const RegressionResult regressionResult;
+    const std::string performanceRecord;
+    const int numberOfIterations;
+    const bool servedFromCache;
+};
+
+struct LoadedDataset{
+    std::string fileStem;
+    std::filesystem::path dataFilePath;
+    // text file clustered with ksi::fcm
+    std::optional<ksi::dataset> dataset;
+    // text file flattened once for the native engine
+    std::vector<double> attributeMajorBuffer;
+    // binary columnar file, its columns are used in place
+    std::shared_ptr<ColumnarDatasetFile> columnarDatasetFile;
+    // text file streamed batch by batch, it is never loaded as a whole
+    std::filesystem::path streamedFilePath;
+    MatrixView<const double> attributeMajorData;
+    std::size_t numberOfData;
+    std::size_t numberOfAttributes;
+    // hash of the file content, only computed when results are cached
+    std::uint64_t contentHash;
+    // weighted sample clustered instead of the data, only built for -coreset runs on data in memory
+    std::shared_ptr<const Coreset> coreset;
+};
+
+struct FileSweepResult{
+    std::string fileStem;
+    std::size_t numberOfAttributes;
+    std::vector<ClusterRunResult> clusterRunResults;
+    // set when cluster counts were searched adaptively instead of swept
+    std::optional<int> chosenNumberOfClusters;
+    // fit of every cluster run's model on the whole data, only filled by -evaluate
+    std::vector<ModelEvaluation> dataEvaluations;
+};
+
+struct ResidentClusterRun{
+    ServedClusterRun clusterRun;
+    std::uint64_t lastUse;
+};
+
+// data file kept in memory by -serve between jobs together with the results of its cluster counts,
+// replaced when the file changes and dropped when it is the least recently used one of too many
+struct ResidentDataset{
+    std::filesystem::file_time_type modificationTime;
+    // guarded by residentDatasetsMutex of the Program
+    std::uint64_t lastUse = 0;
+    // held while the file is parsed, so that concurrent jobs for it parse it once
+    std::mutex loadingMutex;
+    std::optional<LoadedDataset> loadedDataset;
+    std::mutex clusterRunsMutex;
+    // keyed by number of clusters and epsilon, the least recently used run goes first once there are too many
+    std::map<std::pair<int, double>, ResidentClusterRun> clusterRuns;
+    std::uint64_t clusterRunUses = 0;
+};
 
 class Program {
 private:
+    constexpr static const unsigned int DEFAULT_BATCH_SIZE = 65536;
+    constexpr static const unsigned int DEFAULT_NUMBER_OF_RESIDENT_DATASETS = 4;
+    constexpr static const std::size_t MAX_RESIDENT_CLUSTER_RUNS = 4096;
     std::unordered_set<std::string> arguments;
     const std::_Setprecision MAX_PRECISION_COUT;
+    const ClusteringEngine clusteringEngine;
+    const bool streaming;
+    // number of draws of the coreset clustered instead of the data, 0 clusters the data itself
+    const std::size_t coresetSize;
+    const ClusterCountSearchMode clusterCountSearchMode;
+    const std::unique_ptr<ResultCache> resultCache;
+    const std::unique_ptr<ThreadPool> sweepThreadPool;
+    // helps the pipeline readers parse text files when there is no sweep pool to share with them
+    const std::unique_ptr<ThreadPool> parsingThreadPool;
+    // set by -workers, cluster counts then run in worker processes and text files are only scanned here
+    const std::unique_ptr<ShardCoordinator> shardCoordinator;
+    // keyed by data file and engine, only filled by -serve
+    mutable std::mutex residentDatasetsMutex;
+    mutable std::map<std::string, std::shared_ptr<ResidentDataset>> residentDatasets;
+    mutable std::uint64_t residentDatasetUses = 0;
+    const std::size_t maximalNumberOfResidentDatasets;
 public:
     Program(int argument_count, char ** argument_values);
     int run();
 private:
     std::unordered_set<std::string> generateArgumentSet(int argumentCount, char ** argumentValues);
+    ClusteringEngine chooseClusteringEngine() const;
+    bool requiresNativeEngine() const;
+    ClusterCountSearchMode chooseClusterCountSearchMode() const;
+    std::optional<std::string> findArgumentValue(const std::string& argumentName) const;
+    unsigned int findUnsignedArgumentValue(const std::string& argumentName, unsigned int defaultValue) const;
+    double findDoubleArgumentValue(const std::string& argumentName, double defaultValue) const;
+    // empty when the argument is missing or malformed
+    std::optional<std::uint64_t> findUnsigned64ArgumentValue(const std::string& argumentName) const;
+    bool isWarmStartSweep() const;
+    bool isSparseClustering() const;
+    bool isMixedPrecisionClustering() const;
+    bool isServing() const;
+    std::unique_ptr<ThreadPool> createSweepThreadPool() const;
+    std::unique_ptr<ThreadPool> createParsingThreadPool() const;
+    TupleReader createTupleReader() const;
+    std::unique_ptr<ResultCache> createResultCache() const;
+    std::unique_ptr<ShardCoordinator> createShardCoordinator(const std::string& programPath) const;
+    // the options a worker needs to compute cluster counts like this process would
+    std::vector<std::string> createWorkerArguments(const std::string& programPath, unsigned int numberOfThreads) const;
+    std::optional<TelemetryFormat> chooseTelemetryFormat() const;
+    void writeTelemetry(const Telemetry& telemetry, TelemetryFormat format) const;
     int runMainProgram();
     void generateTestData();
     void processData();
+    void convertData();
+    void serveJobs();
+    JobServer::ClusterCountRunner prepareServedJob(const RegressionJob& job) const;
+    void finishServedJob() const;
+    std::shared_ptr<ResidentDataset> findResidentDataset(const std::filesystem::path& dataFilePath,
+                                                         ClusteringEngine datasetEngine) const;
+    std::vector<std::filesystem::path> listDataFiles(const std::filesystem::path& dataPath) const;
+    static bool isUpToDateConversion(const std::filesystem::path& columnarFilePath,
+                                     const std::filesystem::path& dataFilePath);
     std::string printTime(const std::tm* timeStruct);
-    void processSingleFile(const std::filesystem::directory_entry& testDataDirectoryEntry,
-                           const std::filesystem::path& resultPath);
+    // datasetEngine decides how text files are parsed, binary files are always clustered natively
+    std::optional<LoadedDataset> loadDataset(const std::filesystem::path& dataFilePath,
+                                             ClusteringEngine datasetEngine) const;
+    FileSweepResult sweepDataset(const LoadedDataset& loadedDataset) const;
+    // evaluates all models in one pass over the data, streamed files are read batch by batch
+    std::vector<ModelEvaluation> evaluateOnDataset(const LoadedDataset& loadedDataset,
+                                                   const std::vector<ClusterRunResult>& clusterRunResults) const;
+    void writeSweepResult(const FileSweepResult& sweepResult, const std::filesystem::path& resultPath);
+    ClusterRunResult runSingleClusterCount(const LoadedDataset& loadedDataset,
+                                           int numberOfClusters,
+                                           const FuzzyPartition* warmStartPartition,
+                                           std::optional<FuzzyPartition>* convergedPartition,
+                                           double epsilon = FuzzyRegression::EPSILON_DEFAULT_VALUE) const;
+    std::unique_ptr<BatchSource> createBatchSource(const LoadedDataset& loadedDataset) const;
+    std::optional<std::string> createCacheKey(const LoadedDataset& loadedDataset,
+                                              int numberOfClusters,
+                                              const FuzzyRegression& fuzzyRegression) const;
+    ClusterCountSearchSettings createClusterCountSearchSettings(const LoadedDataset& loadedDataset,
+                                                                int maxNumberOfClusters) const;
+    std::vector<ClusterRunResult> sweepClusterCountsSequentially(const LoadedDataset& loadedDataset,
+                                                                 const std::vector<int>& clusterCounts,
+                                                                 std::optional<FuzzyPartition>& previousPartition) const;
+    std::vector<ClusterRunResult> sweepClusterCountsInParallel(const LoadedDataset& loadedDataset,
+                                                               const std::vector<int>& clusterCounts) const;
+    std::vector<ClusterRunResult> sweepClusterCountsOnWorkers(const LoadedDataset& loadedDataset,
+                                                              const std::vector<int>& clusterCounts) const;
 
     void prettyPrintRegressionData(std::fstream& outputFile,
                                    int clusterSizeForIteration,
                                    const RegressionResult& regressionResults) const;
     void printRegressionData(std::fstream& outputFile,
                              int clusterSizeForIteration,
-                             const RegressionResult& regressionResults) const;
+                             const RegressionResult& regressionResults,
+                             const ModelEvaluation* dataEvaluation = nullptr) const;
 
-    void printRegressionDataHeader(std::fstream& outputFile, unsigned long numberOfAttributes) const;
+    void printRegressionDataHeader(std::fstream& outputFile,
+                                   unsigned long numberOfAttributes,
+                                   bool withDataEvaluation = false) const;
 
-    void printPerformanceFileHeader(std::fstream& performanceFile);
+    void printPerformanceFileHeader(std::fstream& performanceFile) const;
 };
 
 #endif
\ No newline at end of file
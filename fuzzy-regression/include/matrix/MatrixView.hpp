@@ -0,0 +1,109 @@
+#ifndef FUZZY_REGRESSION_MATRIXVIEW_HPP
+#define FUZZY_REGRESSION_MATRIXVIEW_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+// Non-owning view of a dense matrix with arbitrary row and column strides (counted in elements).
+// The same buffer can be seen row-major or column-major without copying, e.g. attribute-major
+// data files are viewed with one attribute per row.
+template<typename Value>
+class MatrixView{
+private:
+    Value* data;
+    std::size_t numberOfRows;
+    std::size_t numberOfColumns;
+    std::size_t rowStride;
+    std::size_t columnStride;
+public:
+    MatrixView() noexcept
+    : data(nullptr), numberOfRows(0), numberOfColumns(0), rowStride(0), columnStride(1){}
+
+    MatrixView(Value* data,
+               std::size_t numberOfRows,
+               std::size_t numberOfColumns,
+               std::size_t rowStride,
+               std::size_t columnStride = 1) noexcept
+    : data(data),
+    numberOfRows(numberOfRows),
+    numberOfColumns(numberOfColumns),
+    rowStride(rowStride),
+    columnStride(columnStride){}
+
+    // a view of mutable values can always be used where a read-only view is expected
+    template<typename OtherValue,
+             typename = std::enable_if_t<std::is_same_v<const OtherValue, Value> && !std::is_same_v<OtherValue, Value>>>
+    MatrixView(const MatrixView<OtherValue>& other) noexcept
+    : data(other.getData()),
+    numberOfRows(other.getNumberOfRows()),
+    numberOfColumns(other.getNumberOfColumns()),
+    rowStride(other.getRowStride()),
+    columnStride(other.getColumnStride()){}
+
+    [[nodiscard]]
+    static MatrixView rowMajor(Value* data, std::size_t numberOfRows, std::size_t numberOfColumns) noexcept {
+        return MatrixView(data, numberOfRows, numberOfColumns, numberOfColumns, 1);
+    }
+
+    Value& operator()(std::size_t row, std::size_t column) const {
+        return data[row * rowStride + column * columnStride];
+    }
+
+    // pointer to the first element of a row, consecutive elements are contiguous only if hasContiguousRows()
+    [[nodiscard]]
+    Value* row(std::size_t row) const {
+        return data + row * rowStride;
+    }
+
+    [[nodiscard]]
+    bool hasContiguousRows() const {
+        return columnStride == 1;
+    }
+
+    // sub-matrix sharing the buffer and the strides, e.g. some columns of a row-major matrix
+    [[nodiscard]]
+    MatrixView block(std::size_t firstRow,
+                     std::size_t firstColumn,
+                     std::size_t blockNumberOfRows,
+                     std::size_t blockNumberOfColumns) const {
+        return MatrixView(data + firstRow * rowStride + firstColumn * columnStride,
+                          blockNumberOfRows, blockNumberOfColumns, rowStride, columnStride);
+    }
+
+    [[nodiscard]]
+    MatrixView column(std::size_t column) const {
+        return block(0, column, numberOfRows, 1);
+    }
+
+    [[nodiscard]]
+    MatrixView transposed() const {
+        return MatrixView(data, numberOfColumns, numberOfRows, columnStride, rowStride);
+    }
+
+    [[nodiscard]]
+    Value* getData() const {
+        return data;
+    }
+
+    [[nodiscard]]
+    std::size_t getNumberOfRows() const {
+        return numberOfRows;
+    }
+
+    [[nodiscard]]
+    std::size_t getNumberOfColumns() const {
+        return numberOfColumns;
+    }
+
+    [[nodiscard]]
+    std::size_t getRowStride() const {
+        return rowStride;
+    }
+
+    [[nodiscard]]
+    std::size_t getColumnStride() const {
+        return columnStride;
+    }
+};
+
+#endif // FUZZY_REGRESSION_MATRIXVIEW_HPP
@@ -0,0 +1,68 @@
+#ifndef FUZZY_REGRESSION_CLUSTERCOUNTSEARCH_HPP
+#define FUZZY_REGRESSION_CLUSTERCOUNTSEARCH_HPP
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <vector>
+
+enum class ClusterCountSearchMode{
+    // every cluster count in the range
+    FULL_SWEEP,
+    // ascending cluster counts until the lowest regression error has not improved by more than
+    // the tolerance for a window of consecutive counts
+    PLATEAU,
+    // a geometric grid, then the bracket around the best grid point is halved until it is closed
+    COARSE_TO_FINE
+};
+
+struct ClusterCountSearchSettings{
+    ClusterCountSearchMode mode;
+    int firstNumberOfClusters;
+    int lastNumberOfClusters;
+    // relative improvement of the regression error which still counts
+    double tolerance;
+    int window;
+    // most cluster counts handed out at once, e.g. the number of threads evaluating them
+    std::size_t batchSize;
+};
+
+// Chooses which cluster counts to evaluate. The caller asks for the next cluster counts, evaluates them
+// in any order and reports their regression errors, until no more counts are returned.
+// The chosen count is the smallest one whose error is within the tolerance of the lowest error.
+class ClusterCountSearch{
+private:
+    const ClusterCountSearchSettings settings;
+    std::map<int, double> regressionErrors;
+    int nextSequentialClusterCount;
+    bool gridEvaluated = false;
+public:
+    explicit ClusterCountSearch(const ClusterCountSearchSettings& settings);
+
+    // cluster counts which can be evaluated independently of each other, empty when the search is finished;
+    // all counts of a batch have to be reported before the next one is asked for
+    [[nodiscard]]
+    std::vector<int> nextClusterCounts();
+
+    void reportRegressionError(int numberOfClusters, double regressionError);
+
+    [[nodiscard]]
+    std::optional<int> getChosenNumberOfClusters() const;
+
+    [[nodiscard]]
+    std::size_t getNumberOfEvaluatedClusterCounts() const;
+private:
+    [[nodiscard]]
+    std::vector<int> nextSequentialClusterCounts(std::size_t batchSize);
+
+    [[nodiscard]]
+    bool hasPlateaued() const;
+
+    [[nodiscard]]
+    std::vector<int> geometricGrid() const;
+
+    [[nodiscard]]
+    std::vector<int> refinementClusterCounts() const;
+};
+
+#endif // FUZZY_REGRESSION_CLUSTERCOUNTSEARCH_HPP
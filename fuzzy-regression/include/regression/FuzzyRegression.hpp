@@ -3,55 +3,141 @@
 
 #include <filesystem>
 #include <fstream>
+#include <optional>
 
-#include <auxiliary/least-error-squares-regression.h>
 #include <common/dataset.h>
 #include <partitions/fcm.h>
 
-struct AssociationStruct{
-    int clusterNumber;
-    double clusterAssociationValue;
-};
+#include "clustering/Coreset.hpp"
+#include "clustering/FuzzyCMeans.hpp"
+#include "streams/BatchSource.hpp"
 
 struct RegressionResult{
     const std::vector<double> regressionDescribingParameters;
     const double coefficientOfDetermination;
 };
 
+// wall-clock durations of the stages of the last processDataset call
+struct StageDurations{
+    long clusteringNanoseconds;
+    long dataPreparationNanoseconds;
+    long regressionNanoseconds;
+    long errorCalculationNanoseconds;
+};
+
+enum class ClusteringEngine{
+    KSI,
+    NATIVE
+};
+
+enum class ClusteringPrecision{
+    DOUBLE,
+    // single-precision iterations with a short double-precision polish, see MixedPrecisionFuzzyCMeans
+    MIXED
+};
+
 class FuzzyRegression{
+public:
     constexpr static const double EPSILON_DEFAULT_VALUE = 1e-8;
 private:
-    const ksi::dataset& dataset;
+    // sparse memberships are used only when at most this part of them (1 / ratio) is kept
+    constexpr static const std::size_t MINIMAL_PRUNING_RATIO = 4;
+    const ksi::dataset* dataset;
     const int numberOfClusters;
+    const ClusteringEngine clusteringEngine;
     const double epsilon = epsilon;
+    // attribute-major copy made only when the native engine gets data that is not already laid out that way
+    const std::vector<double> attributeMajorBuffer;
+    const MatrixView<const double> attributeMajorData;
+    const FuzzyPartition* warmStartPartition = nullptr;
+    const Coreset* coreset = nullptr;
+    bool sparseMemberships = false;
+    std::size_t maximalNumberOfMemberships = 0;
+    double membershipThreshold = 0;
+    ClusteringPrecision clusteringPrecision = ClusteringPrecision::DOUBLE;
+    std::optional<double> coresetObjectiveError;
+    BatchSource* batchSource = nullptr;
+    int numberOfEpochs = 0;
+    FuzzyPartition partition{};
+    StageDurations stageDurations{};
 public:
     FuzzyRegression(const ksi::dataset& dataset,
                     int numberOfClusters,
+                    ClusteringEngine clusteringEngine = ClusteringEngine::KSI,
                     double epsilon = EPSILON_DEFAULT_VALUE);
 
+    // clusters with the native engine directly on data with one row per attribute and one column per datum,
+    // e.g. a memory-mapped columnar dataset
+    FuzzyRegression(const MatrixView<const double>& attributeMajorData,
+                    int numberOfClusters,
+                    double epsilon = EPSILON_DEFAULT_VALUE);
+
+    // clusters with mini-batch fuzzy c-means, reading the data from the source batch by batch,
+    // so that the dataset never has to be held in memory
+    FuzzyRegression(BatchSource& batchSource,
+                    int numberOfClusters,
+                    int numberOfEpochs,
+                    double epsilon = EPSILON_DEFAULT_VALUE);
+
+    // attributeMajorData may point into attributeMajorBuffer, so a copy or a move would leave it dangling
+    FuzzyRegression(const FuzzyRegression&) = delete;
+    FuzzyRegression(FuzzyRegression&&) = delete;
+    FuzzyRegression& operator=(const FuzzyRegression&) = delete;
+    FuzzyRegression& operator=(FuzzyRegression&&) = delete;
+
+    // seeds clustering with the converged partition for one cluster less, only supported by the native engine
+    void setWarmStartPartition(const FuzzyPartition& previousPartition);
+
+    // clusters the weighted points of the coreset instead of the whole data, which is used only to count
+    // the datums nearest to each centre; only supported by the native engine on data held in memory
+    void setCoreset(const Coreset& coreset);
+
+    // clusters with SparseFuzzyCMeans, keeping at most maximalNumberOfMemberships (0: any number) memberships
+    // of every datum which are not below membershipThreshold; only supported by the native engine on data in memory
+    void setMembershipSparsity(std::size_t maximalNumberOfMemberships, double membershipThreshold);
+
+    // mixed precision is only supported by the native engine on data in memory, without warm start,
+    // coreset or sparse memberships; regression and its error are computed in double precision either way
+    void setClusteringPrecision(ClusteringPrecision clusteringPrecision);
+
     RegressionResult processDataset(std::ostream& performanceLoggingStream);
 
-private:
     [[nodiscard]]
-    std::vector<AssociationStruct>
-    getPartitionAssociativityData(const std::vector<std::vector<double>>& partitionMatrix) const;
+    const FuzzyPartition& getPartition() const;
 
     [[nodiscard]]
-    std::vector<double>
-    getClusterWeightsFromPartition(const ksi::partition& partition) const;
+    const StageDurations& getStageDurations() const;
+
+    [[nodiscard]]
+    double getEpsilon() const;
 
+    [[nodiscard]]
+    ClusteringPrecision getClusteringPrecision() const;
+
+    // |J_coreset - J| / J for the fuzzy c-means objective J of the last centres, set only when clustering a coreset
+    [[nodiscard]]
+    const std::optional<double>& getCoresetObjectiveError() const;
+
+private:
+    [[nodiscard]]
+    FuzzyPartition
+    partitionDataset() const;
+
+    // WeightedLeastSquares, or the ksi regression when the data is clustered by ksi::fcm
     [[nodiscard]]
     std::vector<double>
-    getClustersDescribedValue(const std::vector<std::vector<double>>& clusterCenters) const;
+    solveRegression(const MatrixView<const double>& describingValues,
+                    const MatrixView<const double>& describedValues,
+                    const std::vector<double>& weights) const;
 
     [[nodiscard]]
-    std::vector<std::vector<double>>
-    getClustersDescribingValues(const std::vector<std::vector<double>>& clusterCenters) const;
+    std::vector<double>
+    getClusterWeightsFromPartition(const FuzzyPartition& partition) const;
 
     [[nodiscard]]
     double
-    calculateRegressionError(const std::vector<std::vector<double>>& rowsWithDescribingValues,
-                             const std::vector<double>& describedValues,
+    calculateRegressionError(const MatrixView<const double>& rowsWithDescribingValues,
+                             const MatrixView<const double>& describedValues,
                              const std::vector<double>& regressionCoefficients);
 };
 
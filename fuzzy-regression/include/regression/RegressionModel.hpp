@@ -0,0 +1,83 @@
+#ifndef FUZZY_REGRESSION_REGRESSIONMODEL_HPP
+#define FUZZY_REGRESSION_REGRESSIONMODEL_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "concurrency/ThreadPool.hpp"
+#include "matrix/MatrixView.hpp"
+#include "regression/FuzzyRegression.hpp"
+#include "streams/BatchSource.hpp"
+
+// Sums of one pass of a model over data; partial evaluations of consecutive parts of the data are merged
+// with the pairwise update of Chan et al., so that the total sum of squares does not cancel for large data.
+struct ModelEvaluation{
+    std::size_t numberOfData;
+    double meanOfDescribedValues;
+    // of the described values around their mean
+    double totalSumOfSquares;
+    double residualSumOfSquares;
+
+    void merge(const ModelEvaluation& other);
+
+    [[nodiscard]]
+    double getMeanSquaredError() const;
+
+    // 1 - residual / total sum of squares, 0 / 0 counts as a perfect fit
+    [[nodiscard]]
+    double getCoefficientOfDetermination() const;
+};
+
+// Linear model fitted by FuzzyRegression (no intercept, y = x . b) applied to whole datasets instead of cluster
+// centres. Data is taken attribute-major like everywhere else, one row per attribute and one column per datum;
+// a flat buffer of rows, one per datum, is seen this way by MatrixView<const double>::rowMajor(rows, n, d).transposed().
+// The datums are split into ranges of DATUMS_PER_TASK for the pool and into blocks of DATUM_BLOCK_SIZE inside
+// a range. Ranges do not depend on the number of threads and are merged in order, so results are reproducible.
+// predict and evaluate must not be called from a task running on the same pool.
+class RegressionModel{
+public:
+    constexpr static const std::size_t DATUM_BLOCK_SIZE = 512;
+    constexpr static const std::size_t DATUMS_PER_TASK = 128 * DATUM_BLOCK_SIZE;
+private:
+    const std::vector<double> coefficients;
+public:
+    explicit RegressionModel(std::vector<double> coefficients);
+
+    explicit RegressionModel(const RegressionResult& regressionResult);
+
+    [[nodiscard]]
+    const std::vector<double>& getCoefficients() const;
+
+    // describingValues has one row per coefficient, predictions room for one value per datum
+    void predict(const MatrixView<const double>& describingValues,
+                 double* predictions,
+                 ThreadPool* threadPool = nullptr) const;
+
+    [[nodiscard]]
+    std::vector<double> predict(const MatrixView<const double>& describingValues,
+                                ThreadPool* threadPool = nullptr) const;
+
+    // attributeMajorData holds the describing attributes followed by the described one, as clustered by
+    // FuzzyRegression, e.g. the data of a memory-mapped ColumnarDatasetFile
+    [[nodiscard]]
+    ModelEvaluation evaluate(const MatrixView<const double>& attributeMajorData,
+                             ThreadPool* threadPool = nullptr) const;
+
+    // evaluates batch by batch from the start of the source, for data that is never held in memory as a whole
+    [[nodiscard]]
+    ModelEvaluation evaluate(BatchSource& batchSource, ThreadPool* threadPool = nullptr) const;
+private:
+    void validate(const MatrixView<const double>& describingValues) const;
+
+    void predictBlock(const MatrixView<const double>& describingValues,
+                      std::size_t blockStart,
+                      std::size_t blockLength,
+                      double* predictions) const;
+
+    [[nodiscard]]
+    ModelEvaluation evaluateRange(const MatrixView<const double>& attributeMajorData,
+                                  std::size_t first,
+                                  std::size_t last) const;
+};
+
+#endif // FUZZY_REGRESSION_REGRESSIONMODEL_HPP
@@ -0,0 +1,72 @@
+#ifndef FUZZY_REGRESSION_WEIGHTEDLEASTSQUARES_HPP
+#define FUZZY_REGRESSION_WEIGHTEDLEASTSQUARES_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "concurrency/ThreadPool.hpp"
+#include "matrix/MatrixView.hpp"
+
+// Weighted linear regression without intercept: minimises sum of w[i] * (y[i] - x[i] . b)^2.
+// X^T W X and X^T W y are accumulated in one pass over the rows and solved by Cholesky after scaling
+// the normal matrix to a unit diagonal. When a Cholesky pivot shows the normal equations are too badly
+// conditioned, the system is solved again by Householder QR with column pivoting on sqrt(W) [X | y],
+// which does not square the condition number. Linearly dependent columns get a zero coefficient.
+// Up to MAX_UNROLLED_COEFFICIENTS coefficients, one per describing attribute in the usual case, the
+// Cholesky is instantiated for the size of the system so that its loops are unrolled; a closed form
+// would skip the pivot check that decides when to fall back to QR.
+// The object keeps its workspace, so one solver can be reused for many small systems.
+class WeightedLeastSquares{
+public:
+    constexpr static const std::size_t MAX_UNROLLED_COEFFICIENTS = 10;
+private:
+    // diagonal of R relative to its first element below which columns are treated as dependent
+    constexpr static const double RANK_TOLERANCE = 1e-12;
+private:
+    std::vector<double> normalMatrix;
+    std::vector<double> normalVector;
+    std::vector<double> scales;
+    std::vector<double> weightedRows;
+    std::vector<std::size_t> columnOrder;
+    bool usedQr = false;
+public:
+    struct Problem{
+        MatrixView<const double> describingValues;
+        MatrixView<const double> describedValues;
+        std::vector<double> weights;
+    };
+
+    // describingValues has one row per observation, describedValues a single column, weights are not negative
+    [[nodiscard]]
+    std::vector<double> solve(const MatrixView<const double>& describingValues,
+                              const MatrixView<const double>& describedValues,
+                              const std::vector<double>& weights);
+
+    // whether the last solve had to fall back to QR
+    [[nodiscard]]
+    bool lastSolveUsedQr() const;
+
+    // solves every problem, spread over the pool when one is given;
+    // it must not be called from a task running on the same pool
+    [[nodiscard]]
+    static std::vector<std::vector<double>> solveBatch(const std::vector<Problem>& problems,
+                                                       ThreadPool* threadPool = nullptr);
+private:
+    static void validate(const MatrixView<const double>& describingValues,
+                         const MatrixView<const double>& describedValues,
+                         const std::vector<double>& weights);
+
+    void accumulateNormalEquations(const MatrixView<const double>& describingValues,
+                                   const MatrixView<const double>& describedValues,
+                                   const std::vector<double>& weights);
+
+    [[nodiscard]]
+    bool solveByCholesky(std::vector<double>& coefficients);
+
+    void solveByQr(const MatrixView<const double>& describingValues,
+                   const MatrixView<const double>& describedValues,
+                   const std::vector<double>& weights,
+                   std::vector<double>& coefficients);
+};
+
+#endif // FUZZY_REGRESSION_WEIGHTEDLEASTSQUARES_HPP
@@ -0,0 +1,122 @@
+#ifndef FUZZY_REGRESSION_JOBSERVER_HPP
+#define FUZZY_REGRESSION_JOBSERVER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "concurrency/ThreadPool.hpp"
+#include "regression/FuzzyRegression.hpp"
+
+// one request of the -serve protocol
+struct RegressionJob{
+    // echoed in every response of the job
+    std::string id;
+    std::filesystem::path dataFilePath;
+    int firstNumberOfClusters;
+    int lastNumberOfClusters;
+    // not set: the server defaults
+    std::optional<double> epsilon;
+    std::optional<ClusteringEngine> clusteringEngine;
+};
+
+struct ServedClusterRun{
+    RegressionResult regressionResult;
+    int numberOfIterations;
+    // read back from the result cache or kept in memory from an earlier job
+    bool servedFromCache;
+    // line of the _perf.txt file, empty when nothing was timed
+    std::string performanceRecord;
+};
+
+// one line answered by the server
+struct JobResponse{
+    std::string id;
+    // the answer for one cluster count
+    std::optional<int> numberOfClusters;
+    std::optional<ServedClusterRun> clusterRun;
+    std::optional<std::string> error;
+    // the last answer of a job
+    bool done;
+};
+
+// Reads regression jobs line by line and streams back one JSON line per cluster count as soon as it is done.
+// A job is a flat JSON object or whitespace separated key=value pairs with the keys file, clusters (N or N-M),
+// epsilon, engine (native or ksi) and id, e.g.
+//   {"id": "a", "file": "twoDescriptionVariables.txt", "clusters": "2-10", "epsilon": 1e-8}
+//   id=a file=twoDescriptionVariables.txt clusters=2-10 engine=native
+// The cluster counts of all jobs, whichever connection they came from, run on one worker pool; after its
+// last cluster count a job answers {"id": ..., "done": true, ...}, a failed job or count {"id": ..., "error": ...}.
+// A "shutdown" line stops the server once the running jobs are answered, end of input closes a connection.
+class JobServer{
+public:
+    // longest cluster range of one job, every count of it is queued on the workers at once
+    constexpr static const int MAX_CLUSTER_COUNTS_PER_JOB = 10000;
+    // runs one cluster count of a job on a worker
+    using ClusterCountRunner = std::function<ServedClusterRun(int numberOfClusters)>;
+    // called once per job before its cluster counts are queued, e.g. to load the data file; throws to reject the job
+    using JobPreparation = std::function<ClusterCountRunner(const RegressionJob& job)>;
+    // called on a worker after the done answer of a job, e.g. to trim caches; exceptions are ignored
+    using JobCompletion = std::function<void(const RegressionJob& job)>;
+private:
+    ThreadPool& workers;
+    const JobPreparation prepareJob;
+    const JobCompletion finishJob;
+    std::atomic<bool> stopping{false};
+    // sockets of serveSocket, shut down by a shutdown request to wake the threads blocked on them
+    std::mutex socketsMutex;
+    int listeningSocket = -1;
+    std::set<int> clientSockets;
+    // connection threads are detached, serveSocket waits for this count to drop to zero before returning
+    std::size_t numberOfConnections = 0;
+    std::condition_variable connectionFinished;
+public:
+    JobServer(ThreadPool& workers, JobPreparation prepareJob, JobCompletion finishJob = nullptr);
+
+    // serves a single connection, e.g. standard input and output, until end of input or shutdown
+    void serveStream(std::istream& input, std::ostream& output);
+
+    // accepts any number of connections on a Unix domain socket at socketPath until shutdown,
+    // throws std::runtime_error where Unix domain sockets are not available
+    void serveSocket(const std::filesystem::path& socketPath);
+
+    // throws std::invalid_argument on malformed lines
+    [[nodiscard]]
+    static RegressionJob parseJob(const std::string& line);
+
+    // the JSON form of a job as read by parseJob
+    [[nodiscard]]
+    static std::string formatJob(const RegressionJob& job);
+
+    [[nodiscard]]
+    static std::string formatClusterRun(const std::string& jobId, int numberOfClusters, const ServedClusterRun& clusterRun);
+
+    [[nodiscard]]
+    static std::string formatError(const std::string& jobId, const std::string& message);
+
+    // reads a line written by formatClusterRun, formatError or the done answer of a job,
+    // throws std::invalid_argument on anything else
+    [[nodiscard]]
+    static JobResponse parseResponse(const std::string& line);
+private:
+    // readLine returns false at the end of input, writeLine is called by one thread at a time
+    void serveConnection(const std::function<bool(std::string&)>& readLine,
+                         const std::function<void(const std::string&)>& writeLine);
+
+    // queues the cluster counts of the job, the last one to finish answers that the job is done
+    void startJob(const std::string& line,
+                  const std::function<void(const std::string&)>& respond,
+                  std::vector<std::future<void>>& runningClusterCounts);
+
+    void stop();
+};
+
+#endif // FUZZY_REGRESSION_JOBSERVER_HPP
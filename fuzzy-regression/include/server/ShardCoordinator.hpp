@@ -0,0 +1,86 @@
+#ifndef FUZZY_REGRESSION_SHARDCOORDINATOR_HPP
+#define FUZZY_REGRESSION_SHARDCOORDINATOR_HPP
+
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "server/JobServer.hpp"
+#include "server/WorkerConnection.hpp"
+
+// one cluster count of one data file
+struct Shard{
+    std::filesystem::path dataFilePath;
+    int numberOfClusters;
+};
+
+// Hands shards to workers answering the -serve protocol and collects their answers.
+// Every worker has at most shardsPerWorker shards in flight; like in ThreadPool the queued shard with the
+// highest expected cost is handed out first. When a worker ends its connection with shards in flight, they
+// are queued again and a new worker is connected in its place. A shard fails after it was in flight on
+// MAXIMAL_NUMBER_OF_ATTEMPTS workers which died, so a shard that crashes every worker does not stop the rest.
+class ShardCoordinator{
+public:
+    using ConnectWorker = std::function<std::unique_ptr<WorkerConnection>(unsigned int workerNumber)>;
+    constexpr static const int MAXIMAL_NUMBER_OF_ATTEMPTS = 3;
+private:
+    struct QueuedShard{
+        double expectedCost;
+        unsigned long shardNumber;
+    };
+    struct LowerPriority{
+        bool operator()(const QueuedShard& first, const QueuedShard& second) const;
+    };
+    struct PendingShard{
+        Shard shard;
+        std::promise<ServedClusterRun> result;
+        double expectedCost;
+        int numberOfAttempts;
+    };
+
+    const ConnectWorker connectWorker;
+    const unsigned int numberOfWorkers;
+    const unsigned int shardsPerWorker;
+    std::mutex shardsMutex;
+    std::condition_variable shardsChanged;
+    std::priority_queue<QueuedShard, std::vector<QueuedShard>, LowerPriority> queuedShards;
+    // queued or in flight, keyed by shard number which is also the id of its job
+    std::map<unsigned long, PendingShard> pendingShards;
+    unsigned long submittedShards = 0;
+    unsigned int runningWorkers;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+public:
+    ShardCoordinator(unsigned int numberOfWorkers, unsigned int shardsPerWorker, ConnectWorker connectWorker);
+    // lets the workers answer their shards and waits for them to exit
+    ~ShardCoordinator();
+
+    ShardCoordinator(const ShardCoordinator&) = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+    // the future throws std::runtime_error when the worker answered with an error or the shard failed too often
+    std::future<ServedClusterRun> submit(const Shard& shard, double expectedCost = 0.0);
+
+    // shards all workers together run at once
+    [[nodiscard]]
+    unsigned int getMaximalNumberOfShardsInFlight() const;
+private:
+    // connects workers one after the other until stopping, or until one after another died without an answer
+    void runWorker(unsigned int workerNumber);
+
+    // returns the number of shards answered before the connection ended
+    std::size_t serveConnection(WorkerConnection& connection);
+
+    // takes the shard out of pendingShards, the caller holds shardsMutex
+    void resolveShard(unsigned long shardNumber, const JobResponse& response);
+};
+
+#endif // FUZZY_REGRESSION_SHARDCOORDINATOR_HPP
@@ -0,0 +1,44 @@
+#ifndef FUZZY_REGRESSION_WORKERCONNECTION_HPP
+#define FUZZY_REGRESSION_WORKERCONNECTION_HPP
+
+#include <string>
+#include <vector>
+
+// Line channel to one worker of a ShardCoordinator, which writes jobs of the -serve protocol and reads the
+// answers. Another transport, e.g. TCP to a -serve process on another machine, only has to implement this.
+// writeLine and closeForWriting are called by one thread and readLine by another.
+class WorkerConnection{
+public:
+    virtual ~WorkerConnection() = default;
+
+    // false once the worker cannot be reached any more
+    virtual bool writeLine(const std::string& line) = 0;
+
+    // false at the end of input, when the worker exited or closed the connection
+    virtual bool readLine(std::string& line) = 0;
+
+    // the worker answers the jobs it has and then ends the connection
+    virtual void closeForWriting() = 0;
+};
+
+// Worker process started with the given arguments (the first one is the executable), its standard input and
+// output are one end of a Unix domain socket pair. The destructor waits for the process to exit.
+class LocalWorkerProcess : public WorkerConnection{
+private:
+    int workerSocket = -1;
+    long processId = -1;
+    std::string pendingInput;
+public:
+    // throws std::runtime_error when the process cannot be started or where Unix domain sockets are not available
+    explicit LocalWorkerProcess(const std::vector<std::string>& arguments);
+    ~LocalWorkerProcess() override;
+
+    LocalWorkerProcess(const LocalWorkerProcess&) = delete;
+    LocalWorkerProcess& operator=(const LocalWorkerProcess&) = delete;
+
+    bool writeLine(const std::string& line) override;
+    bool readLine(std::string& line) override;
+    void closeForWriting() override;
+};
+
+#endif // FUZZY_REGRESSION_WORKERCONNECTION_HPP
@@ -0,0 +1,83 @@
+#ifndef FUZZY_REGRESSION_BATCHSOURCE_HPP
+#define FUZZY_REGRESSION_BATCHSOURCE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "matrix/MatrixView.hpp"
+
+// Sequence of consecutive datum batches, each seen attribute-major (one row per attribute).
+// Out-of-core clustering reads a dataset through it one batch at a time, possibly several times.
+class BatchSource{
+public:
+    virtual ~BatchSource() = default;
+
+    // returns an empty view once all datums were read, the view stays valid until the next call
+    [[nodiscard]]
+    virtual MatrixView<const double> nextBatch() = 0;
+
+    virtual void rewind() = 0;
+
+    [[nodiscard]]
+    virtual std::size_t getNumberOfData() const = 0;
+
+    [[nodiscard]]
+    virtual std::size_t getNumberOfAttributes() const = 0;
+};
+
+// Batches sliced from data which is already addressable, e.g. a memory-mapped columnar file.
+// No datum is copied, the operating system pages the file in and out as batches are visited.
+class MatrixBatchSource : public BatchSource{
+private:
+    const MatrixView<const double> attributeMajorData;
+    const std::size_t batchSize;
+    std::size_t nextDatum = 0;
+public:
+    MatrixBatchSource(const MatrixView<const double>& attributeMajorData, std::size_t batchSize);
+
+    [[nodiscard]]
+    MatrixView<const double> nextBatch() override;
+    void rewind() override;
+
+    [[nodiscard]]
+    std::size_t getNumberOfData() const override;
+    [[nodiscard]]
+    std::size_t getNumberOfAttributes() const override;
+};
+
+// Batches parsed from a tuple text file (the TupleWriter format) through a buffer of batchSize tuples,
+// so that memory use does not depend on the file size.
+class TupleBatchReader : public BatchSource{
+private:
+    const std::filesystem::path inputPath;
+    const std::size_t batchSize;
+    std::ifstream inputFile;
+    std::size_t numberOfData = 0;
+    std::size_t numberOfAttributes = 0;
+    std::size_t lineNumber = 0;
+    std::string line;
+    std::vector<double> batchBuffer;
+public:
+    // counts the tuples of the file first, which is a full pass over it
+    TupleBatchReader(const std::filesystem::path& inputPath, std::size_t batchSize);
+    // trusts the shape counted by an earlier reader of the same file
+    TupleBatchReader(const std::filesystem::path& inputPath, std::size_t batchSize,
+                     std::size_t numberOfData, std::size_t numberOfAttributes);
+
+    // throws std::runtime_error naming the line number of a malformed line
+    [[nodiscard]]
+    MatrixView<const double> nextBatch() override;
+    void rewind() override;
+
+    [[nodiscard]]
+    std::size_t getNumberOfData() const override;
+    [[nodiscard]]
+    std::size_t getNumberOfAttributes() const override;
+private:
+    void countTuples();
+};
+
+#endif // FUZZY_REGRESSION_BATCHSOURCE_HPP
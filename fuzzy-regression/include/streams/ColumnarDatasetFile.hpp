@@ -0,0 +1,80 @@
+#ifndef FUZZY_REGRESSION_COLUMNARDATASETFILE_HPP
+#define FUZZY_REGRESSION_COLUMNARDATASETFILE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "matrix/MatrixView.hpp"
+#include "streams/MappedFile.hpp"
+
+// 64 byte header followed by one column per attribute, every column starts at a 64 byte boundary.
+// All integers and values are stored in the byte order of the machine which wrote the file.
+struct ColumnarDatasetHeader{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t dataType;
+    std::uint64_t numberOfData;
+    std::uint64_t numberOfAttributes;
+    // distance in values between the starts of consecutive columns
+    std::uint64_t columnStride;
+    std::uint64_t checksum;
+    // size and modification time of the text file the dataset was converted from, zero when not converted
+    std::uint64_t sourceFileSize;
+    std::int64_t sourceModificationTime;
+};
+
+static_assert(sizeof(ColumnarDatasetHeader) == 64, "Columnar dataset header has to fill one cache line");
+
+// what is recorded of the text file a dataset was converted from
+struct ColumnarDatasetSource{
+    std::uint64_t fileSize;
+    std::int64_t modificationTime;
+
+    [[nodiscard]]
+    static ColumnarDatasetSource describe(const std::filesystem::path& sourceFilePath);
+};
+
+// Binary dataset opened without parsing: the file is mapped and its columns are used in place.
+class ColumnarDatasetFile{
+public:
+    constexpr static const char* FILE_EXTENSION = ".frcol";
+    constexpr static const std::uint32_t FORMAT_VERSION = 2;
+    constexpr static const std::uint32_t FLOAT64_DATA_TYPE = 1;
+    constexpr static const std::size_t COLUMN_ALIGNMENT = 64;
+private:
+    const std::unique_ptr<MappedFile> mappedFile;
+    ColumnarDatasetHeader header{};
+public:
+    explicit ColumnarDatasetFile(const std::filesystem::path& filePath);
+
+    // one row per attribute, one column per datum, rows point straight into the mapping
+    [[nodiscard]]
+    MatrixView<const double> getAttributeMajorData() const;
+
+    [[nodiscard]]
+    const ColumnarDatasetHeader& getHeader() const;
+
+    // recomputes the checksum of the stored columns, touches every page of the file
+    [[nodiscard]]
+    bool hasValidChecksum() const;
+
+    // whether the source file still has the size and modification time recorded when it was converted,
+    // so a text file edited after -convert is noticed without reading it
+    [[nodiscard]]
+    bool isConvertedFrom(const std::filesystem::path& sourceFilePath) const;
+
+    // attributeMajorData has one row per attribute and one column per datum; the source is described
+    // before it is read, so that an edit made while converting shows as a changed source
+    static void write(const std::filesystem::path& filePath,
+                      const MatrixView<const double>& attributeMajorData,
+                      const ColumnarDatasetSource& source = ColumnarDatasetSource{0, 0});
+
+    [[nodiscard]]
+    static std::uint64_t calculateChecksum(const MatrixView<const double>& attributeMajorData);
+
+    [[nodiscard]]
+    static bool isColumnarDatasetFile(const std::filesystem::path& filePath);
+};
+
+#endif // FUZZY_REGRESSION_COLUMNARDATASETFILE_HPP
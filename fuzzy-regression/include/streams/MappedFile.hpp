@@ -0,0 +1,30 @@
+#ifndef FUZZY_REGRESSION_MAPPEDFILE_HPP
+#define FUZZY_REGRESSION_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped so that
+// its pages are loaded on first access, elsewhere it is read into memory at once.
+class MappedFile{
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+    bool mapped = false;
+    std::vector<char> fallbackBuffer;
+public:
+    explicit MappedFile(const std::filesystem::path& filePath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]]
+    const char* getData() const;
+
+    [[nodiscard]]
+    std::size_t getSize() const;
+};
+
+#endif // FUZZY_REGRESSION_MAPPEDFILE_HPP
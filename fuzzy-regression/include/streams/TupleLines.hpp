@@ -0,0 +1,71 @@
+#ifndef FUZZY_REGRESSION_TUPLELINES_HPP
+#define FUZZY_REGRESSION_TUPLELINES_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+
+// Tokenizer shared by the readers of tuple text files: one tuple per line, values separated by blanks,
+// lines holding only blanks are skipped.
+namespace TupleLines {
+    inline bool isSeparator(char character) {
+        return character == ' ' || character == '\t' || character == '\r' || character == '\f' || character == '\v';
+    }
+
+    inline const char* skipSeparators(const char* position, const char* lineEnd) {
+        while (position < lineEnd && isSeparator(*position)) {
+            ++position;
+        }
+        return position;
+    }
+
+    inline bool isBlank(const char* lineBegin, const char* lineEnd) {
+        return skipSeparators(lineBegin, lineEnd) == lineEnd;
+    }
+
+    inline std::size_t countValues(const char* lineBegin, const char* lineEnd) {
+        std::size_t numberOfValues = 0;
+        for (const char* position = skipSeparators(lineBegin, lineEnd); position < lineEnd;) {
+            ++numberOfValues;
+            while (position < lineEnd && !isSeparator(*position)) {
+                ++position;
+            }
+            position = skipSeparators(position, lineEnd);
+        }
+        return numberOfValues;
+    }
+
+    // stores the i-th value of a non-blank line at values[i * stride], returns what is wrong with the line
+    // or an empty string when it holds exactly numberOfAttributes numbers
+    inline std::string parseValues(const char* lineBegin, const char* lineEnd, std::size_t numberOfAttributes,
+                                   double* values, std::size_t stride) {
+        std::size_t attribute = 0;
+        for (const char* position = skipSeparators(lineBegin, lineEnd); position < lineEnd;) {
+            const char* valueBegin = *position == '+' ? position + 1 : position;
+            double value;
+            auto [valueEnd, errorCode] = std::from_chars(valueBegin, lineEnd, value);
+            if (errorCode != std::errc() || (valueEnd < lineEnd && !isSeparator(*valueEnd))) {
+                const char* tokenEnd = valueBegin;
+                while (tokenEnd < lineEnd && !isSeparator(*tokenEnd)) {
+                    ++tokenEnd;
+                }
+                return "cannot parse value \"" + std::string(position, tokenEnd) + "\"";
+            }
+            if (attribute < numberOfAttributes) {
+                values[attribute * stride] = value;
+            }
+            ++attribute;
+            position = skipSeparators(valueEnd, lineEnd);
+        }
+        if (attribute != numberOfAttributes) {
+            return "expected " + std::to_string(numberOfAttributes) + " values, found " + std::to_string(attribute);
+        }
+        return {};
+    }
+
+    inline std::string describeMalformedLine(std::size_t lineNumber, const std::string& problem) {
+        return "line " + std::to_string(lineNumber) + ": " + problem;
+    }
+}
+
+#endif // FUZZY_REGRESSION_TUPLELINES_HPP
@@ -0,0 +1,61 @@
+#ifndef FUZZY_REGRESSION_TUPLEREADER_HPP
+#define FUZZY_REGRESSION_TUPLEREADER_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "concurrency/ThreadPool.hpp"
+#include "matrix/MatrixView.hpp"
+
+struct ParsedTuples{
+    std::size_t numberOfData;
+    std::size_t numberOfAttributes;
+    // numberOfAttributes x numberOfData, all values of one attribute after another
+    std::vector<double> attributeMajorData;
+
+    [[nodiscard]]
+    MatrixView<const double> getAttributeMajorData() const;
+};
+
+// Reads the format written by TupleWriter (whitespace separated doubles, one tuple per line)
+// without going through ksi::reader_complete. The file is mapped, split into newline aligned
+// chunks and the chunks are parsed straight into one preallocated matrix by the calling thread
+// together with workers of the given pool, so that readers running at once share its threads.
+class TupleReader{
+    constexpr static const std::size_t MAX_REPORTED_MALFORMED_LINES = 10;
+private:
+    ThreadPool* const threadPool;
+    const unsigned int numberOfThreads;
+public:
+    // without a pool the calling thread parses alone; numberOfThreads limits the threads parsing one file,
+    // 0 uses the calling thread and every worker of the pool
+    explicit TupleReader(ThreadPool* threadPool = nullptr, unsigned int numberOfThreads = 0) noexcept;
+
+    // throws std::runtime_error naming the line numbers of malformed lines
+    [[nodiscard]]
+    ParsedTuples read(const std::filesystem::path& inputPath) const;
+private:
+    struct Chunk{
+        const char* begin;
+        const char* end;
+        std::size_t firstLineNumber;
+        std::size_t firstDatum;
+        std::size_t numberOfData;
+        std::size_t numberOfLines;
+        std::vector<std::string> malformedLines;
+    };
+
+    [[nodiscard]]
+    std::vector<Chunk> splitIntoChunks(const char* data, std::size_t size) const;
+
+    static void countTuples(Chunk& chunk);
+
+    static void parseTuples(Chunk& chunk, ParsedTuples& parsedTuples);
+
+    [[nodiscard]]
+    static std::size_t countValuesInFirstTuple(const std::vector<Chunk>& chunks);
+};
+
+#endif // FUZZY_REGRESSION_TUPLEREADER_HPP
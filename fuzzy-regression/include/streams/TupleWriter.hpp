@@ -3,18 +3,29 @@
 
 #include "datageneration/LinearRegressionDataGenerator.hpp"
 
+#include <cstddef>
 #include <fstream>
 #include <filesystem>
+#include <string>
 
+// Generates tuples in chunks on a thread pool, every chunk is formatted with std::to_chars into a buffer
+// of its own and the buffers are written to the file in order, so the file does not depend on the number of threads.
 class TupleWriter{
+    constexpr static const std::size_t TUPLES_PER_CHUNK = 1 << 16;
 private:
-    LinearRegressionDataGenerator& dataGenerator;
-    const unsigned int numberOfTuplesToGenerate;
+    const LinearRegressionDataGenerator& dataGenerator;
+    const std::size_t numberOfTuplesToGenerate;
+    const unsigned int numberOfThreads;
 public:
-    TupleWriter(LinearRegressionDataGenerator& dataGenerator,
-                unsigned int numberOfTuplesToGenerate) noexcept;
+    // 0 threads uses all cores
+    TupleWriter(const LinearRegressionDataGenerator& dataGenerator,
+                std::size_t numberOfTuplesToGenerate,
+                unsigned int numberOfThreads = 0) noexcept;
 
     void generateTuplesAndSaveWithFilename(const std::filesystem::path&& outputPath);
+private:
+    [[nodiscard]]
+    std::string formatChunk(std::size_t firstTupleNumber, std::size_t numberOfTuples) const;
 };
 
 
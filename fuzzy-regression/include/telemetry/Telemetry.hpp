@@ -0,0 +1,165 @@
+#ifndef FUZZY_REGRESSION_TELEMETRY_HPP
+#define FUZZY_REGRESSION_TELEMETRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class TelemetryFormat{
+    CSV,
+    JSON_LINES,
+    // trace event format read by chrome://tracing and Perfetto
+    CHROME_TRACE
+};
+
+// Records scoped durations and counters of the hot paths while it is alive, e.g. every stage of
+// FuzzyRegression::processDataset and every FCM iteration with its objective value. Durations carry the
+// number of allocations and allocated bytes of their thread during the scope. Instrumented code goes
+// through the FUZZY_REGRESSION_TELEMETRY_* macros, which check for a recorder once per scope and compile
+// to nothing when the FUZZY_REGRESSION_TELEMETRY option is off.
+class Telemetry{
+private:
+    struct Event{
+        // string literal naming the scope or counter
+        const char* name;
+        bool counter;
+        std::uint32_t threadNumber;
+        // number of clusters of the FuzzyRegression run on the thread, 0 outside of it
+        int numberOfClusters;
+        std::uint64_t startNanoseconds;
+        std::uint64_t durationNanoseconds;
+        double value;
+        std::uint64_t allocations;
+        std::uint64_t allocatedBytes;
+    };
+
+    static std::atomic<Telemetry*> activeRecorder;
+    const std::uint64_t originNanoseconds;
+    mutable std::mutex eventsMutex;
+    std::vector<Event> events;
+public:
+    // becomes the active recorder, only one may exist at a time
+    Telemetry();
+    ~Telemetry();
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    [[nodiscard]]
+    static Telemetry* active() {
+        return activeRecorder.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]]
+    static constexpr bool isCompiledIn() {
+#ifdef FUZZY_REGRESSION_TELEMETRY
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // csv, jsonl or chrome, throws std::invalid_argument otherwise
+    [[nodiscard]]
+    static TelemetryFormat parseFormat(const std::string& formatName);
+
+    [[nodiscard]]
+    static std::string fileExtension(TelemetryFormat format);
+
+    [[nodiscard]]
+    static std::uint64_t now();
+
+    // allocations made through operator new on the calling thread while a recorder was active,
+    // 0 without FUZZY_REGRESSION_TELEMETRY
+    [[nodiscard]]
+    static std::uint64_t allocationsOnThisThread();
+
+    [[nodiscard]]
+    static std::uint64_t allocatedBytesOnThisThread();
+
+    // largest resident set size of the process so far, 0 where it cannot be queried
+    [[nodiscard]]
+    static std::uint64_t peakResidentBytes();
+
+    // number of clusters events of the calling thread are attributed to
+    static void setNumberOfClusters(int numberOfClusters);
+
+    void recordDuration(const char* name,
+                        std::uint64_t startNanoseconds,
+                        std::uint64_t endNanoseconds,
+                        std::uint64_t allocations,
+                        std::uint64_t allocatedBytes);
+
+    void recordCounter(const char* name, double value);
+
+    void write(std::ostream& outputStream, TelemetryFormat format) const;
+private:
+    [[nodiscard]]
+    static std::uint32_t threadNumber();
+
+    void writeCsv(std::ostream& outputStream, const std::vector<Event>& sortedEvents) const;
+    void writeJsonLines(std::ostream& outputStream, const std::vector<Event>& sortedEvents) const;
+    void writeChromeTrace(std::ostream& outputStream, const std::vector<Event>& sortedEvents) const;
+};
+
+// records the duration of the enclosing scope when a recorder is active
+class TelemetryScope{
+private:
+    const char* const name;
+    Telemetry* recorder;
+    std::uint64_t startNanoseconds = 0;
+    std::uint64_t startAllocations = 0;
+    std::uint64_t startAllocatedBytes = 0;
+public:
+    explicit TelemetryScope(const char* name)
+    : name(name),
+    recorder(Telemetry::active()) {
+        if (recorder != nullptr) {
+            startAllocations = Telemetry::allocationsOnThisThread();
+            startAllocatedBytes = Telemetry::allocatedBytesOnThisThread();
+            startNanoseconds = Telemetry::now();
+        }
+    }
+
+    ~TelemetryScope() {
+        end();
+    }
+
+    // records the duration up to now, for stages whose results outlive them
+    void end() {
+        if (recorder != nullptr) {
+            recorder->recordDuration(name, startNanoseconds, Telemetry::now(),
+                                     Telemetry::allocationsOnThisThread() - startAllocations,
+                                     Telemetry::allocatedBytesOnThisThread() - startAllocatedBytes);
+            recorder = nullptr;
+        }
+    }
+
+    TelemetryScope(const TelemetryScope&) = delete;
+    TelemetryScope& operator=(const TelemetryScope&) = delete;
+};
+
+#define FUZZY_REGRESSION_TELEMETRY_CONCATENATE_INNER(first, second) first##second
+#define FUZZY_REGRESSION_TELEMETRY_CONCATENATE(first, second) FUZZY_REGRESSION_TELEMETRY_CONCATENATE_INNER(first, second)
+
+#ifdef FUZZY_REGRESSION_TELEMETRY
+#define FUZZY_REGRESSION_TELEMETRY_ACTIVE() (Telemetry::active() != nullptr)
+#define FUZZY_REGRESSION_TELEMETRY_SCOPE(name) \
+        const TelemetryScope FUZZY_REGRESSION_TELEMETRY_CONCATENATE(telemetryScope, __LINE__)(name)
+#define FUZZY_REGRESSION_TELEMETRY_STAGE(variable, name) TelemetryScope variable(name)
+#define FUZZY_REGRESSION_TELEMETRY_END_STAGE(variable) variable.end()
+#define FUZZY_REGRESSION_TELEMETRY_COUNTER(name, value) \
+        do { if (Telemetry* telemetryRecorder = Telemetry::active()) { telemetryRecorder->recordCounter(name, value); } } while (false)
+#else
+#define FUZZY_REGRESSION_TELEMETRY_ACTIVE() false
+#define FUZZY_REGRESSION_TELEMETRY_SCOPE(name) do {} while (false)
+#define FUZZY_REGRESSION_TELEMETRY_STAGE(variable, name) do {} while (false)
+#define FUZZY_REGRESSION_TELEMETRY_END_STAGE(variable) do {} while (false)
+// the value is not evaluated, sizeof only keeps variables computed for it from being unused
+#define FUZZY_REGRESSION_TELEMETRY_COUNTER(name, value) do { (void) sizeof(value); } while (false)
+#endif
+
+#endif // FUZZY_REGRESSION_TELEMETRY_HPP
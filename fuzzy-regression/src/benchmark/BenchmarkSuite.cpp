@@ -0,0 +1,505 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "auxiliary/least-error-squares-regression.h"
+#include "readers/reader-complete.h"
+#include "benchmark/BenchmarkSuite.hpp"
+#include "datageneration/LinearRegressionDataGenerator.hpp"
+#include "regression/WeightedLeastSquares.hpp"
+
+namespace {
+    const char* const CSV_HEADER = "stage;engine;numberOfData;numberOfAttributes;numberOfClusters;repetitions;"
+                                   "minimumNs;medianNs;meanNs;standardDeviationNs;maximumNs";
+
+    // the text file is needed only because ksi::dataset is filled by its reader
+    ksi::dataset readIntoKsiDataset(const MatrixView<const double>& attributeMajorData) {
+        const std::filesystem::path temporaryPath = std::filesystem::temp_directory_path() /
+                ("fuzzy-regression-bench-" + std::to_string(attributeMajorData.getNumberOfColumns()) + "x"
+                 + std::to_string(attributeMajorData.getNumberOfRows()) + ".txt");
+        {
+            std::ofstream temporaryFile(temporaryPath);
+            if (!temporaryFile.is_open()) {
+                throw std::runtime_error("Could not create " + temporaryPath.string());
+            }
+            temporaryFile.precision(std::numeric_limits<double>::max_digits10);
+            for (std::size_t datum = 0; datum < attributeMajorData.getNumberOfColumns(); ++datum) {
+                for (std::size_t attribute = 0; attribute < attributeMajorData.getNumberOfRows(); ++attribute) {
+                    temporaryFile << attributeMajorData(attribute, datum) << " ";
+                }
+                temporaryFile << "\n";
+            }
+        }
+        ksi::reader_complete input;
+        ksi::dataset dataset = input.read(temporaryPath.string());
+        std::filesystem::remove(temporaryPath);
+        return dataset;
+    }
+
+    // largest magnitude of every attribute, so that differences of centres are comparable across attributes
+    std::vector<double> findAttributeScales(const MatrixView<const double>& attributeMajorData) {
+        std::vector<double> attributeScales(attributeMajorData.getNumberOfRows(), 0.0);
+        for (std::size_t attribute = 0; attribute < attributeScales.size(); ++attribute) {
+            for (std::size_t datum = 0; datum < attributeMajorData.getNumberOfColumns(); ++datum) {
+                attributeScales[attribute] = std::max(attributeScales[attribute],
+                                                      std::abs(attributeMajorData(attribute, datum)));
+            }
+            if (attributeScales[attribute] == 0) {
+                attributeScales[attribute] = 1;
+            }
+        }
+        return attributeScales;
+    }
+
+    double relativeCentreDifference(const FuzzyPartition& first, std::size_t firstCluster,
+                                    const FuzzyPartition& second, std::size_t secondCluster,
+                                    const std::vector<double>& attributeScales) {
+        double difference = 0;
+        for (std::size_t attribute = 0; attribute < attributeScales.size(); ++attribute) {
+            difference = std::max(difference,
+                                  std::abs(first.getClusterCentres()(firstCluster, attribute)
+                                           - second.getClusterCentres()(secondCluster, attribute))
+                                  / attributeScales[attribute]);
+        }
+        return difference;
+    }
+
+    // the native cluster matched to every ksi cluster, closest pairs of centres are matched first
+    std::vector<std::size_t> matchClusters(const FuzzyPartition& ksiPartition,
+                                           const FuzzyPartition& nativePartition,
+                                           const std::vector<double>& attributeScales) {
+        const std::size_t numberOfClusters = ksiPartition.numberOfClusters;
+        std::vector<std::tuple<double, std::size_t, std::size_t>> pairs;
+        pairs.reserve(numberOfClusters * numberOfClusters);
+        for (std::size_t ksiCluster = 0; ksiCluster < numberOfClusters; ++ksiCluster) {
+            for (std::size_t nativeCluster = 0; nativeCluster < numberOfClusters; ++nativeCluster) {
+                pairs.emplace_back(relativeCentreDifference(ksiPartition, ksiCluster, nativePartition, nativeCluster,
+                                                            attributeScales),
+                                   ksiCluster, nativeCluster);
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+        std::vector<std::size_t> matchedClusters(numberOfClusters, numberOfClusters);
+        std::vector<bool> nativeClusterMatched(numberOfClusters, false);
+        for (const auto& [difference, ksiCluster, nativeCluster] : pairs) {
+            if (matchedClusters[ksiCluster] == numberOfClusters && !nativeClusterMatched[nativeCluster]) {
+                matchedClusters[ksiCluster] = nativeCluster;
+                nativeClusterMatched[nativeCluster] = true;
+            }
+        }
+        return matchedClusters;
+    }
+
+    // largest difference between the WeightedLeastSquares and ksi coefficients of the regression on the centres,
+    // relative to the largest ksi coefficient; empty when fewer clusters than coefficients have a weight
+    std::optional<double> relativeCoefficientDifference(const FuzzyPartition& partition) {
+        const std::size_t numberOfCoefficients = partition.numberOfAttributes - 1;
+        std::vector<std::size_t> datumCounts;
+        FuzzyCMeans::countHighestMemberships(partition.getPartitionMatrix(), datumCounts);
+        std::vector<double> weights;
+        std::vector<std::vector<double>> describingRows(partition.numberOfClusters);
+        std::vector<double> describedColumn;
+        for (std::size_t cluster = 0; cluster < partition.numberOfClusters; ++cluster) {
+            weights.push_back((double) datumCounts[cluster] / (double) partition.numberOfData);
+            for (std::size_t attribute = 0; attribute < numberOfCoefficients; ++attribute) {
+                describingRows[cluster].push_back(partition.getClusterCentres()(cluster, attribute));
+            }
+            describedColumn.push_back(partition.getClusterCentres()(cluster, numberOfCoefficients));
+        }
+        if ((std::size_t) std::count_if(weights.begin(), weights.end(), [](double weight) { return weight > 0; })
+            < numberOfCoefficients) {
+            return std::nullopt;
+        }
+        const MatrixView<const double> centres = partition.getClusterCentres();
+        const std::vector<double> nativeCoefficients = WeightedLeastSquares().solve(
+                centres.block(0, 0, partition.numberOfClusters, numberOfCoefficients),
+                centres.column(numberOfCoefficients), weights);
+        const std::vector<double> ksiCoefficients = ksi::least_square_error_regression::weighted_linear_regression(
+                describingRows, describedColumn, weights);
+        double largestCoefficient = 0;
+        double largestDifference = 0;
+        for (std::size_t coefficient = 0; coefficient < numberOfCoefficients; ++coefficient) {
+            largestCoefficient = std::max(largestCoefficient, std::abs(ksiCoefficients[coefficient]));
+            largestDifference = std::max(largestDifference,
+                                         std::abs(nativeCoefficients[coefficient] - ksiCoefficients[coefficient]));
+        }
+        return largestCoefficient > 0 ? largestDifference / largestCoefficient : largestDifference;
+    }
+
+    std::optional<std::pair<ClusteringEngine, ClusteringPrecision>> parseEngineName(const std::string& name) {
+        if (name == BenchmarkSuite::engineName(ClusteringEngine::NATIVE)) {
+            return std::make_pair(ClusteringEngine::NATIVE, ClusteringPrecision::DOUBLE);
+        }
+        if (name == BenchmarkSuite::engineName(ClusteringEngine::NATIVE, ClusteringPrecision::MIXED)) {
+            return std::make_pair(ClusteringEngine::NATIVE, ClusteringPrecision::MIXED);
+        }
+        if (name == BenchmarkSuite::engineName(ClusteringEngine::KSI)) {
+            return std::make_pair(ClusteringEngine::KSI, ClusteringPrecision::DOUBLE);
+        }
+        return std::nullopt;
+    }
+
+    auto caseKey(const BenchmarkStatistics& statistics) {
+        const auto& benchmarkCase = statistics.benchmarkCase;
+        return std::make_tuple(statistics.stage,
+                               BenchmarkSuite::engineName(benchmarkCase.clusteringEngine,
+                                                          benchmarkCase.clusteringPrecision),
+                               benchmarkCase.numberOfData,
+                               benchmarkCase.numberOfDescribingAttributes,
+                               benchmarkCase.numberOfClusters);
+    }
+}
+
+BenchmarkSuite::BenchmarkSuite(BenchmarkSettings settings)
+: settings(std::move(settings)){}
+
+std::vector<BenchmarkStatistics> BenchmarkSuite::run(std::ostream& progressStream) const {
+    std::vector<BenchmarkStatistics> results;
+    for (const auto numberOfData : settings.dataSizes) {
+        for (const auto numberOfDescribingAttributes : settings.describingAttributeCounts) {
+            const BenchmarkCase datasetCase{numberOfData, numberOfDescribingAttributes, 0, ClusteringEngine::NATIVE,
+                                            ClusteringPrecision::DOUBLE};
+            const std::vector<double> attributeMajorBuffer = generateAttributeMajorData(datasetCase);
+            const auto attributeMajorData = MatrixView<const double>::rowMajor(attributeMajorBuffer.data(),
+                                                                               numberOfDescribingAttributes + 1,
+                                                                               numberOfData);
+            std::optional<ksi::dataset> dataset;
+            for (const auto numberOfClusters : settings.clusterCounts) {
+                if ((std::size_t) numberOfClusters > numberOfData) {
+                    continue;
+                }
+                std::optional<RegressionResult> doublePrecisionResult;
+                for (const auto clusteringEngine : settings.clusteringEngines) {
+                    if (clusteringEngine == ClusteringEngine::KSI && !dataset.has_value()) {
+                        dataset = readIntoKsiDataset(attributeMajorData);
+                    }
+                    for (const auto clusteringPrecision : settings.clusteringPrecisions) {
+                        if (clusteringEngine == ClusteringEngine::KSI && clusteringPrecision != ClusteringPrecision::DOUBLE) {
+                            continue;
+                        }
+                        const BenchmarkCase benchmarkCase{numberOfData, numberOfDescribingAttributes, numberOfClusters,
+                                                          clusteringEngine, clusteringPrecision};
+                        progressStream << engineName(clusteringEngine, clusteringPrecision) << " n=" << numberOfData
+                                       << " attributes=" << numberOfDescribingAttributes + 1
+                                       << " clusters=" << numberOfClusters << "\n";
+                        std::optional<RegressionResult> lastResult;
+                        auto caseResults = runCase(benchmarkCase,
+                                                   clusteringEngine == ClusteringEngine::KSI ? &*dataset : nullptr,
+                                                   attributeMajorData,
+                                                   settings.numberOfRepetitions,
+                                                   lastResult);
+                        std::move(caseResults.begin(), caseResults.end(), std::back_inserter(results));
+                        if (clusteringEngine != ClusteringEngine::NATIVE) {
+                            continue;
+                        }
+                        if (clusteringPrecision == ClusteringPrecision::DOUBLE) {
+                            doublePrecisionResult.emplace(*lastResult);
+                        } else if (doublePrecisionResult.has_value()) {
+                            reportAccuracy(progressStream, *doublePrecisionResult, *lastResult);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return results;
+}
+
+std::size_t BenchmarkSuite::verifyAgainstKsi(std::ostream& outputStream, double tolerance) const {
+    std::size_t numberOfMismatches = 0;
+    for (const auto numberOfData : settings.dataSizes) {
+        for (const auto numberOfDescribingAttributes : settings.describingAttributeCounts) {
+            const BenchmarkCase datasetCase{numberOfData, numberOfDescribingAttributes, 0, ClusteringEngine::NATIVE,
+                                            ClusteringPrecision::DOUBLE};
+            const std::vector<double> attributeMajorBuffer = generateAttributeMajorData(datasetCase);
+            const auto attributeMajorData = MatrixView<const double>::rowMajor(attributeMajorBuffer.data(),
+                                                                               numberOfDescribingAttributes + 1,
+                                                                               numberOfData);
+            const ksi::dataset dataset = readIntoKsiDataset(attributeMajorData);
+            const std::vector<double> attributeScales = findAttributeScales(attributeMajorData);
+            for (const auto numberOfClusters : settings.clusterCounts) {
+                if ((std::size_t) numberOfClusters > numberOfData) {
+                    continue;
+                }
+                ksi::fcm ksiAlgorithm;
+                ksiAlgorithm.setEpsilonForFrobeniusNorm(FuzzyRegression::EPSILON_DEFAULT_VALUE);
+                ksiAlgorithm.setNumberOfClusters(numberOfClusters);
+                const FuzzyPartition ksiPartition = FuzzyPartition::fromKsiPartition(ksiAlgorithm.doPartition(dataset));
+                FuzzyCMeans nativeAlgorithm;
+                nativeAlgorithm.setEpsilonForFrobeniusNorm(FuzzyRegression::EPSILON_DEFAULT_VALUE);
+                nativeAlgorithm.setNumberOfClusters(numberOfClusters);
+                const FuzzyPartition nativePartition = nativeAlgorithm.doPartition(attributeMajorData);
+
+                const std::vector<std::size_t> matchedClusters = matchClusters(ksiPartition, nativePartition,
+                                                                               attributeScales);
+                double largestCentreDifference = 0;
+                double largestMembershipDifference = 0;
+                for (std::size_t ksiCluster = 0; ksiCluster < ksiPartition.numberOfClusters; ++ksiCluster) {
+                    const std::size_t nativeCluster = matchedClusters[ksiCluster];
+                    largestCentreDifference = std::max(largestCentreDifference, relativeCentreDifference(
+                            ksiPartition, ksiCluster, nativePartition, nativeCluster, attributeScales));
+                    for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+                        largestMembershipDifference = std::max(largestMembershipDifference, std::abs(
+                                ksiPartition.getPartitionMatrix()(ksiCluster, datum)
+                                - nativePartition.getPartitionMatrix()(nativeCluster, datum)));
+                    }
+                }
+                // different objectives mean the engines stopped in different local minima, e.g. from other starts
+                const double ksiObjective = nativeAlgorithm.calculateObjective(attributeMajorData,
+                                                                               ksiPartition.clusterCentres);
+                const double nativeObjective = nativeAlgorithm.calculateObjective(attributeMajorData,
+                                                                                  nativePartition.clusterCentres);
+                const bool mismatch = !(largestCentreDifference <= tolerance && largestMembershipDifference <= tolerance);
+                numberOfMismatches += mismatch ? 1 : 0;
+                outputStream << "clustering n=" << numberOfData << " attributes=" << numberOfDescribingAttributes + 1
+                             << " clusters=" << numberOfClusters << ": centre difference " << largestCentreDifference
+                             << ", membership difference " << largestMembershipDifference
+                             << ", objective native " << nativeObjective << " ksi " << ksiObjective
+                             << (mismatch ? " MISMATCH" : "") << "\n";
+
+                const std::optional<double> coefficientDifference = relativeCoefficientDifference(nativePartition);
+                outputStream << "regression n=" << numberOfData << " attributes=" << numberOfDescribingAttributes + 1
+                             << " clusters=" << numberOfClusters << ": ";
+                if (!coefficientDifference.has_value()) {
+                    outputStream << "skipped, fewer weighted clusters than coefficients\n";
+                    continue;
+                }
+                const bool coefficientMismatch = !(*coefficientDifference <= tolerance);
+                numberOfMismatches += coefficientMismatch ? 1 : 0;
+                outputStream << "coefficient difference " << *coefficientDifference
+                             << (coefficientMismatch ? " MISMATCH" : "") << "\n";
+            }
+        }
+    }
+    return numberOfMismatches;
+}
+
+std::vector<double> BenchmarkSuite::generateAttributeMajorData(const BenchmarkCase& benchmarkCase) const {
+    std::vector<double> slopeParameters;
+    std::vector<double> slopeDeviations;
+    for (std::size_t i = 0; i < benchmarkCase.numberOfDescribingAttributes; ++i) {
+        slopeParameters.push_back(i % 2 == 0 ? (double) (i + 1) : -(double) (i + 1));
+        slopeDeviations.push_back(0.001 * (double) (i % 5 + 1));
+    }
+    const LinearRegressionDataGenerator generator(std::move(slopeParameters), std::move(slopeDeviations), 2.0, 1000.0,
+                                            settings.seed);
+    const std::size_t numberOfAttributes = generator.getNumberOfAttributes();
+    std::vector<double> tuples(numberOfAttributes * benchmarkCase.numberOfData);
+    generator.generateTuples(0, benchmarkCase.numberOfData, tuples.data());
+    std::vector<double> attributeMajorBuffer(numberOfAttributes * benchmarkCase.numberOfData);
+    for (std::size_t datum = 0; datum < benchmarkCase.numberOfData; ++datum) {
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            attributeMajorBuffer[attribute * benchmarkCase.numberOfData + datum] = tuples[datum * numberOfAttributes + attribute];
+        }
+    }
+    return attributeMajorBuffer;
+}
+
+std::vector<BenchmarkStatistics> BenchmarkSuite::runCase(const BenchmarkCase& benchmarkCase,
+                                                         const ksi::dataset* dataset,
+                                                         const MatrixView<const double>& attributeMajorData,
+                                                         std::size_t numberOfRepetitions,
+                                                         std::optional<RegressionResult>& lastResult) {
+    std::vector<double> clusteringSamples;
+    std::vector<double> dataPreparationSamples;
+    std::vector<double> regressionSamples;
+    std::vector<double> errorCalculationSamples;
+    std::vector<double> totalSamples;
+    std::ostringstream discardedPerformanceRecord;
+    // the first run only warms up caches and the allocator
+    for (std::size_t repetition = 0; repetition <= numberOfRepetitions; ++repetition) {
+        auto fuzzyRegression = dataset != nullptr
+                ? FuzzyRegression(*dataset, benchmarkCase.numberOfClusters, ClusteringEngine::KSI)
+                : FuzzyRegression(attributeMajorData, benchmarkCase.numberOfClusters);
+        if (dataset == nullptr) {
+            fuzzyRegression.setClusteringPrecision(benchmarkCase.clusteringPrecision);
+        }
+        auto start = std::chrono::steady_clock::now();
+        lastResult.emplace(fuzzyRegression.processDataset(discardedPerformanceRecord));
+        auto end = std::chrono::steady_clock::now();
+        discardedPerformanceRecord.str({});
+        if (repetition == 0) {
+            continue;
+        }
+        const StageDurations& stageDurations = fuzzyRegression.getStageDurations();
+        clusteringSamples.push_back((double) stageDurations.clusteringNanoseconds);
+        dataPreparationSamples.push_back((double) stageDurations.dataPreparationNanoseconds);
+        regressionSamples.push_back((double) stageDurations.regressionNanoseconds);
+        errorCalculationSamples.push_back((double) stageDurations.errorCalculationNanoseconds);
+        totalSamples.push_back((double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    return {summarise("clustering", benchmarkCase, std::move(clusteringSamples)),
+            summarise("dataPreparation", benchmarkCase, std::move(dataPreparationSamples)),
+            summarise("regression", benchmarkCase, std::move(regressionSamples)),
+            summarise("errorCalculation", benchmarkCase, std::move(errorCalculationSamples)),
+            summarise("total", benchmarkCase, std::move(totalSamples))};
+}
+
+void BenchmarkSuite::reportAccuracy(std::ostream& progressStream,
+                                    const RegressionResult& doublePrecisionResult,
+                                    const RegressionResult& result) {
+    const std::vector<double>& doublePrecisionCoefficients = doublePrecisionResult.regressionDescribingParameters;
+    const std::vector<double>& coefficients = result.regressionDescribingParameters;
+    double largestCoefficientDifference = 0;
+    for (std::size_t i = 0; i < std::min(coefficients.size(), doublePrecisionCoefficients.size()); ++i) {
+        largestCoefficientDifference = std::max(largestCoefficientDifference,
+                                                std::abs(coefficients[i] - doublePrecisionCoefficients[i]));
+    }
+    progressStream << "  against double precision: largest coefficient difference " << largestCoefficientDifference
+                   << ", regression error difference "
+                   << std::abs(result.coefficientOfDetermination - doublePrecisionResult.coefficientOfDetermination)
+                   << "\n";
+}
+
+BenchmarkStatistics BenchmarkSuite::summarise(const std::string& stage,
+                                              const BenchmarkCase& benchmarkCase,
+                                              std::vector<double> samples) {
+    if (samples.empty()) {
+        throw std::invalid_argument("At least one repetition is required");
+    }
+    std::sort(samples.begin(), samples.end());
+    const std::size_t numberOfSamples = samples.size();
+    const double median = numberOfSamples % 2 == 1
+            ? samples[numberOfSamples / 2]
+            : (samples[numberOfSamples / 2 - 1] + samples[numberOfSamples / 2]) / 2;
+    const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / (double) numberOfSamples;
+    double sumOfSquaredDeviations = 0;
+    for (const auto sample : samples) {
+        sumOfSquaredDeviations += (sample - mean) * (sample - mean);
+    }
+    const double standardDeviation = numberOfSamples > 1
+            ? std::sqrt(sumOfSquaredDeviations / (double) (numberOfSamples - 1))
+            : 0.0;
+    return BenchmarkStatistics{stage, benchmarkCase, numberOfSamples,
+                               samples.front(), median, mean, standardDeviation, samples.back()};
+}
+
+void BenchmarkSuite::writeCsv(std::ostream& outputStream, const std::vector<BenchmarkStatistics>& results) {
+    const auto previousFlags = outputStream.flags();
+    const auto previousPrecision = outputStream.precision();
+    outputStream << CSV_HEADER << "\n";
+    for (const auto& statistics : results) {
+        const auto& benchmarkCase = statistics.benchmarkCase;
+        outputStream << statistics.stage << ";"
+                     << engineName(benchmarkCase.clusteringEngine, benchmarkCase.clusteringPrecision) << ";"
+                     << benchmarkCase.numberOfData << ";"
+                     << benchmarkCase.numberOfDescribingAttributes + 1 << ";"
+                     << benchmarkCase.numberOfClusters << ";"
+                     << statistics.numberOfRepetitions << ";"
+                     << std::fixed << std::setprecision(0)
+                     << statistics.minimum << ";"
+                     << statistics.median << ";"
+                     << statistics.mean << ";"
+                     << statistics.standardDeviation << ";"
+                     << statistics.maximum << "\n";
+    }
+    outputStream.flags(previousFlags);
+    outputStream.precision(previousPrecision);
+}
+
+void BenchmarkSuite::writeJson(std::ostream& outputStream, const std::vector<BenchmarkStatistics>& results) {
+    const auto previousFlags = outputStream.flags();
+    const auto previousPrecision = outputStream.precision();
+    outputStream << "[\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& statistics = results[i];
+        const auto& benchmarkCase = statistics.benchmarkCase;
+        outputStream << "  {\"stage\": \"" << statistics.stage << "\""
+                     << ", \"engine\": \"" << engineName(benchmarkCase.clusteringEngine, benchmarkCase.clusteringPrecision)
+                     << "\""
+                     << ", \"numberOfData\": " << benchmarkCase.numberOfData
+                     << ", \"numberOfAttributes\": " << benchmarkCase.numberOfDescribingAttributes + 1
+                     << ", \"numberOfClusters\": " << benchmarkCase.numberOfClusters
+                     << ", \"repetitions\": " << statistics.numberOfRepetitions
+                     << std::fixed << std::setprecision(0)
+                     << ", \"minimumNs\": " << statistics.minimum
+                     << ", \"medianNs\": " << statistics.median
+                     << ", \"meanNs\": " << statistics.mean
+                     << ", \"standardDeviationNs\": " << statistics.standardDeviation
+                     << ", \"maximumNs\": " << statistics.maximum
+                     << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    outputStream << "]\n";
+    outputStream.flags(previousFlags);
+    outputStream.precision(previousPrecision);
+}
+
+std::vector<BenchmarkStatistics> BenchmarkSuite::readCsv(std::istream& inputStream) {
+    std::vector<BenchmarkStatistics> results;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(inputStream, line)) {
+        ++lineNumber;
+        if (line.empty() || line == CSV_HEADER) {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::istringstream lineStream(line);
+        for (std::string field; std::getline(lineStream, field, ';');) {
+            fields.push_back(field);
+        }
+        const auto engineAndPrecision = fields.size() == 11 ? parseEngineName(fields[1]) : std::nullopt;
+        if (!engineAndPrecision.has_value()) {
+            throw std::runtime_error("Benchmark results line " + std::to_string(lineNumber) + " is malformed");
+        }
+        try {
+            const BenchmarkCase benchmarkCase{std::stoul(fields[2]), std::stoul(fields[3]) - 1, std::stoi(fields[4]),
+                                              engineAndPrecision->first, engineAndPrecision->second};
+            results.push_back(BenchmarkStatistics{fields[0], benchmarkCase, std::stoul(fields[5]),
+                                                  std::stod(fields[6]), std::stod(fields[7]), std::stod(fields[8]),
+                                                  std::stod(fields[9]), std::stod(fields[10])});
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Benchmark results line " + std::to_string(lineNumber) + " is malformed");
+        }
+    }
+    return results;
+}
+
+std::size_t BenchmarkSuite::reportRegressions(std::ostream& outputStream,
+                                              const std::vector<BenchmarkStatistics>& baseline,
+                                              const std::vector<BenchmarkStatistics>& results,
+                                              double tolerance) {
+    std::map<decltype(caseKey(baseline.front())), double> baselineMedians;
+    for (const auto& statistics : baseline) {
+        baselineMedians[caseKey(statistics)] = statistics.median;
+    }
+    const auto previousFlags = outputStream.flags();
+    const auto previousPrecision = outputStream.precision();
+    std::size_t numberOfRegressions = 0;
+    for (const auto& statistics : results) {
+        const auto baselineMedian = baselineMedians.find(caseKey(statistics));
+        if (baselineMedian == baselineMedians.end() || statistics.median <= baselineMedian->second * (1 + tolerance)) {
+            continue;
+        }
+        const auto& benchmarkCase = statistics.benchmarkCase;
+        outputStream << "Regression in " << statistics.stage << " ("
+                     << engineName(benchmarkCase.clusteringEngine, benchmarkCase.clusteringPrecision)
+                     << " n=" << benchmarkCase.numberOfData
+                     << " attributes=" << benchmarkCase.numberOfDescribingAttributes + 1
+                     << " clusters=" << benchmarkCase.numberOfClusters << "): median "
+                     << std::fixed << std::setprecision(0) << statistics.median << " ns, baseline "
+                     << baselineMedian->second << " ns\n";
+        ++numberOfRegressions;
+    }
+    outputStream.flags(previousFlags);
+    outputStream.precision(previousPrecision);
+    return numberOfRegressions;
+}
+
+std::string BenchmarkSuite::engineName(ClusteringEngine clusteringEngine, ClusteringPrecision clusteringPrecision) {
+    if (clusteringEngine != ClusteringEngine::NATIVE) {
+        return "ksi";
+    }
+    return clusteringPrecision == ClusteringPrecision::MIXED ? "native-mixed" : "native";
+}
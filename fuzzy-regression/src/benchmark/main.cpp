@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/BenchmarkSuite.hpp"
+
+namespace {
+    std::optional<std::string> findArgumentValue(const std::vector<std::string>& arguments,
+                                                 const std::string& argumentName) {
+        const std::string prefix = argumentName + "=";
+        for (const auto& argument : arguments) {
+            if (argument.rfind(prefix, 0) == 0) {
+                return argument.substr(prefix.size());
+            }
+        }
+        return std::nullopt;
+    }
+
+    template<typename Value>
+    std::vector<Value> parseList(const std::optional<std::string>& argumentValue, std::vector<Value> defaultValues) {
+        if (!argumentValue.has_value()) {
+            return defaultValues;
+        }
+        std::vector<Value> values;
+        std::istringstream valueStream(*argumentValue);
+        for (std::string value; std::getline(valueStream, value, ',');) {
+            values.push_back((Value) std::stoul(value));
+        }
+        return values;
+    }
+
+    void printUsage() {
+        std::cout << "Benchmarks every stage of fuzzy regression on synthetic data\n"
+                  << "-n=N,... numbers of data (default 1000,10000,100000)\n"
+                  << "-attributes=N,... numbers of attributes including the described one (default 3,6,11)\n"
+                  << "-clusters=N,... numbers of clusters (default 2,8,32)\n"
+                  << "-repetitions=N measured runs per case after one warm-up run (default 5)\n"
+                  << "-seed=N seed of the data generator (default 5489)\n"
+                  << "-ksi also benchmarks clustering with ksi::fcm\n"
+                  << "-mixed also benchmarks native mixed-precision clustering and reports its accuracy against double\n"
+                  << "-format=csv|json output format (default csv)\n"
+                  << "-output=path writes results to a file instead of standard output\n"
+                  << "-baseline=path compares medians with a previous csv output and fails on regressions\n"
+                  << "-tolerance=X allowed relative slowdown against the baseline (default 0.1)\n"
+                  << "-verify compares the native clustering and regression with ksi on the same grid instead of benchmarking\n"
+                  << "-verifytolerance=X largest accepted centre, membership and coefficient difference (default 1e-6)\n";
+    }
+}
+
+int main(int argument_count, char** argument_variables) {
+    const std::vector<std::string> arguments(argument_variables + 1, argument_variables + argument_count);
+    for (const auto& argument : arguments) {
+        if (argument == "-help" || argument == "--help") {
+            printUsage();
+            return 0;
+        }
+    }
+    try {
+        std::vector<std::size_t> describingAttributeCounts;
+        for (const auto numberOfAttributes : parseList<std::size_t>(findArgumentValue(arguments, "-attributes"),
+                                                                    {3, 6, 11})) {
+            if (numberOfAttributes < 2) {
+                throw std::invalid_argument("Number of attributes has to be at least 2");
+            }
+            describingAttributeCounts.push_back(numberOfAttributes - 1);
+        }
+        std::vector<ClusteringEngine> clusteringEngines{ClusteringEngine::NATIVE};
+        if (std::find(arguments.begin(), arguments.end(), "-ksi") != arguments.end()) {
+            clusteringEngines.push_back(ClusteringEngine::KSI);
+        }
+        std::vector<ClusteringPrecision> clusteringPrecisions{ClusteringPrecision::DOUBLE};
+        if (std::find(arguments.begin(), arguments.end(), "-mixed") != arguments.end()) {
+            clusteringPrecisions.push_back(ClusteringPrecision::MIXED);
+        }
+        const auto repetitions = findArgumentValue(arguments, "-repetitions");
+        const auto seed = findArgumentValue(arguments, "-seed");
+        BenchmarkSuite benchmarkSuite(BenchmarkSettings{
+                parseList<std::size_t>(findArgumentValue(arguments, "-n"), {1000, 10000, 100000}),
+                describingAttributeCounts,
+                parseList<int>(findArgumentValue(arguments, "-clusters"), {2, 8, 32}),
+                clusteringEngines,
+                clusteringPrecisions,
+                repetitions.has_value() ? std::stoul(*repetitions) : 5,
+                seed.has_value() ? std::stoull(*seed) : 5489});
+        if (std::find(arguments.begin(), arguments.end(), "-verify") != arguments.end()) {
+            const auto verifyTolerance = findArgumentValue(arguments, "-verifytolerance");
+            const std::size_t numberOfMismatches = benchmarkSuite.verifyAgainstKsi(
+                    std::cout, verifyTolerance.has_value() ? std::stod(*verifyTolerance) : 1e-6);
+            if (numberOfMismatches > 0) {
+                std::cerr << numberOfMismatches << " cases differ from ksi by more than the tolerance\n";
+                return 3;
+            }
+            return 0;
+        }
+        const std::vector<BenchmarkStatistics> results = benchmarkSuite.run(std::cerr);
+
+        const auto outputPath = findArgumentValue(arguments, "-output");
+        std::ofstream outputFile;
+        if (outputPath.has_value()) {
+            outputFile.open(*outputPath);
+            if (!outputFile.is_open()) {
+                std::cout << "Could not create " << *outputPath << "\n";
+                return 1;
+            }
+        }
+        std::ostream& outputStream = outputPath.has_value() ? outputFile : std::cout;
+        if (findArgumentValue(arguments, "-format").value_or("csv") == "json") {
+            BenchmarkSuite::writeJson(outputStream, results);
+        } else {
+            BenchmarkSuite::writeCsv(outputStream, results);
+        }
+
+        const auto baselinePath = findArgumentValue(arguments, "-baseline");
+        if (baselinePath.has_value()) {
+            std::ifstream baselineFile(*baselinePath);
+            if (!baselineFile.is_open()) {
+                std::cout << "Could not open " << *baselinePath << "\n";
+                return 1;
+            }
+            const auto tolerance = findArgumentValue(arguments, "-tolerance");
+            const std::size_t numberOfRegressions = BenchmarkSuite::reportRegressions(
+                    std::cerr, BenchmarkSuite::readCsv(baselineFile), results,
+                    tolerance.has_value() ? std::stod(*tolerance) : 0.1);
+            if (numberOfRegressions > 0) {
+                std::cerr << numberOfRegressions << " stages got slower than the baseline\n";
+                return 2;
+            }
+        }
+    } catch (const std::exception& exception) {
+        std::cout << "Benchmark failed: " << exception.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <system_error>
+
+#include "cache/ResultCache.hpp"
+#include "streams/MappedFile.hpp"
+
+namespace {
+    const std::uint64_t FNV_PRIME = 1099511628211ull;
+    // longest shortest-round-trip representation of a double and a separator
+    const std::size_t MAX_FORMATTED_VALUE_LENGTH = 25;
+
+    void appendValue(std::string& output, double value) {
+        char buffer[MAX_FORMATTED_VALUE_LENGTH];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        output.append(buffer, result.ptr);
+    }
+
+    // reads whitespace separated values, fails on anything that is not a complete number
+    class EntryParser{
+    private:
+        const char* position;
+        const char* const end;
+    public:
+        EntryParser(const char* begin, const char* end) : position(begin), end(end) {}
+
+        template<typename Value>
+        bool read(Value& value) {
+            while (position < end && (*position == ' ' || *position == '\n')) {
+                ++position;
+            }
+            const auto result = std::from_chars(position, end, value);
+            if (result.ec != std::errc() || (result.ptr < end && *result.ptr != ' ' && *result.ptr != '\n')) {
+                return false;
+            }
+            position = result.ptr;
+            return true;
+        }
+
+        template<typename Value>
+        bool readValues(std::vector<Value>& values, std::size_t count) {
+            // every value takes at least two characters, a damaged count must not allocate more than that
+            if (count > (std::size_t) (end - position)) {
+                return false;
+            }
+            values.resize(count);
+            return std::all_of(values.begin(), values.end(), [this](Value& value) { return read(value); });
+        }
+
+        [[nodiscard]]
+        bool atEnd() {
+            while (position < end && (*position == ' ' || *position == '\n')) {
+                ++position;
+            }
+            return position == end;
+        }
+    };
+}
+
+ResultCache::ResultCache(std::filesystem::path directory, std::uintmax_t maximalSizeInBytes)
+: directory(std::move(directory)),
+maximalSizeInBytes(maximalSizeInBytes){
+    std::filesystem::create_directories(this->directory);
+}
+
+std::optional<CachedClusterRun> ResultCache::find(const std::string& key) const {
+    const std::filesystem::path path = entryPath(key);
+    std::ifstream entryFile(path, std::ios::binary);
+    if (!entryFile.is_open()) {
+        return std::nullopt;
+    }
+    const std::string content((std::istreambuf_iterator<char>(entryFile)), std::istreambuf_iterator<char>());
+    std::optional<CachedClusterRun> cachedClusterRun = parseEntry(content, key);
+    if (cachedClusterRun.has_value()) {
+        // a concurrent eviction may have removed the entry meanwhile, the result read is still whole
+        std::error_code ignoredError;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ignoredError);
+    }
+    return cachedClusterRun;
+}
+
+void ResultCache::store(const std::string& key, const CachedClusterRun& cachedClusterRun) const {
+    static std::atomic<unsigned long> temporaryFileCounter(0);
+    static const unsigned long processToken = std::random_device()();
+    const std::filesystem::path path = entryPath(key);
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += "." + std::to_string(processToken) + "." + std::to_string(temporaryFileCounter++)
+                     + TEMPORARY_FILE_EXTENSION;
+    const std::string content = formatEntry(key, cachedClusterRun);
+    {
+        std::ofstream temporaryFile(temporaryPath, std::ios::binary);
+        temporaryFile.write(content.data(), (std::streamsize) content.size());
+        if (!temporaryFile.good()) {
+            std::error_code ignoredError;
+            std::filesystem::remove(temporaryPath, ignoredError);
+            return;
+        }
+    }
+    // rename replaces an entry written concurrently for the same key, both hold the same result
+    std::error_code renameError;
+    std::filesystem::rename(temporaryPath, path, renameError);
+    if (renameError) {
+        std::error_code ignoredError;
+        std::filesystem::remove(temporaryPath, ignoredError);
+    }
+}
+
+std::size_t ResultCache::evictLeastRecentlyUsed() const {
+    struct Entry{
+        std::filesystem::path path;
+        std::filesystem::file_time_type lastUse;
+        std::uintmax_t size;
+    };
+    // temporary files of runs which stopped before renaming them are left behind for this long
+    const auto STALE_TEMPORARY_FILE_AGE = std::chrono::hours(1);
+    const auto now = std::filesystem::file_time_type::clock::now();
+
+    std::vector<Entry> entries;
+    std::uintmax_t totalSize = 0;
+    std::error_code error;
+    for (const auto& directoryEntry : std::filesystem::directory_iterator(directory, error)) {
+        std::error_code entryError;
+        const auto lastUse = directoryEntry.last_write_time(entryError);
+        const auto size = directoryEntry.file_size(entryError);
+        if (entryError || !directoryEntry.is_regular_file(entryError)) {
+            continue;
+        }
+        const std::filesystem::path& path = directoryEntry.path();
+        if (path.extension() == TEMPORARY_FILE_EXTENSION && now - lastUse > STALE_TEMPORARY_FILE_AGE) {
+            std::filesystem::remove(path, entryError);
+        } else if (path.extension() == FILE_EXTENSION) {
+            entries.push_back(Entry{path, lastUse, size});
+            totalSize += size;
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& first, const Entry& second) {
+        return first.lastUse < second.lastUse;
+    });
+    std::size_t numberOfRemovedEntries = 0;
+    for (auto entry = entries.begin(); entry != entries.end() && totalSize > maximalSizeInBytes; ++entry) {
+        std::error_code removalError;
+        // another run may have evicted it already, its size is gone either way
+        if (std::filesystem::remove(entry->path, removalError)) {
+            ++numberOfRemovedEntries;
+        }
+        totalSize -= entry->size;
+    }
+    return numberOfRemovedEntries;
+}
+
+std::uint64_t ResultCache::hashBytes(const char* data, std::size_t size, std::uint64_t seed) {
+    std::uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ (unsigned char) data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+std::uint64_t ResultCache::hashFile(const std::filesystem::path& filePath) {
+    const MappedFile mappedFile(filePath);
+    return hashBytes(mappedFile.getData(), mappedFile.getSize());
+}
+
+std::filesystem::path ResultCache::entryPath(const std::string& key) const {
+    char name[16];
+    const auto result = std::to_chars(name, name + sizeof(name), hashBytes(key.data(), key.size()), 16);
+    return directory / (std::string(name, result.ptr) + FILE_EXTENSION);
+}
+
+std::optional<CachedClusterRun> ResultCache::parseEntry(const std::string& content, const std::string& key) {
+    // first line names the format, the second one is the whole key, so that colliding hashes are told apart
+    const std::size_t firstLineEnd = content.find('\n');
+    if (firstLineEnd == std::string::npos
+        || content.compare(0, firstLineEnd, std::string(MAGIC) + " " + std::to_string(FORMAT_VERSION)) != 0) {
+        return std::nullopt;
+    }
+    const std::size_t keyLineEnd = content.find('\n', firstLineEnd + 1);
+    if (keyLineEnd == std::string::npos || content.compare(firstLineEnd + 1, keyLineEnd - firstLineEnd - 1, key) != 0) {
+        return std::nullopt;
+    }
+    EntryParser parser(content.data() + keyLineEnd + 1, content.data() + content.size());
+    CachedClusterRun cachedClusterRun{};
+    std::size_t numberOfCoefficients = 0;
+    std::size_t numberOfClusters = 0;
+    if (!parser.read(cachedClusterRun.numberOfIterations)
+        || !parser.read(cachedClusterRun.regressionError)
+        || !parser.read(numberOfCoefficients)
+        || !parser.readValues(cachedClusterRun.regressionCoefficients, numberOfCoefficients)
+        || !parser.read(numberOfClusters)
+        || !parser.read(cachedClusterRun.numberOfAttributes)
+        || !parser.readValues(cachedClusterRun.clusterCentres, numberOfClusters * cachedClusterRun.numberOfAttributes)
+        || !parser.atEnd()) {
+        return std::nullopt;
+    }
+    return cachedClusterRun;
+}
+
+std::string ResultCache::formatEntry(const std::string& key, const CachedClusterRun& cachedClusterRun) {
+    const std::size_t numberOfClusters = cachedClusterRun.numberOfAttributes == 0
+            ? 0
+            : cachedClusterRun.clusterCentres.size() / cachedClusterRun.numberOfAttributes;
+    std::string content = std::string(MAGIC) + " " + std::to_string(FORMAT_VERSION) + "\n" + key + "\n";
+    content += std::to_string(cachedClusterRun.numberOfIterations) + "\n";
+    appendValue(content, cachedClusterRun.regressionError);
+    content += "\n" + std::to_string(cachedClusterRun.regressionCoefficients.size());
+    for (double coefficient : cachedClusterRun.regressionCoefficients) {
+        content += ' ';
+        appendValue(content, coefficient);
+    }
+    content += "\n" + std::to_string(numberOfClusters) + " " + std::to_string(cachedClusterRun.numberOfAttributes);
+    for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+        content += '\n';
+        for (std::size_t attribute = 0; attribute < cachedClusterRun.numberOfAttributes; ++attribute) {
+            if (attribute > 0) {
+                content += ' ';
+            }
+            appendValue(content, cachedClusterRun.clusterCentres[cluster * cachedClusterRun.numberOfAttributes + attribute]);
+        }
+    }
+    content += '\n';
+    return content;
+}
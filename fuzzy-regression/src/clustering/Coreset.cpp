@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <array>
+
+#include "clustering/Coreset.hpp"
+#include "clustering/SimdKernels.hpp"
+#include "datageneration/Philox4x32.hpp"
+
+Coreset Coreset::sample(const MatrixView<const double>& attributeMajorData,
+                        std::size_t numberOfDraws,
+                        std::uint64_t seed) {
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    Coreset coreset;
+    coreset.numberOfAttributes = numberOfAttributes;
+    if (numberOfDraws >= numberOfData) {
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            const double* row = attributeMajorData.row(attribute);
+            coreset.attributeMajorPoints.insert(coreset.attributeMajorPoints.end(), row, row + numberOfData);
+        }
+        coreset.weights.assign(numberOfData, 1.0);
+        coreset.numberOfPoints = numberOfData;
+        return coreset;
+    }
+
+    // first pass: mean of the data, second pass: squared distances of the datums to it
+    std::vector<double> squaredDistances(numberOfData, 0.0);
+    for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+        const double* row = attributeMajorData.row(attribute);
+        const double mean = SimdKernels::sum(row, numberOfData) / (double) numberOfData;
+        SimdKernels::accumulateSquaredDifferences(row, mean, squaredDistances.data(), numberOfData);
+    }
+    const double squaredDistanceSum = SimdKernels::sum(squaredDistances.data(), numberOfData);
+    auto drawProbability = [numberOfData, squaredDistanceSum, &squaredDistances](std::size_t datum) {
+        const double uniformPart = 0.5 / (double) numberOfData;
+        return squaredDistanceSum > 0 ? uniformPart + 0.5 * squaredDistances[datum] / squaredDistanceSum
+                                      : 2 * uniformPart;
+    };
+
+    // sorted draws are matched against the cumulative probabilities in one sweep over the datums
+    const Philox4x32 generator(seed);
+    std::vector<double> draws(numberOfDraws);
+    for (std::size_t draw = 0; draw < numberOfDraws; draw += 2) {
+        const std::array<double, 2> uniforms = generator.uniformPair(draw / 2, 0);
+        draws[draw] = uniforms[0];
+        if (draw + 1 < numberOfDraws) {
+            draws[draw + 1] = uniforms[1];
+        }
+    }
+    std::sort(draws.begin(), draws.end());
+    double probabilitySum = 0;
+    for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+        probabilitySum += drawProbability(datum);
+    }
+
+    std::vector<std::size_t> sampledData;
+    std::vector<std::size_t> multiplicities;
+    double cumulativeProbability = 0;
+    std::size_t nextDraw = 0;
+    for (std::size_t datum = 0; datum < numberOfData && nextDraw < numberOfDraws; ++datum) {
+        cumulativeProbability += drawProbability(datum);
+        std::size_t multiplicity = 0;
+        // the last datum takes the draws left over by rounding of the cumulative sum
+        while (nextDraw < numberOfDraws
+               && (draws[nextDraw] * probabilitySum < cumulativeProbability || datum + 1 == numberOfData)) {
+            ++multiplicity;
+            ++nextDraw;
+        }
+        if (multiplicity > 0) {
+            sampledData.push_back(datum);
+            multiplicities.push_back(multiplicity);
+        }
+    }
+
+    coreset.numberOfPoints = sampledData.size();
+    coreset.attributeMajorPoints.resize(numberOfAttributes * coreset.numberOfPoints);
+    coreset.weights.resize(coreset.numberOfPoints);
+    for (std::size_t point = 0; point < coreset.numberOfPoints; ++point) {
+        const double probability = drawProbability(sampledData[point]) / probabilitySum;
+        coreset.weights[point] = (double) multiplicities[point] / ((double) numberOfDraws * probability);
+    }
+    for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+        const double* row = attributeMajorData.row(attribute);
+        double* points = coreset.attributeMajorPoints.data() + attribute * coreset.numberOfPoints;
+        for (std::size_t point = 0; point < coreset.numberOfPoints; ++point) {
+            points[point] = row[sampledData[point]];
+        }
+    }
+    return coreset;
+}
+
+MatrixView<const double> Coreset::getPoints() const {
+    return MatrixView<const double>::rowMajor(attributeMajorPoints.data(), numberOfAttributes, numberOfPoints);
+}
+
+const std::vector<double>& Coreset::getWeights() const {
+    return weights;
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "clustering/FixedDimensionKernels.hpp"
+#include "clustering/SimdIntrinsics.hpp"
+#include "clustering/SimdKernels.hpp"
+
+namespace {
+    template<std::size_t Dimension>
+    struct AttributeRows{
+        const double* rows[Dimension];
+
+        AttributeRows(const MatrixView<const double>& attributeMajorData, std::size_t blockStart) {
+            for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+                rows[attribute] = attributeMajorData.row(attribute) + blockStart;
+            }
+        }
+    };
+
+    template<std::size_t Dimension>
+    inline double squaredDistance(const AttributeRows<Dimension>& attributeRows, const double* centre, std::size_t i) {
+        double distance = 0;
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            double difference = attributeRows.rows[attribute][i] - centre[attribute];
+            distance += difference * difference;
+        }
+        return distance;
+    }
+
+#if defined(__AVX512F__)
+    template<std::size_t Dimension>
+    inline __m512d squaredDistance(const AttributeRows<Dimension>& attributeRows, const __m512d* centre, std::size_t i) {
+        __m512d distance = _mm512_setzero_pd();
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            __m512d difference = _mm512_sub_pd(_mm512_loadu_pd(attributeRows.rows[attribute] + i), centre[attribute]);
+            distance = _mm512_fmadd_pd(difference, difference, distance);
+        }
+        return distance;
+    }
+#elif defined(__AVX2__)
+    template<std::size_t Dimension>
+    inline __m256d squaredDistance(const AttributeRows<Dimension>& attributeRows, const __m256d* centre, std::size_t i) {
+        __m256d distance = _mm256_setzero_pd();
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            __m256d difference = _mm256_sub_pd(_mm256_loadu_pd(attributeRows.rows[attribute] + i), centre[attribute]);
+            distance = SimdIntrinsics::multiplyAdd(difference, difference, distance);
+        }
+        return distance;
+    }
+#endif
+
+    template<std::size_t Dimension>
+    void squaredDistances(const MatrixView<const double>& attributeMajorData,
+                          std::size_t blockStart,
+                          std::size_t blockLength,
+                          const double* centre,
+                          double* distances) {
+        const AttributeRows<Dimension> attributeRows(attributeMajorData, blockStart);
+        std::size_t i = 0;
+#if defined(__AVX512F__)
+        __m512d centreVectors[Dimension];
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            centreVectors[attribute] = _mm512_set1_pd(centre[attribute]);
+        }
+        for (; i + 8 <= blockLength; i += 8) {
+            _mm512_storeu_pd(distances + i, squaredDistance(attributeRows, centreVectors, i));
+        }
+#elif defined(__AVX2__)
+        __m256d centreVectors[Dimension];
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            centreVectors[attribute] = _mm256_set1_pd(centre[attribute]);
+        }
+        for (; i + 4 <= blockLength; i += 4) {
+            _mm256_storeu_pd(distances + i, squaredDistance(attributeRows, centreVectors, i));
+        }
+#endif
+        for (; i < blockLength; ++i) {
+            distances[i] = squaredDistance(attributeRows, centre, i);
+        }
+    }
+
+    template<std::size_t Dimension>
+    void reciprocalSquaredDistances(const MatrixView<const double>& attributeMajorData,
+                                    std::size_t blockStart,
+                                    std::size_t blockLength,
+                                    const double* centre,
+                                    double* reciprocals,
+                                    double* reciprocalSums) {
+        const AttributeRows<Dimension> attributeRows(attributeMajorData, blockStart);
+        std::size_t i = 0;
+#if defined(__AVX512F__)
+        const __m512d minimalDistance = _mm512_set1_pd(SimdKernels::MINIMAL_DISTANCE);
+        const __m512d ones = _mm512_set1_pd(1.0);
+        __m512d centreVectors[Dimension];
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            centreVectors[attribute] = _mm512_set1_pd(centre[attribute]);
+        }
+        for (; i + 8 <= blockLength; i += 8) {
+            __m512d distance = squaredDistance(attributeRows, centreVectors, i);
+            __m512d reciprocal = _mm512_div_pd(ones, _mm512_max_pd(distance, minimalDistance));
+            _mm512_storeu_pd(reciprocals + i, reciprocal);
+            _mm512_storeu_pd(reciprocalSums + i, _mm512_add_pd(_mm512_loadu_pd(reciprocalSums + i), reciprocal));
+        }
+#elif defined(__AVX2__)
+        const __m256d minimalDistance = _mm256_set1_pd(SimdKernels::MINIMAL_DISTANCE);
+        const __m256d ones = _mm256_set1_pd(1.0);
+        __m256d centreVectors[Dimension];
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            centreVectors[attribute] = _mm256_set1_pd(centre[attribute]);
+        }
+        for (; i + 4 <= blockLength; i += 4) {
+            __m256d distance = squaredDistance(attributeRows, centreVectors, i);
+            __m256d reciprocal = _mm256_div_pd(ones, _mm256_max_pd(distance, minimalDistance));
+            _mm256_storeu_pd(reciprocals + i, reciprocal);
+            _mm256_storeu_pd(reciprocalSums + i, _mm256_add_pd(_mm256_loadu_pd(reciprocalSums + i), reciprocal));
+        }
+#endif
+        for (; i < blockLength; ++i) {
+            double reciprocal = 1.0 / std::max(squaredDistance(attributeRows, centre, i), SimdKernels::MINIMAL_DISTANCE);
+            reciprocals[i] = reciprocal;
+            reciprocalSums[i] += reciprocal;
+        }
+    }
+
+    template<std::size_t Dimension>
+    void accumulateWeightedSums(const MatrixView<const double>& attributeMajorData,
+                                std::size_t blockStart,
+                                std::size_t blockLength,
+                                const double* weights,
+                                double* weightedSums) {
+        const AttributeRows<Dimension> attributeRows(attributeMajorData, blockStart);
+        double blockSums[Dimension] = {};
+        std::size_t i = 0;
+#if defined(__AVX512F__)
+        __m512d sumVectors[Dimension];
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            sumVectors[attribute] = _mm512_setzero_pd();
+        }
+        for (; i + 8 <= blockLength; i += 8) {
+            const __m512d weight = _mm512_loadu_pd(weights + i);
+            for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+                sumVectors[attribute] = _mm512_fmadd_pd(weight, _mm512_loadu_pd(attributeRows.rows[attribute] + i),
+                                                        sumVectors[attribute]);
+            }
+        }
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            blockSums[attribute] = _mm512_reduce_add_pd(sumVectors[attribute]);
+        }
+#elif defined(__AVX2__)
+        __m256d sumVectors[Dimension];
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            sumVectors[attribute] = _mm256_setzero_pd();
+        }
+        for (; i + 4 <= blockLength; i += 4) {
+            const __m256d weight = _mm256_loadu_pd(weights + i);
+            for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+                sumVectors[attribute] = SimdIntrinsics::multiplyAdd(weight,
+                                                                    _mm256_loadu_pd(attributeRows.rows[attribute] + i),
+                                                                    sumVectors[attribute]);
+            }
+        }
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            blockSums[attribute] = SimdIntrinsics::horizontalSum(sumVectors[attribute]);
+        }
+#endif
+        for (std::size_t attribute = 0; attribute < Dimension; ++attribute) {
+            for (std::size_t tail = i; tail < blockLength; ++tail) {
+                blockSums[attribute] += weights[tail] * attributeRows.rows[attribute][tail];
+            }
+            weightedSums[attribute] += blockSums[attribute];
+        }
+    }
+
+    template<std::size_t... Dimensions>
+    constexpr std::array<FixedDimensionKernels::Table, sizeof...(Dimensions)>
+    createTables(std::index_sequence<Dimensions...>) {
+        return {FixedDimensionKernels::Table{&squaredDistances<Dimensions + 1>,
+                                             &reciprocalSquaredDistances<Dimensions + 1>,
+                                             &accumulateWeightedSums<Dimensions + 1>}...};
+    }
+
+    // tables[d - 1] holds the kernels for dimension d
+    constexpr auto tables = createTables(std::make_index_sequence<FixedDimensionKernels::MAX_SPECIALISED_DIMENSION>());
+}
+
+const FixedDimensionKernels::Table* FixedDimensionKernels::forDimension(std::size_t dimension) {
+    if (dimension == 0 || dimension > MAX_SPECIALISED_DIMENSION) {
+        return nullptr;
+    }
+    return &tables[dimension - 1];
+}
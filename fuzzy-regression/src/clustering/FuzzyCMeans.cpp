@@ -0,0 +1,538 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "clustering/FixedDimensionKernels.hpp"
+#include "clustering/FuzzyCMeans.hpp"
+#include "clustering/SimdKernels.hpp"
+#include "telemetry/Telemetry.hpp"
+
+bool SparseMembershipMatrix::empty() const {
+    return datumOffsets.empty();
+}
+
+void SparseMembershipMatrix::countHighestMemberships(std::size_t numberOfClusters,
+                                                     std::vector<std::size_t>& datumCountsPerCluster) const {
+    datumCountsPerCluster.resize(numberOfClusters, 0);
+    for (std::size_t datum = 0; datum + 1 < datumOffsets.size(); ++datum) {
+        const auto first = memberships.begin() + (std::ptrdiff_t) datumOffsets[datum];
+        const auto last = memberships.begin() + (std::ptrdiff_t) datumOffsets[datum + 1];
+        if (first != last) {
+            datumCountsPerCluster[clusterIndices[std::max_element(first, last) - memberships.begin()]]++;
+        }
+    }
+}
+
+FuzzyPartition FuzzyPartition::fromKsiPartition(const ksi::partition& partition) {
+    const std::vector<std::vector<double>> centres = partition.getClusterCentres();
+    const std::vector<std::vector<double>> matrix = partition.getPartitionMatrix();
+    const std::size_t numberOfClusters = centres.size();
+    const std::size_t numberOfAttributes = numberOfClusters > 0 ? centres[0].size() : 0;
+    const std::size_t numberOfData = numberOfClusters > 0 ? matrix[0].size() : 0;
+    FuzzyPartition result{numberOfClusters, numberOfAttributes, numberOfData, {}, {}, 0, {}, {}};
+    result.clusterCentres.reserve(numberOfClusters * numberOfAttributes);
+    result.partitionMatrix.reserve(numberOfClusters * numberOfData);
+    for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+        result.clusterCentres.insert(result.clusterCentres.end(), centres[cluster].begin(), centres[cluster].end());
+        result.partitionMatrix.insert(result.partitionMatrix.end(), matrix[cluster].begin(), matrix[cluster].end());
+    }
+    return result;
+}
+
+MatrixView<const double> FuzzyPartition::getClusterCentres() const {
+    return MatrixView<const double>::rowMajor(clusterCentres.data(), numberOfClusters, numberOfAttributes);
+}
+
+MatrixView<const double> FuzzyPartition::getPartitionMatrix() const {
+    return MatrixView<const double>::rowMajor(partitionMatrix.data(), numberOfClusters, numberOfData);
+}
+
+FuzzyCMeans::FuzzyCMeans() noexcept
+: numberOfClusters(2),
+epsilon(EPSILON_DEFAULT_VALUE),
+fuzzification(FUZZIFICATION_DEFAULT_VALUE),
+maximalNumberOfIterations(MAXIMAL_NUMBER_OF_ITERATIONS_DEFAULT_VALUE),
+seed(SEED_DEFAULT_VALUE){}
+
+void FuzzyCMeans::setNumberOfClusters(int numberOfClusters) {
+    this->numberOfClusters = numberOfClusters;
+}
+
+void FuzzyCMeans::setEpsilonForFrobeniusNorm(double epsilon) {
+    this->epsilon = epsilon;
+}
+
+void FuzzyCMeans::setFuzzification(double fuzzification) {
+    this->fuzzification = fuzzification;
+}
+
+void FuzzyCMeans::setMaximalNumberOfIterations(int maximalNumberOfIterations) {
+    this->maximalNumberOfIterations = maximalNumberOfIterations;
+}
+
+void FuzzyCMeans::setSeed(unsigned int seed) {
+    this->seed = seed;
+}
+
+FuzzyPartition FuzzyCMeans::doPartition(const ksi::dataset& dataset) const {
+    const std::vector<double> attributeMajorData = flattenDatasetByAttributes(dataset);
+    return doPartition(MatrixView<const double>::rowMajor(attributeMajorData.data(),
+                                                          dataset.getNumberOfAttributes(),
+                                                          dataset.getNumberOfData()));
+}
+
+FuzzyPartition FuzzyCMeans::doPartition(const MatrixView<const double>& attributeMajorData) const {
+    if (!attributeMajorData.hasContiguousRows()) {
+        const std::vector<double> contiguousData = copyToContiguousRows(attributeMajorData);
+        return doPartition(MatrixView<const double>::rowMajor(contiguousData.data(),
+                                                              attributeMajorData.getNumberOfRows(),
+                                                              attributeMajorData.getNumberOfColumns()));
+    }
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    validateParameters(numberOfData);
+    const auto clusterCount = (std::size_t) numberOfClusters;
+    FuzzyPartition partition{clusterCount,
+                             numberOfAttributes,
+                             numberOfData,
+                             std::vector<double>(clusterCount * numberOfAttributes),
+                             std::vector<double>(clusterCount * numberOfData),
+                             0,
+                             {},
+                             {}};
+    initialisePartitionMatrix(partition);
+    iterateUntilConvergence(attributeMajorData, partition);
+    return partition;
+}
+
+FuzzyPartition FuzzyCMeans::doPartition(const MatrixView<const double>& attributeMajorData,
+                                        const std::vector<double>& initialClusterCentres) const {
+    if (!attributeMajorData.hasContiguousRows()) {
+        const std::vector<double> contiguousData = copyToContiguousRows(attributeMajorData);
+        return doPartition(MatrixView<const double>::rowMajor(contiguousData.data(),
+                                                              attributeMajorData.getNumberOfRows(),
+                                                              attributeMajorData.getNumberOfColumns()),
+                           initialClusterCentres);
+    }
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    validateParameters(numberOfData);
+    const auto clusterCount = (std::size_t) numberOfClusters;
+    if (initialClusterCentres.size() != clusterCount * numberOfAttributes) {
+        throw std::invalid_argument("Initial cluster centres do not match number of clusters and attributes");
+    }
+    FuzzyPartition partition{clusterCount,
+                             numberOfAttributes,
+                             numberOfData,
+                             initialClusterCentres,
+                             std::vector<double>(clusterCount * numberOfData),
+                             0,
+                             {},
+                             {}};
+    std::vector<double> scratch(clusterCount * numberOfData);
+    std::vector<double> reciprocalSums(numberOfData);
+    (void) updatePartitionMatrix(attributeMajorData, partition, scratch, reciprocalSums);
+    iterateUntilConvergence(attributeMajorData, partition);
+    return partition;
+}
+
+FuzzyPartition FuzzyCMeans::doWeightedPartition(const MatrixView<const double>& attributeMajorData,
+                                                const std::vector<double>& datumWeights) const {
+    if (!attributeMajorData.hasContiguousRows()) {
+        const std::vector<double> contiguousData = copyToContiguousRows(attributeMajorData);
+        return doWeightedPartition(MatrixView<const double>::rowMajor(contiguousData.data(),
+                                                                      attributeMajorData.getNumberOfRows(),
+                                                                      attributeMajorData.getNumberOfColumns()),
+                                   datumWeights);
+    }
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    validateParameters(numberOfData);
+    if (datumWeights.size() != numberOfData) {
+        throw std::invalid_argument("Number of datum weights has to be equal to number of data");
+    }
+    const auto clusterCount = (std::size_t) numberOfClusters;
+    FuzzyPartition partition{clusterCount,
+                             numberOfAttributes,
+                             numberOfData,
+                             std::vector<double>(clusterCount * numberOfAttributes),
+                             std::vector<double>(clusterCount * numberOfData),
+                             0,
+                             {},
+                             {}};
+    initialisePartitionMatrix(partition);
+    iterateUntilConvergence(attributeMajorData, partition, datumWeights);
+    return partition;
+}
+
+double FuzzyCMeans::calculateObjective(const MatrixView<const double>& attributeMajorData,
+                                       const std::vector<double>& clusterCentres,
+                                       const std::vector<double>& datumWeights) const {
+    if (!attributeMajorData.hasContiguousRows()) {
+        const std::vector<double> contiguousData = copyToContiguousRows(attributeMajorData);
+        return calculateObjective(MatrixView<const double>::rowMajor(contiguousData.data(),
+                                                                     attributeMajorData.getNumberOfRows(),
+                                                                     attributeMajorData.getNumberOfColumns()),
+                                  clusterCentres, datumWeights);
+    }
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    const std::size_t numberOfClusters = numberOfAttributes == 0 ? 0 : clusterCentres.size() / numberOfAttributes;
+    const FixedDimensionKernels::Table* kernels = FixedDimensionKernels::forDimension(numberOfAttributes);
+    const double distanceExponent = -1.0 / (fuzzification - 1.0);
+
+    std::vector<double> distances(DATUM_BLOCK_SIZE);
+    std::vector<double> reciprocalSums(DATUM_BLOCK_SIZE);
+    double objective = 0;
+    for (std::size_t blockStart = 0; blockStart < numberOfData; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        std::fill(reciprocalSums.begin(), reciprocalSums.begin() + blockLength, 0.0);
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            const double* centre = clusterCentres.data() + cluster * numberOfAttributes;
+            if (kernels != nullptr) {
+                kernels->squaredDistances(attributeMajorData, blockStart, blockLength, centre, distances.data());
+            } else {
+                std::fill(distances.begin(), distances.begin() + blockLength, 0.0);
+                for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                    SimdKernels::accumulateSquaredDifferences(attributeMajorData.row(attribute) + blockStart,
+                                                              centre[attribute], distances.data(), blockLength);
+                }
+            }
+            if (fuzzification == 2.0) {
+                SimdKernels::invertAndAccumulate(distances.data(), reciprocalSums.data(), blockLength);
+            } else {
+                for (std::size_t i = 0; i < blockLength; ++i) {
+                    reciprocalSums[i] += std::pow(std::max(distances[i], SimdKernels::MINIMAL_DISTANCE),
+                                                  distanceExponent);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < blockLength; ++i) {
+            const double datumObjective = fuzzification == 2.0
+                    ? 1.0 / reciprocalSums[i]
+                    : std::pow(reciprocalSums[i], 1.0 - fuzzification);
+            objective += datumWeights.empty() ? datumObjective : datumWeights[blockStart + i] * datumObjective;
+        }
+    }
+    return objective;
+}
+
+std::vector<double> FuzzyCMeans::splitWorstFittingCluster(const MatrixView<const double>& attributeMajorData,
+                                                          const FuzzyPartition& partition) const {
+    const std::size_t numberOfData = partition.numberOfData;
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    const std::size_t numberOfClusters = partition.numberOfClusters;
+
+    std::vector<double> weights(numberOfData);
+    std::vector<double> squaredDistances(numberOfData);
+    std::size_t worstCluster = 0;
+    double worstClusterError = -1;
+    for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+        const double* memberships = partition.partitionMatrix.data() + cluster * numberOfData;
+        std::transform(memberships, memberships + numberOfData, weights.begin(),
+                       [this](double membership) { return std::pow(membership, fuzzification); });
+        std::fill(squaredDistances.begin(), squaredDistances.end(), 0.0);
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            SimdKernels::accumulateSquaredDifferences(attributeMajorData.row(attribute),
+                                                      partition.clusterCentres[cluster * numberOfAttributes + attribute],
+                                                      squaredDistances.data(), numberOfData);
+        }
+        double clusterError = SimdKernels::dotProduct(weights.data(), squaredDistances.data(), numberOfData);
+        if (clusterError > worstClusterError) {
+            worstClusterError = clusterError;
+            worstCluster = cluster;
+        }
+    }
+
+    const double* worstClusterMemberships = partition.partitionMatrix.data() + worstCluster * numberOfData;
+    std::transform(worstClusterMemberships, worstClusterMemberships + numberOfData, weights.begin(),
+                   [this](double membership) { return std::pow(membership, fuzzification); });
+    const double weightSum = SimdKernels::sum(weights.data(), numberOfData);
+
+    std::vector<double> splitCentres(partition.clusterCentres);
+    splitCentres.resize((numberOfClusters + 1) * numberOfAttributes);
+    for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+        const std::size_t centreIndex = worstCluster * numberOfAttributes + attribute;
+        const double centreValue = partition.clusterCentres[centreIndex];
+        std::fill(squaredDistances.begin(), squaredDistances.end(), 0.0);
+        SimdKernels::accumulateSquaredDifferences(attributeMajorData.row(attribute),
+                                                  centreValue, squaredDistances.data(), numberOfData);
+        double variance = weightSum > 0
+                ? SimdKernels::dotProduct(weights.data(), squaredDistances.data(), numberOfData) / weightSum
+                : 0.0;
+        double halfSpread = 0.5 * std::sqrt(variance);
+        splitCentres[centreIndex] = centreValue - halfSpread;
+        splitCentres[numberOfClusters * numberOfAttributes + attribute] = centreValue + halfSpread;
+    }
+    return splitCentres;
+}
+
+void FuzzyCMeans::countNearestDatums(const MatrixView<const double>& attributeMajorData,
+                                     const std::vector<double>& clusterCentres,
+                                     std::vector<std::size_t>& datumCountsPerCluster) {
+    if (!attributeMajorData.hasContiguousRows()) {
+        const std::vector<double> contiguousData = copyToContiguousRows(attributeMajorData);
+        countNearestDatums(MatrixView<const double>::rowMajor(contiguousData.data(),
+                                                              attributeMajorData.getNumberOfRows(),
+                                                              attributeMajorData.getNumberOfColumns()),
+                           clusterCentres, datumCountsPerCluster);
+        return;
+    }
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    const std::size_t numberOfClusters = numberOfAttributes == 0 ? 0 : clusterCentres.size() / numberOfAttributes;
+    datumCountsPerCluster.resize(numberOfClusters, 0);
+    const FixedDimensionKernels::Table* kernels = FixedDimensionKernels::forDimension(numberOfAttributes);
+
+    std::vector<double> distances(DATUM_BLOCK_SIZE);
+    std::vector<double> nearestDistances(DATUM_BLOCK_SIZE);
+    std::vector<std::size_t> nearestClusters(DATUM_BLOCK_SIZE);
+    for (std::size_t blockStart = 0; blockStart < numberOfData; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            const double* centre = clusterCentres.data() + cluster * numberOfAttributes;
+            if (kernels != nullptr) {
+                kernels->squaredDistances(attributeMajorData, blockStart, blockLength, centre, distances.data());
+            } else {
+                std::fill(distances.begin(), distances.begin() + blockLength, 0.0);
+                for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                    SimdKernels::accumulateSquaredDifferences(attributeMajorData.row(attribute) + blockStart,
+                                                              centre[attribute], distances.data(), blockLength);
+                }
+            }
+            for (std::size_t i = 0; i < blockLength; ++i) {
+                if (cluster == 0 || distances[i] < nearestDistances[i]) {
+                    nearestDistances[i] = distances[i];
+                    nearestClusters[i] = cluster;
+                }
+            }
+        }
+        for (std::size_t i = 0; i < blockLength && numberOfClusters > 0; ++i) {
+            datumCountsPerCluster[nearestClusters[i]]++;
+        }
+    }
+}
+
+void FuzzyCMeans::countHighestMemberships(const MatrixView<const double>& partitionMatrix,
+                                          std::vector<std::size_t>& datumCountsPerCluster) {
+    if (!partitionMatrix.hasContiguousRows()) {
+        const std::vector<double> contiguousMatrix = copyToContiguousRows(partitionMatrix);
+        countHighestMemberships(MatrixView<const double>::rowMajor(contiguousMatrix.data(),
+                                                                   partitionMatrix.getNumberOfRows(),
+                                                                   partitionMatrix.getNumberOfColumns()),
+                                datumCountsPerCluster);
+        return;
+    }
+    const std::size_t numberOfClusters = partitionMatrix.getNumberOfRows();
+    const std::size_t numberOfData = partitionMatrix.getNumberOfColumns();
+    datumCountsPerCluster.resize(numberOfClusters, 0);
+    // one block of running maxima stays in cache while all cluster rows stream past it
+    double highestMemberships[DATUM_BLOCK_SIZE];
+    double highestClusters[DATUM_BLOCK_SIZE];
+    for (std::size_t blockStart = 0; blockStart < numberOfData && numberOfClusters > 0; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        std::copy(partitionMatrix.row(0) + blockStart, partitionMatrix.row(0) + blockStart + blockLength,
+                  highestMemberships);
+        std::fill(highestClusters, highestClusters + blockLength, 0.0);
+        for (std::size_t cluster = 1; cluster < numberOfClusters; ++cluster) {
+            SimdKernels::updateHighestMemberships(partitionMatrix.row(cluster) + blockStart, (double) cluster,
+                                                  highestMemberships, highestClusters, blockLength);
+        }
+        for (std::size_t i = 0; i < blockLength; ++i) {
+            datumCountsPerCluster[(std::size_t) highestClusters[i]]++;
+        }
+    }
+}
+
+std::vector<double> FuzzyCMeans::flattenDatasetByAttributes(const ksi::dataset& dataset) {
+    const std::size_t numberOfData = dataset.getNumberOfData();
+    const std::size_t numberOfAttributes = dataset.getNumberOfAttributes();
+    const std::vector<std::vector<double>> rows = dataset.getMatrix();
+    std::vector<double> attributeMajorData(numberOfData * numberOfAttributes);
+    for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+        const auto& row = rows[datum];
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            attributeMajorData[attribute * numberOfData + datum] = row[attribute];
+        }
+    }
+    return attributeMajorData;
+}
+
+std::vector<double> FuzzyCMeans::copyToContiguousRows(const MatrixView<const double>& matrix) {
+    std::vector<double> contiguousData(matrix.getNumberOfRows() * matrix.getNumberOfColumns());
+    for (std::size_t row = 0; row < matrix.getNumberOfRows(); ++row) {
+        for (std::size_t column = 0; column < matrix.getNumberOfColumns(); ++column) {
+            contiguousData[row * matrix.getNumberOfColumns() + column] = matrix(row, column);
+        }
+    }
+    return contiguousData;
+}
+
+void FuzzyCMeans::validateParameters(std::size_t numberOfData) const {
+    if (numberOfClusters < 1 || numberOfData < (std::size_t) numberOfClusters) {
+        throw std::invalid_argument("Number of clusters has to be positive and not greater than number of data");
+    }
+    if (fuzzification <= 1.0) {
+        throw std::invalid_argument("Fuzzification exponent has to be greater than 1");
+    }
+}
+
+void FuzzyCMeans::initialisePartitionMatrix(FuzzyPartition& partition) const {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> membershipDistribution(0.0, 1.0);
+    const std::size_t numberOfData = partition.numberOfData;
+    std::vector<double>& memberships = partition.partitionMatrix;
+    for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+        double membershipSum = 0;
+        for (std::size_t cluster = 0; cluster < partition.numberOfClusters; ++cluster) {
+            double membership = membershipDistribution(generator);
+            memberships[cluster * numberOfData + datum] = membership;
+            membershipSum += membership;
+        }
+        for (std::size_t cluster = 0; cluster < partition.numberOfClusters; ++cluster) {
+            memberships[cluster * numberOfData + datum] /= membershipSum;
+        }
+    }
+}
+
+void FuzzyCMeans::iterateUntilConvergence(const MatrixView<const double>& attributeMajorData,
+                                          FuzzyPartition& partition,
+                                          const std::vector<double>& datumWeights) const {
+    std::vector<double> scratch(partition.numberOfClusters * partition.numberOfData);
+    std::vector<double> reciprocalSums(partition.numberOfData);
+    const double squaredEpsilon = epsilon * epsilon;
+    while (partition.numberOfIterations < maximalNumberOfIterations) {
+        FUZZY_REGRESSION_TELEMETRY_SCOPE("fcm.iteration");
+        updateClusterCentres(attributeMajorData, partition, scratch, datumWeights);
+        double squaredFrobeniusNorm = updatePartitionMatrix(attributeMajorData, partition, scratch, reciprocalSums);
+        partition.numberOfIterations++;
+        FUZZY_REGRESSION_TELEMETRY_COUNTER("fcm.membershipChange", std::sqrt(squaredFrobeniusNorm));
+        if (FUZZY_REGRESSION_TELEMETRY_ACTIVE()) {
+            // objective of the centres the memberships were just computed from, as in calculateObjective
+            double objective = 0;
+            for (std::size_t datum = 0; datum < partition.numberOfData; ++datum) {
+                const double datumObjective = fuzzification == 2.0
+                        ? 1.0 / reciprocalSums[datum]
+                        : std::pow(reciprocalSums[datum], 1.0 - fuzzification);
+                objective += datumWeights.empty() ? datumObjective : datumWeights[datum] * datumObjective;
+            }
+            FUZZY_REGRESSION_TELEMETRY_COUNTER("fcm.objective", objective);
+        }
+        if (squaredFrobeniusNorm < squaredEpsilon) {
+            break;
+        }
+    }
+    updateClusterCentres(attributeMajorData, partition, scratch, datumWeights);
+}
+
+void FuzzyCMeans::updateClusterCentres(const MatrixView<const double>& attributeMajorData,
+                                       FuzzyPartition& partition,
+                                       std::vector<double>& scratch,
+                                       const std::vector<double>& datumWeights) const {
+    const std::size_t numberOfData = partition.numberOfData;
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    const std::size_t numberOfClusters = partition.numberOfClusters;
+    const double* memberships = partition.partitionMatrix.data();
+    double* weights = scratch.data();
+
+    if (fuzzification == 2.0) {
+        SimdKernels::square(memberships, weights, numberOfClusters * numberOfData);
+    } else {
+        std::transform(memberships, memberships + numberOfClusters * numberOfData, weights,
+                       [this](double membership) { return std::pow(membership, fuzzification); });
+    }
+    if (!datumWeights.empty()) {
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            double* clusterWeights = weights + cluster * numberOfData;
+            for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+                clusterWeights[datum] *= datumWeights[datum];
+            }
+        }
+    }
+
+    std::vector<double> weightedSums(numberOfClusters * numberOfAttributes, 0.0);
+    const FixedDimensionKernels::Table* kernels = FixedDimensionKernels::forDimension(numberOfAttributes);
+    for (std::size_t blockStart = 0; blockStart < numberOfData; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            const double* clusterWeights = weights + cluster * numberOfData + blockStart;
+            if (kernels != nullptr) {
+                kernels->accumulateWeightedSums(attributeMajorData, blockStart, blockLength, clusterWeights,
+                                                weightedSums.data() + cluster * numberOfAttributes);
+                continue;
+            }
+            for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                const double* attributeValues = attributeMajorData.row(attribute) + blockStart;
+                weightedSums[cluster * numberOfAttributes + attribute] +=
+                        SimdKernels::dotProduct(clusterWeights, attributeValues, blockLength);
+            }
+        }
+    }
+
+    for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+        double weightSum = SimdKernels::sum(weights + cluster * numberOfData, numberOfData);
+        if (weightSum <= 0) {
+            continue;
+        }
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            partition.clusterCentres[cluster * numberOfAttributes + attribute] =
+                    weightedSums[cluster * numberOfAttributes + attribute] / weightSum;
+        }
+    }
+}
+
+double FuzzyCMeans::updatePartitionMatrix(const MatrixView<const double>& attributeMajorData,
+                                          FuzzyPartition& partition,
+                                          std::vector<double>& scratch,
+                                          std::vector<double>& reciprocalSums) const {
+    const std::size_t numberOfData = partition.numberOfData;
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    const std::size_t numberOfClusters = partition.numberOfClusters;
+    const double distanceExponent = -1.0 / (fuzzification - 1.0);
+    double* distances = scratch.data();
+    double* memberships = partition.partitionMatrix.data();
+
+    const FixedDimensionKernels::Table* kernels = FixedDimensionKernels::forDimension(numberOfAttributes);
+    std::fill(reciprocalSums.begin(), reciprocalSums.end(), 0.0);
+    double squaredChange = 0;
+    for (std::size_t blockStart = 0; blockStart < numberOfData; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        double* blockReciprocalSums = reciprocalSums.data() + blockStart;
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            double* clusterDistances = distances + cluster * numberOfData + blockStart;
+            const double* centre = partition.clusterCentres.data() + cluster * numberOfAttributes;
+            if (kernels != nullptr && fuzzification == 2.0) {
+                kernels->reciprocalSquaredDistances(attributeMajorData, blockStart, blockLength, centre,
+                                                    clusterDistances, blockReciprocalSums);
+                continue;
+            }
+            if (kernels != nullptr) {
+                kernels->squaredDistances(attributeMajorData, blockStart, blockLength, centre, clusterDistances);
+            } else {
+                std::fill(clusterDistances, clusterDistances + blockLength, 0.0);
+                for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                    SimdKernels::accumulateSquaredDifferences(attributeMajorData.row(attribute) + blockStart,
+                                                              centre[attribute], clusterDistances, blockLength);
+                }
+            }
+            if (fuzzification == 2.0) {
+                SimdKernels::invertAndAccumulate(clusterDistances, blockReciprocalSums, blockLength);
+            } else {
+                for (std::size_t i = 0; i < blockLength; ++i) {
+                    double reciprocal = std::pow(std::max(clusterDistances[i], SimdKernels::MINIMAL_DISTANCE),
+                                                 distanceExponent);
+                    clusterDistances[i] = reciprocal;
+                    blockReciprocalSums[i] += reciprocal;
+                }
+            }
+        }
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            squaredChange += SimdKernels::normaliseMemberships(distances + cluster * numberOfData + blockStart,
+                                                               blockReciprocalSums,
+                                                               memberships + cluster * numberOfData + blockStart,
+                                                               blockLength);
+        }
+    }
+    return squaredChange;
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "clustering/MiniBatchFuzzyCMeans.hpp"
+#include "clustering/SimdKernels.hpp"
+#include "telemetry/Telemetry.hpp"
+
+MiniBatchFuzzyCMeans::MiniBatchFuzzyCMeans() noexcept
+: numberOfClusters(2),
+epsilon(EPSILON_DEFAULT_VALUE),
+numberOfEpochs(NUMBER_OF_EPOCHS_DEFAULT_VALUE),
+maximalNumberOfIterationsPerBatch(MAXIMAL_NUMBER_OF_ITERATIONS_PER_BATCH_DEFAULT_VALUE){}
+
+void MiniBatchFuzzyCMeans::setNumberOfClusters(int numberOfClusters) {
+    this->numberOfClusters = numberOfClusters;
+}
+
+void MiniBatchFuzzyCMeans::setEpsilonForFrobeniusNorm(double epsilon) {
+    this->epsilon = epsilon;
+}
+
+void MiniBatchFuzzyCMeans::setNumberOfEpochs(int numberOfEpochs) {
+    this->numberOfEpochs = numberOfEpochs;
+}
+
+void MiniBatchFuzzyCMeans::setMaximalNumberOfIterationsPerBatch(int maximalNumberOfIterationsPerBatch) {
+    this->maximalNumberOfIterationsPerBatch = maximalNumberOfIterationsPerBatch;
+}
+
+FuzzyPartition MiniBatchFuzzyCMeans::doPartition(BatchSource& batchSource) const {
+    if (numberOfClusters < 1 || batchSource.getNumberOfData() < (std::size_t) numberOfClusters) {
+        throw std::invalid_argument("Number of clusters has to be positive and not greater than number of data");
+    }
+    const auto clusterCount = (std::size_t) numberOfClusters;
+    const std::size_t numberOfAttributes = batchSource.getNumberOfAttributes();
+    const FuzzyCMeans batchAlgorithm = createBatchAlgorithm();
+
+    std::vector<double> clusterCentres;
+    std::vector<double> accumulatedWeights(clusterCount);
+    int numberOfIterations = 0;
+    for (int epoch = 0; epoch < numberOfEpochs || clusterCentres.empty(); ++epoch) {
+        // every epoch averages over the whole dataset again, starting from the centres of the previous one
+        FUZZY_REGRESSION_TELEMETRY_SCOPE("miniBatchFcm.epoch");
+        std::fill(accumulatedWeights.begin(), accumulatedWeights.end(), 0.0);
+        batchSource.rewind();
+        for (auto batch = batchSource.nextBatch(); batch.getNumberOfColumns() > 0; batch = batchSource.nextBatch()) {
+            // a trailing batch with fewer datums than clusters cannot be clustered, it is still counted below
+            if (batch.getNumberOfColumns() < clusterCount) {
+                continue;
+            }
+            const FuzzyPartition batchPartition = clusterCentres.empty()
+                    ? batchAlgorithm.doPartition(batch)
+                    : batchAlgorithm.doPartition(batch, clusterCentres);
+            numberOfIterations += batchPartition.numberOfIterations;
+            if (clusterCentres.empty()) {
+                clusterCentres.assign(clusterCount * numberOfAttributes, 0.0);
+            }
+            mergeBatchCentres(batchPartition, clusterCentres, accumulatedWeights);
+        }
+        if (clusterCentres.empty()) {
+            throw std::invalid_argument("Batch size has to be at least the number of clusters");
+        }
+    }
+
+    std::vector<std::size_t> datumCountsPerCluster(clusterCount, 0);
+    std::size_t numberOfData = 0;
+    batchSource.rewind();
+    for (auto batch = batchSource.nextBatch(); batch.getNumberOfColumns() > 0; batch = batchSource.nextBatch()) {
+        FuzzyCMeans::countNearestDatums(batch, clusterCentres, datumCountsPerCluster);
+        numberOfData += batch.getNumberOfColumns();
+    }
+    return FuzzyPartition{clusterCount,
+                          numberOfAttributes,
+                          numberOfData,
+                          std::move(clusterCentres),
+                          {},
+                          numberOfIterations,
+                          std::move(datumCountsPerCluster),
+                          {}};
+}
+
+FuzzyCMeans MiniBatchFuzzyCMeans::createBatchAlgorithm() const {
+    FuzzyCMeans batchAlgorithm;
+    batchAlgorithm.setNumberOfClusters(numberOfClusters);
+    batchAlgorithm.setEpsilonForFrobeniusNorm(epsilon);
+    batchAlgorithm.setMaximalNumberOfIterations(maximalNumberOfIterationsPerBatch);
+    return batchAlgorithm;
+}
+
+void MiniBatchFuzzyCMeans::mergeBatchCentres(const FuzzyPartition& batchPartition,
+                                             std::vector<double>& clusterCentres,
+                                             std::vector<double>& accumulatedWeights) {
+    const std::size_t numberOfAttributes = batchPartition.numberOfAttributes;
+    const std::size_t numberOfData = batchPartition.numberOfData;
+    for (std::size_t cluster = 0; cluster < batchPartition.numberOfClusters; ++cluster) {
+        // batch clustering uses the default fuzzification 2, so the weight of a datum is its squared membership
+        const double* memberships = batchPartition.partitionMatrix.data() + cluster * numberOfData;
+        const double batchWeight = SimdKernels::dotProduct(memberships, memberships, numberOfData);
+        const double mergedWeight = accumulatedWeights[cluster] + batchWeight;
+        if (mergedWeight <= 0) {
+            continue;
+        }
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            double& centreValue = clusterCentres[cluster * numberOfAttributes + attribute];
+            const double batchCentreValue = batchPartition.clusterCentres[cluster * numberOfAttributes + attribute];
+            centreValue = (accumulatedWeights[cluster] * centreValue + batchWeight * batchCentreValue) / mergedWeight;
+        }
+        accumulatedWeights[cluster] = mergedWeight;
+    }
+}
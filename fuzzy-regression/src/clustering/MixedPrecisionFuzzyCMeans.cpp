@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "clustering/MixedPrecisionFuzzyCMeans.hpp"
+#include "clustering/SimdKernels.hpp"
+#include "telemetry/Telemetry.hpp"
+
+MixedPrecisionFuzzyCMeans::MixedPrecisionFuzzyCMeans() noexcept
+: numberOfClusters(2),
+epsilon(EPSILON_DEFAULT_VALUE),
+fuzzification(FUZZIFICATION_DEFAULT_VALUE),
+maximalNumberOfIterations(MAXIMAL_NUMBER_OF_ITERATIONS_DEFAULT_VALUE),
+seed(SEED_DEFAULT_VALUE),
+maximalNumberOfPolishIterations(MAXIMAL_NUMBER_OF_POLISH_ITERATIONS_DEFAULT_VALUE){}
+
+void MixedPrecisionFuzzyCMeans::setNumberOfClusters(int numberOfClusters) {
+    this->numberOfClusters = numberOfClusters;
+}
+
+void MixedPrecisionFuzzyCMeans::setEpsilonForFrobeniusNorm(double epsilon) {
+    this->epsilon = epsilon;
+}
+
+void MixedPrecisionFuzzyCMeans::setFuzzification(double fuzzification) {
+    this->fuzzification = fuzzification;
+}
+
+void MixedPrecisionFuzzyCMeans::setMaximalNumberOfIterations(int maximalNumberOfIterations) {
+    this->maximalNumberOfIterations = maximalNumberOfIterations;
+}
+
+void MixedPrecisionFuzzyCMeans::setSeed(unsigned int seed) {
+    this->seed = seed;
+}
+
+void MixedPrecisionFuzzyCMeans::setMaximalNumberOfPolishIterations(int maximalNumberOfPolishIterations) {
+    this->maximalNumberOfPolishIterations = maximalNumberOfPolishIterations;
+}
+
+FuzzyPartition MixedPrecisionFuzzyCMeans::doPartition(const MatrixView<const double>& attributeMajorData) const {
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    validateParameters(numberOfData);
+    SinglePrecisionPartition singlePartition = convertToSinglePrecision(attributeMajorData,
+                                                                        (std::size_t) numberOfClusters);
+    initialisePartitionMatrix(singlePartition);
+
+    std::vector<float> scratch(singlePartition.numberOfClusters * numberOfData);
+    std::vector<float> reciprocalSums(numberOfData);
+    // rounding alone changes every membership by about the float resolution
+    const double resolvedChange = SINGLE_PRECISION_RESOLUTION * SINGLE_PRECISION_RESOLUTION
+                                  * (double) (singlePartition.numberOfClusters * numberOfData);
+    const double squaredEpsilon = std::max(epsilon * epsilon, resolvedChange);
+    while (singlePartition.numberOfIterations < maximalNumberOfIterations) {
+        FUZZY_REGRESSION_TELEMETRY_SCOPE("mixedFcm.singlePrecisionIteration");
+        updateClusterCentres(singlePartition, scratch);
+        double squaredFrobeniusNorm = updatePartitionMatrix(singlePartition, scratch, reciprocalSums);
+        singlePartition.numberOfIterations++;
+        FUZZY_REGRESSION_TELEMETRY_COUNTER("fcm.membershipChange", std::sqrt(squaredFrobeniusNorm));
+        if (squaredFrobeniusNorm < squaredEpsilon) {
+            break;
+        }
+    }
+    updateClusterCentres(singlePartition, scratch);
+    scratch = {};
+    reciprocalSums = {};
+
+    const std::size_t numberOfAttributes = singlePartition.numberOfAttributes;
+    if (maximalNumberOfPolishIterations > 0) {
+        FuzzyCMeans polish;
+        polish.setNumberOfClusters(numberOfClusters);
+        polish.setEpsilonForFrobeniusNorm(epsilon);
+        polish.setFuzzification(fuzzification);
+        polish.setMaximalNumberOfIterations(maximalNumberOfPolishIterations);
+        const std::vector<double> clusterCentres = convertClusterCentres(singlePartition);
+        singlePartition.data = {};
+        singlePartition.partitionMatrix = {};
+        FuzzyPartition partition = polish.doPartition(attributeMajorData, clusterCentres);
+        partition.numberOfIterations += singlePartition.numberOfIterations;
+        return partition;
+    }
+    return FuzzyPartition{singlePartition.numberOfClusters,
+                          numberOfAttributes,
+                          numberOfData,
+                          convertClusterCentres(singlePartition),
+                          std::vector<double>(singlePartition.partitionMatrix.begin(),
+                                              singlePartition.partitionMatrix.end()),
+                          singlePartition.numberOfIterations,
+                          {},
+                          {}};
+}
+
+void MixedPrecisionFuzzyCMeans::validateParameters(std::size_t numberOfData) const {
+    if (numberOfClusters < 1 || numberOfData < (std::size_t) numberOfClusters) {
+        throw std::invalid_argument("Number of clusters has to be positive and not greater than number of data");
+    }
+    if (fuzzification <= 1.0) {
+        throw std::invalid_argument("Fuzzification exponent has to be greater than 1");
+    }
+    if (maximalNumberOfPolishIterations < 0) {
+        throw std::invalid_argument("Number of polish iterations cannot be negative");
+    }
+}
+
+MixedPrecisionFuzzyCMeans::SinglePrecisionPartition
+MixedPrecisionFuzzyCMeans::convertToSinglePrecision(const MatrixView<const double>& attributeMajorData,
+                                                    std::size_t numberOfClusters) {
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    SinglePrecisionPartition partition{numberOfClusters,
+                                       numberOfAttributes,
+                                       numberOfData,
+                                       std::vector<float>(numberOfAttributes * numberOfData),
+                                       std::vector<double>(numberOfAttributes, 0.0),
+                                       std::vector<float>(numberOfClusters * numberOfAttributes, 0.0f),
+                                       std::vector<float>(numberOfClusters * numberOfData),
+                                       0};
+    for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+        double attributeSum = 0;
+        for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+            attributeSum += attributeMajorData(attribute, datum);
+        }
+        const double mean = attributeSum / (double) numberOfData;
+        partition.attributeMeans[attribute] = mean;
+        float* row = partition.data.data() + attribute * numberOfData;
+        for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+            row[datum] = (float) (attributeMajorData(attribute, datum) - mean);
+        }
+    }
+    return partition;
+}
+
+void MixedPrecisionFuzzyCMeans::initialisePartitionMatrix(SinglePrecisionPartition& partition) const {
+    // same generator and order of draws as FuzzyCMeans::initialisePartitionMatrix
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> membershipDistribution(0.0, 1.0);
+    const std::size_t numberOfData = partition.numberOfData;
+    std::vector<double> memberships(partition.numberOfClusters);
+    for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+        double membershipSum = 0;
+        for (double& membership : memberships) {
+            membership = membershipDistribution(generator);
+            membershipSum += membership;
+        }
+        for (std::size_t cluster = 0; cluster < partition.numberOfClusters; ++cluster) {
+            partition.partitionMatrix[cluster * numberOfData + datum] = (float) (memberships[cluster] / membershipSum);
+        }
+    }
+}
+
+void MixedPrecisionFuzzyCMeans::updateClusterCentres(SinglePrecisionPartition& partition,
+                                                     std::vector<float>& scratch) const {
+    const std::size_t numberOfData = partition.numberOfData;
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    const std::size_t numberOfClusters = partition.numberOfClusters;
+    const float* memberships = partition.partitionMatrix.data();
+    float* weights = scratch.data();
+
+    if (fuzzification == 2.0) {
+        SimdKernels::square(memberships, weights, numberOfClusters * numberOfData);
+    } else {
+        const auto exponent = (float) fuzzification;
+        std::transform(memberships, memberships + numberOfClusters * numberOfData, weights,
+                       [exponent](float membership) { return std::pow(membership, exponent); });
+    }
+
+    // sums of one block are single precision, the running totals over all blocks double precision
+    std::vector<double> weightedSums(numberOfClusters * numberOfAttributes, 0.0);
+    std::vector<double> weightSums(numberOfClusters, 0.0);
+    for (std::size_t blockStart = 0; blockStart < numberOfData; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            const float* clusterWeights = weights + cluster * numberOfData + blockStart;
+            weightSums[cluster] += SimdKernels::sum(clusterWeights, blockLength);
+            for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                const float* attributeValues = partition.data.data() + attribute * numberOfData + blockStart;
+                weightedSums[cluster * numberOfAttributes + attribute] +=
+                        SimdKernels::dotProduct(clusterWeights, attributeValues, blockLength);
+            }
+        }
+    }
+
+    for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+        if (weightSums[cluster] <= 0) {
+            continue;
+        }
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            partition.clusterCentres[cluster * numberOfAttributes + attribute] =
+                    (float) (weightedSums[cluster * numberOfAttributes + attribute] / weightSums[cluster]);
+        }
+    }
+}
+
+double MixedPrecisionFuzzyCMeans::updatePartitionMatrix(SinglePrecisionPartition& partition,
+                                                        std::vector<float>& scratch,
+                                                        std::vector<float>& reciprocalSums) const {
+    const std::size_t numberOfData = partition.numberOfData;
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    const std::size_t numberOfClusters = partition.numberOfClusters;
+    const auto distanceExponent = (float) (-1.0 / (fuzzification - 1.0));
+    float* distances = scratch.data();
+    float* memberships = partition.partitionMatrix.data();
+
+    std::fill(reciprocalSums.begin(), reciprocalSums.end(), 0.0f);
+    double squaredChange = 0;
+    for (std::size_t blockStart = 0; blockStart < numberOfData; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        float* blockReciprocalSums = reciprocalSums.data() + blockStart;
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            float* clusterDistances = distances + cluster * numberOfData + blockStart;
+            const float* centre = partition.clusterCentres.data() + cluster * numberOfAttributes;
+            std::fill(clusterDistances, clusterDistances + blockLength, 0.0f);
+            for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                SimdKernels::accumulateSquaredDifferences(partition.data.data() + attribute * numberOfData + blockStart,
+                                                          centre[attribute], clusterDistances, blockLength);
+            }
+            if (fuzzification == 2.0) {
+                SimdKernels::invertAndAccumulate(clusterDistances, blockReciprocalSums, blockLength);
+            } else {
+                for (std::size_t i = 0; i < blockLength; ++i) {
+                    float reciprocal = std::pow(std::max(clusterDistances[i],
+                                                         SimdKernels::MINIMAL_SINGLE_PRECISION_DISTANCE),
+                                                distanceExponent);
+                    clusterDistances[i] = reciprocal;
+                    blockReciprocalSums[i] += reciprocal;
+                }
+            }
+        }
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            squaredChange += SimdKernels::normaliseMemberships(distances + cluster * numberOfData + blockStart,
+                                                               blockReciprocalSums,
+                                                               memberships + cluster * numberOfData + blockStart,
+                                                               blockLength);
+        }
+    }
+    return squaredChange;
+}
+
+std::vector<double> MixedPrecisionFuzzyCMeans::convertClusterCentres(const SinglePrecisionPartition& partition) {
+    std::vector<double> clusterCentres(partition.clusterCentres.size());
+    for (std::size_t cluster = 0; cluster < partition.numberOfClusters; ++cluster) {
+        for (std::size_t attribute = 0; attribute < partition.numberOfAttributes; ++attribute) {
+            const std::size_t index = cluster * partition.numberOfAttributes + attribute;
+            clusterCentres[index] = (double) partition.clusterCentres[index] + partition.attributeMeans[attribute];
+        }
+    }
+    return clusterCentres;
+}
@@ -0,0 +1,396 @@
+#include <algorithm>
+
+#include "clustering/SimdIntrinsics.hpp"
+#include "clustering/SimdKernels.hpp"
+
+#if defined(__AVX2__)
+using SimdIntrinsics::horizontalSum;
+using SimdIntrinsics::multiplyAdd;
+#endif
+
+const char* SimdKernels::instructionSetName() {
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+void SimdKernels::accumulateSquaredDifferences(const double* values,
+                                               double reference,
+                                               double* accumulator,
+                                               std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512d referenceVector = _mm512_set1_pd(reference);
+    for (; i + 8 <= count; i += 8) {
+        __m512d difference = _mm512_sub_pd(_mm512_loadu_pd(values + i), referenceVector);
+        __m512d accumulated = _mm512_fmadd_pd(difference, difference, _mm512_loadu_pd(accumulator + i));
+        _mm512_storeu_pd(accumulator + i, accumulated);
+    }
+#elif defined(__AVX2__)
+    const __m256d referenceVector = _mm256_set1_pd(reference);
+    for (; i + 4 <= count; i += 4) {
+        __m256d difference = _mm256_sub_pd(_mm256_loadu_pd(values + i), referenceVector);
+        __m256d accumulated = multiplyAdd(difference, difference, _mm256_loadu_pd(accumulator + i));
+        _mm256_storeu_pd(accumulator + i, accumulated);
+    }
+#endif
+    for (; i < count; ++i) {
+        double difference = values[i] - reference;
+        accumulator[i] += difference * difference;
+    }
+}
+
+void SimdKernels::invertAndAccumulate(double* distances, double* reciprocalSums, std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512d minimalDistance = _mm512_set1_pd(MINIMAL_DISTANCE);
+    const __m512d ones = _mm512_set1_pd(1.0);
+    for (; i + 8 <= count; i += 8) {
+        __m512d reciprocal = _mm512_div_pd(ones, _mm512_max_pd(_mm512_loadu_pd(distances + i), minimalDistance));
+        _mm512_storeu_pd(distances + i, reciprocal);
+        _mm512_storeu_pd(reciprocalSums + i, _mm512_add_pd(_mm512_loadu_pd(reciprocalSums + i), reciprocal));
+    }
+#elif defined(__AVX2__)
+    const __m256d minimalDistance = _mm256_set1_pd(MINIMAL_DISTANCE);
+    const __m256d ones = _mm256_set1_pd(1.0);
+    for (; i + 4 <= count; i += 4) {
+        __m256d reciprocal = _mm256_div_pd(ones, _mm256_max_pd(_mm256_loadu_pd(distances + i), minimalDistance));
+        _mm256_storeu_pd(distances + i, reciprocal);
+        _mm256_storeu_pd(reciprocalSums + i, _mm256_add_pd(_mm256_loadu_pd(reciprocalSums + i), reciprocal));
+    }
+#endif
+    for (; i < count; ++i) {
+        double reciprocal = 1.0 / std::max(distances[i], MINIMAL_DISTANCE);
+        distances[i] = reciprocal;
+        reciprocalSums[i] += reciprocal;
+    }
+}
+
+double SimdKernels::normaliseMemberships(const double* reciprocals,
+                                         const double* reciprocalSums,
+                                         double* memberships,
+                                         std::size_t count) {
+    std::size_t i = 0;
+    double squaredChange = 0;
+#if defined(__AVX512F__)
+    __m512d squaredChangeVector = _mm512_setzero_pd();
+    for (; i + 8 <= count; i += 8) {
+        __m512d membership = _mm512_div_pd(_mm512_loadu_pd(reciprocals + i), _mm512_loadu_pd(reciprocalSums + i));
+        __m512d change = _mm512_sub_pd(membership, _mm512_loadu_pd(memberships + i));
+        squaredChangeVector = _mm512_fmadd_pd(change, change, squaredChangeVector);
+        _mm512_storeu_pd(memberships + i, membership);
+    }
+    squaredChange = _mm512_reduce_add_pd(squaredChangeVector);
+#elif defined(__AVX2__)
+    __m256d squaredChangeVector = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        __m256d membership = _mm256_div_pd(_mm256_loadu_pd(reciprocals + i), _mm256_loadu_pd(reciprocalSums + i));
+        __m256d change = _mm256_sub_pd(membership, _mm256_loadu_pd(memberships + i));
+        squaredChangeVector = multiplyAdd(change, change, squaredChangeVector);
+        _mm256_storeu_pd(memberships + i, membership);
+    }
+    squaredChange = horizontalSum(squaredChangeVector);
+#endif
+    for (; i < count; ++i) {
+        double membership = reciprocals[i] / reciprocalSums[i];
+        double change = membership - memberships[i];
+        squaredChange += change * change;
+        memberships[i] = membership;
+    }
+    return squaredChange;
+}
+
+void SimdKernels::updateHighestMemberships(const double* memberships,
+                                           double cluster,
+                                           double* highestMemberships,
+                                           double* highestClusters,
+                                           std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512d clusterVector = _mm512_set1_pd(cluster);
+    for (; i + 8 <= count; i += 8) {
+        __m512d membership = _mm512_loadu_pd(memberships + i);
+        __m512d highestMembership = _mm512_loadu_pd(highestMemberships + i);
+        __mmask8 higher = _mm512_cmp_pd_mask(membership, highestMembership, _CMP_GT_OQ);
+        _mm512_storeu_pd(highestMemberships + i, _mm512_mask_blend_pd(higher, highestMembership, membership));
+        _mm512_storeu_pd(highestClusters + i, _mm512_mask_blend_pd(higher, _mm512_loadu_pd(highestClusters + i),
+                                                                   clusterVector));
+    }
+#elif defined(__AVX2__)
+    const __m256d clusterVector = _mm256_set1_pd(cluster);
+    for (; i + 4 <= count; i += 4) {
+        __m256d membership = _mm256_loadu_pd(memberships + i);
+        __m256d highestMembership = _mm256_loadu_pd(highestMemberships + i);
+        __m256d higher = _mm256_cmp_pd(membership, highestMembership, _CMP_GT_OQ);
+        _mm256_storeu_pd(highestMemberships + i, _mm256_blendv_pd(highestMembership, membership, higher));
+        _mm256_storeu_pd(highestClusters + i, _mm256_blendv_pd(_mm256_loadu_pd(highestClusters + i),
+                                                               clusterVector, higher));
+    }
+#endif
+    for (; i < count; ++i) {
+        if (memberships[i] > highestMemberships[i]) {
+            highestMemberships[i] = memberships[i];
+            highestClusters[i] = cluster;
+        }
+    }
+}
+
+void SimdKernels::square(const double* values, double* output, std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 8 <= count; i += 8) {
+        __m512d value = _mm512_loadu_pd(values + i);
+        _mm512_storeu_pd(output + i, _mm512_mul_pd(value, value));
+    }
+#elif defined(__AVX2__)
+    for (; i + 4 <= count; i += 4) {
+        __m256d value = _mm256_loadu_pd(values + i);
+        _mm256_storeu_pd(output + i, _mm256_mul_pd(value, value));
+    }
+#endif
+    for (; i < count; ++i) {
+        output[i] = values[i] * values[i];
+    }
+}
+
+double SimdKernels::sum(const double* values, std::size_t count) {
+    std::size_t i = 0;
+    double result = 0;
+#if defined(__AVX512F__)
+    __m512d sumVector = _mm512_setzero_pd();
+    for (; i + 8 <= count; i += 8) {
+        sumVector = _mm512_add_pd(sumVector, _mm512_loadu_pd(values + i));
+    }
+    result = _mm512_reduce_add_pd(sumVector);
+#elif defined(__AVX2__)
+    __m256d sumVector = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        sumVector = _mm256_add_pd(sumVector, _mm256_loadu_pd(values + i));
+    }
+    result = horizontalSum(sumVector);
+#endif
+    for (; i < count; ++i) {
+        result += values[i];
+    }
+    return result;
+}
+
+double SimdKernels::dotProduct(const double* first, const double* second, std::size_t count) {
+    std::size_t i = 0;
+    double result = 0;
+#if defined(__AVX512F__)
+    __m512d productVector = _mm512_setzero_pd();
+    for (; i + 8 <= count; i += 8) {
+        productVector = _mm512_fmadd_pd(_mm512_loadu_pd(first + i), _mm512_loadu_pd(second + i), productVector);
+    }
+    result = _mm512_reduce_add_pd(productVector);
+#elif defined(__AVX2__)
+    __m256d productVector = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        productVector = multiplyAdd(_mm256_loadu_pd(first + i), _mm256_loadu_pd(second + i), productVector);
+    }
+    result = horizontalSum(productVector);
+#endif
+    for (; i < count; ++i) {
+        result += first[i] * second[i];
+    }
+    return result;
+}
+
+void SimdKernels::accumulateScaled(const double* values, double factor, double* accumulator, std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512d factorVector = _mm512_set1_pd(factor);
+    for (; i + 8 <= count; i += 8) {
+        __m512d accumulated = _mm512_fmadd_pd(_mm512_loadu_pd(values + i), factorVector,
+                                              _mm512_loadu_pd(accumulator + i));
+        _mm512_storeu_pd(accumulator + i, accumulated);
+    }
+#elif defined(__AVX2__)
+    const __m256d factorVector = _mm256_set1_pd(factor);
+    for (; i + 4 <= count; i += 4) {
+        __m256d accumulated = multiplyAdd(_mm256_loadu_pd(values + i), factorVector, _mm256_loadu_pd(accumulator + i));
+        _mm256_storeu_pd(accumulator + i, accumulated);
+    }
+#endif
+    for (; i < count; ++i) {
+        accumulator[i] += factor * values[i];
+    }
+}
+
+double SimdKernels::sumOfSquaredDifferences(const double* first, const double* second, std::size_t count) {
+    std::size_t i = 0;
+    double result = 0;
+#if defined(__AVX512F__)
+    __m512d sumVector = _mm512_setzero_pd();
+    for (; i + 8 <= count; i += 8) {
+        __m512d difference = _mm512_sub_pd(_mm512_loadu_pd(first + i), _mm512_loadu_pd(second + i));
+        sumVector = _mm512_fmadd_pd(difference, difference, sumVector);
+    }
+    result = _mm512_reduce_add_pd(sumVector);
+#elif defined(__AVX2__)
+    __m256d sumVector = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        __m256d difference = _mm256_sub_pd(_mm256_loadu_pd(first + i), _mm256_loadu_pd(second + i));
+        sumVector = multiplyAdd(difference, difference, sumVector);
+    }
+    result = horizontalSum(sumVector);
+#endif
+    for (; i < count; ++i) {
+        const double difference = first[i] - second[i];
+        result += difference * difference;
+    }
+    return result;
+}
+
+void SimdKernels::accumulateSquaredDifferences(const float* values,
+                                               float reference,
+                                               float* accumulator,
+                                               std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512 referenceVector = _mm512_set1_ps(reference);
+    for (; i + 16 <= count; i += 16) {
+        __m512 difference = _mm512_sub_ps(_mm512_loadu_ps(values + i), referenceVector);
+        __m512 accumulated = _mm512_fmadd_ps(difference, difference, _mm512_loadu_ps(accumulator + i));
+        _mm512_storeu_ps(accumulator + i, accumulated);
+    }
+#elif defined(__AVX2__)
+    const __m256 referenceVector = _mm256_set1_ps(reference);
+    for (; i + 8 <= count; i += 8) {
+        __m256 difference = _mm256_sub_ps(_mm256_loadu_ps(values + i), referenceVector);
+        __m256 accumulated = multiplyAdd(difference, difference, _mm256_loadu_ps(accumulator + i));
+        _mm256_storeu_ps(accumulator + i, accumulated);
+    }
+#endif
+    for (; i < count; ++i) {
+        float difference = values[i] - reference;
+        accumulator[i] += difference * difference;
+    }
+}
+
+void SimdKernels::invertAndAccumulate(float* distances, float* reciprocalSums, std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512 minimalDistance = _mm512_set1_ps(MINIMAL_SINGLE_PRECISION_DISTANCE);
+    const __m512 ones = _mm512_set1_ps(1.0f);
+    for (; i + 16 <= count; i += 16) {
+        __m512 reciprocal = _mm512_div_ps(ones, _mm512_max_ps(_mm512_loadu_ps(distances + i), minimalDistance));
+        _mm512_storeu_ps(distances + i, reciprocal);
+        _mm512_storeu_ps(reciprocalSums + i, _mm512_add_ps(_mm512_loadu_ps(reciprocalSums + i), reciprocal));
+    }
+#elif defined(__AVX2__)
+    const __m256 minimalDistance = _mm256_set1_ps(MINIMAL_SINGLE_PRECISION_DISTANCE);
+    const __m256 ones = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m256 reciprocal = _mm256_div_ps(ones, _mm256_max_ps(_mm256_loadu_ps(distances + i), minimalDistance));
+        _mm256_storeu_ps(distances + i, reciprocal);
+        _mm256_storeu_ps(reciprocalSums + i, _mm256_add_ps(_mm256_loadu_ps(reciprocalSums + i), reciprocal));
+    }
+#endif
+    for (; i < count; ++i) {
+        float reciprocal = 1.0f / std::max(distances[i], MINIMAL_SINGLE_PRECISION_DISTANCE);
+        distances[i] = reciprocal;
+        reciprocalSums[i] += reciprocal;
+    }
+}
+
+double SimdKernels::normaliseMemberships(const float* reciprocals,
+                                         const float* reciprocalSums,
+                                         float* memberships,
+                                         std::size_t count) {
+    std::size_t i = 0;
+    double squaredChange = 0;
+#if defined(__AVX512F__)
+    __m512 squaredChangeVector = _mm512_setzero_ps();
+    for (; i + 16 <= count; i += 16) {
+        __m512 membership = _mm512_div_ps(_mm512_loadu_ps(reciprocals + i), _mm512_loadu_ps(reciprocalSums + i));
+        __m512 change = _mm512_sub_ps(membership, _mm512_loadu_ps(memberships + i));
+        squaredChangeVector = _mm512_fmadd_ps(change, change, squaredChangeVector);
+        _mm512_storeu_ps(memberships + i, membership);
+    }
+    squaredChange = _mm512_reduce_add_ps(squaredChangeVector);
+#elif defined(__AVX2__)
+    __m256 squaredChangeVector = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        __m256 membership = _mm256_div_ps(_mm256_loadu_ps(reciprocals + i), _mm256_loadu_ps(reciprocalSums + i));
+        __m256 change = _mm256_sub_ps(membership, _mm256_loadu_ps(memberships + i));
+        squaredChangeVector = multiplyAdd(change, change, squaredChangeVector);
+        _mm256_storeu_ps(memberships + i, membership);
+    }
+    squaredChange = horizontalSum(squaredChangeVector);
+#endif
+    for (; i < count; ++i) {
+        float membership = reciprocals[i] / reciprocalSums[i];
+        float change = membership - memberships[i];
+        squaredChange += change * change;
+        memberships[i] = membership;
+    }
+    return squaredChange;
+}
+
+void SimdKernels::square(const float* values, float* output, std::size_t count) {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= count; i += 16) {
+        __m512 value = _mm512_loadu_ps(values + i);
+        _mm512_storeu_ps(output + i, _mm512_mul_ps(value, value));
+    }
+#elif defined(__AVX2__)
+    for (; i + 8 <= count; i += 8) {
+        __m256 value = _mm256_loadu_ps(values + i);
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(value, value));
+    }
+#endif
+    for (; i < count; ++i) {
+        output[i] = values[i] * values[i];
+    }
+}
+
+float SimdKernels::sum(const float* values, std::size_t count) {
+    std::size_t i = 0;
+    float result = 0;
+#if defined(__AVX512F__)
+    __m512 sumVector = _mm512_setzero_ps();
+    for (; i + 16 <= count; i += 16) {
+        sumVector = _mm512_add_ps(sumVector, _mm512_loadu_ps(values + i));
+    }
+    result = _mm512_reduce_add_ps(sumVector);
+#elif defined(__AVX2__)
+    __m256 sumVector = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        sumVector = _mm256_add_ps(sumVector, _mm256_loadu_ps(values + i));
+    }
+    result = horizontalSum(sumVector);
+#endif
+    for (; i < count; ++i) {
+        result += values[i];
+    }
+    return result;
+}
+
+float SimdKernels::dotProduct(const float* first, const float* second, std::size_t count) {
+    std::size_t i = 0;
+    float result = 0;
+#if defined(__AVX512F__)
+    __m512 productVector = _mm512_setzero_ps();
+    for (; i + 16 <= count; i += 16) {
+        productVector = _mm512_fmadd_ps(_mm512_loadu_ps(first + i), _mm512_loadu_ps(second + i), productVector);
+    }
+    result = _mm512_reduce_add_ps(productVector);
+#elif defined(__AVX2__)
+    __m256 productVector = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        productVector = multiplyAdd(_mm256_loadu_ps(first + i), _mm256_loadu_ps(second + i), productVector);
+    }
+    result = horizontalSum(productVector);
+#endif
+    for (; i < count; ++i) {
+        result += first[i] * second[i];
+    }
+    return result;
+}
@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "clustering/FixedDimensionKernels.hpp"
+#include "clustering/SimdKernels.hpp"
+#include "clustering/SparseFuzzyCMeans.hpp"
+#include "telemetry/Telemetry.hpp"
+
+namespace {
+    std::vector<const double*> collectRows(const MatrixView<const double>& attributeMajorData) {
+        std::vector<const double*> rows(attributeMajorData.getNumberOfRows());
+        for (std::size_t attribute = 0; attribute < rows.size(); ++attribute) {
+            rows[attribute] = attributeMajorData.row(attribute);
+        }
+        return rows;
+    }
+}
+
+SparseFuzzyCMeans::SparseFuzzyCMeans() noexcept
+: numberOfClusters(2),
+epsilon(EPSILON_DEFAULT_VALUE),
+fuzzification(FUZZIFICATION_DEFAULT_VALUE),
+maximalNumberOfIterations(MAXIMAL_NUMBER_OF_ITERATIONS_DEFAULT_VALUE),
+seed(SEED_DEFAULT_VALUE),
+maximalNumberOfMemberships(0),
+membershipThreshold(0),
+fullUpdateInterval(FULL_UPDATE_INTERVAL_DEFAULT_VALUE){}
+
+void SparseFuzzyCMeans::setNumberOfClusters(int numberOfClusters) {
+    this->numberOfClusters = numberOfClusters;
+}
+
+void SparseFuzzyCMeans::setEpsilonForFrobeniusNorm(double epsilon) {
+    this->epsilon = epsilon;
+}
+
+void SparseFuzzyCMeans::setFuzzification(double fuzzification) {
+    this->fuzzification = fuzzification;
+}
+
+void SparseFuzzyCMeans::setMaximalNumberOfIterations(int maximalNumberOfIterations) {
+    this->maximalNumberOfIterations = maximalNumberOfIterations;
+}
+
+void SparseFuzzyCMeans::setSeed(unsigned int seed) {
+    this->seed = seed;
+}
+
+void SparseFuzzyCMeans::setMaximalNumberOfMemberships(std::size_t maximalNumberOfMemberships) {
+    this->maximalNumberOfMemberships = maximalNumberOfMemberships;
+}
+
+void SparseFuzzyCMeans::setMembershipThreshold(double membershipThreshold) {
+    this->membershipThreshold = membershipThreshold;
+}
+
+void SparseFuzzyCMeans::setFullUpdateInterval(int fullUpdateInterval) {
+    this->fullUpdateInterval = fullUpdateInterval;
+}
+
+FuzzyPartition SparseFuzzyCMeans::doPartition(const MatrixView<const double>& attributeMajorData) const {
+    if (!attributeMajorData.hasContiguousRows()) {
+        const std::vector<double> contiguousData = FuzzyCMeans::copyToContiguousRows(attributeMajorData);
+        return doPartition(MatrixView<const double>::rowMajor(contiguousData.data(),
+                                                              attributeMajorData.getNumberOfRows(),
+                                                              attributeMajorData.getNumberOfColumns()));
+    }
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    validateParameters(numberOfData);
+    FuzzyPartition partition{(std::size_t) numberOfClusters,
+                             attributeMajorData.getNumberOfRows(),
+                             numberOfData,
+                             calculateInitialClusterCentres(attributeMajorData),
+                             {},
+                             0,
+                             {},
+                             {}};
+    SparseMembershipMatrix previousMemberships;
+    const double squaredEpsilon = epsilon * epsilon;
+    // a change below epsilon among the kept clusters is confirmed by choosing them again
+    bool fullUpdateDue = true;
+    while (partition.numberOfIterations < maximalNumberOfIterations) {
+        FUZZY_REGRESSION_TELEMETRY_SCOPE(fullUpdateDue || partition.numberOfIterations % fullUpdateInterval == 0
+                                         ? "sparseFcm.fullIteration" : "sparseFcm.iteration");
+        if (partition.numberOfIterations > 0) {
+            updateClusterCentres(attributeMajorData, partition);
+        }
+        const bool fullUpdate = fullUpdateDue || partition.numberOfIterations % fullUpdateInterval == 0;
+        const double squaredFrobeniusNorm = fullUpdate
+                ? selectMemberships(attributeMajorData, partition, previousMemberships)
+                : updateKeptMemberships(attributeMajorData, partition);
+        partition.numberOfIterations++;
+        FUZZY_REGRESSION_TELEMETRY_COUNTER("fcm.membershipChange", std::sqrt(squaredFrobeniusNorm));
+        if (squaredFrobeniusNorm < squaredEpsilon && fullUpdate) {
+            break;
+        }
+        fullUpdateDue = squaredFrobeniusNorm < squaredEpsilon;
+    }
+    updateClusterCentres(attributeMajorData, partition);
+    return partition;
+}
+
+void SparseFuzzyCMeans::validateParameters(std::size_t numberOfData) const {
+    if (numberOfClusters < 1 || numberOfData < (std::size_t) numberOfClusters) {
+        throw std::invalid_argument("Number of clusters has to be positive and not greater than number of data");
+    }
+    if (fuzzification <= 1.0) {
+        throw std::invalid_argument("Fuzzification exponent has to be greater than 1");
+    }
+    if (membershipThreshold < 0 || membershipThreshold >= 1) {
+        throw std::invalid_argument("Membership threshold has to be in [0, 1)");
+    }
+    if (fullUpdateInterval < 1) {
+        throw std::invalid_argument("Full update interval has to be positive");
+    }
+}
+
+std::vector<double> SparseFuzzyCMeans::calculateInitialClusterCentres(const MatrixView<const double>& attributeMajorData) const {
+    const std::size_t numberOfAttributes = attributeMajorData.getNumberOfRows();
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    const auto clusterCount = (std::size_t) numberOfClusters;
+    const std::vector<const double*> rows = collectRows(attributeMajorData);
+    // same generator and order of draws as FuzzyCMeans::initialisePartitionMatrix
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> membershipDistribution(0.0, 1.0);
+    std::vector<double> memberships(clusterCount);
+    std::vector<double> weightedSums(clusterCount * numberOfAttributes, 0.0);
+    std::vector<double> weightSums(clusterCount, 0.0);
+    for (std::size_t datum = 0; datum < numberOfData; ++datum) {
+        double membershipSum = 0;
+        for (double& membership : memberships) {
+            membership = membershipDistribution(generator);
+            membershipSum += membership;
+        }
+        for (std::size_t cluster = 0; cluster < clusterCount; ++cluster) {
+            const double weight = std::pow(memberships[cluster] / membershipSum, fuzzification);
+            weightSums[cluster] += weight;
+            for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                weightedSums[cluster * numberOfAttributes + attribute] += weight * rows[attribute][datum];
+            }
+        }
+    }
+    for (std::size_t cluster = 0; cluster < clusterCount; ++cluster) {
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            weightedSums[cluster * numberOfAttributes + attribute] /= weightSums[cluster];
+        }
+    }
+    return weightedSums;
+}
+
+void SparseFuzzyCMeans::updateClusterCentres(const MatrixView<const double>& attributeMajorData,
+                                             FuzzyPartition& partition) const {
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    const std::size_t numberOfClusters = partition.numberOfClusters;
+    const SparseMembershipMatrix& sparseMemberships = partition.sparseMemberships;
+    if (sparseMemberships.empty()) {
+        return;
+    }
+    const std::vector<const double*> rows = collectRows(attributeMajorData);
+    std::vector<double> datumValues(numberOfAttributes);
+    std::vector<double> weightedSums(numberOfClusters * numberOfAttributes, 0.0);
+    std::vector<double> weightSums(numberOfClusters, 0.0);
+    for (std::size_t datum = 0; datum < partition.numberOfData; ++datum) {
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            datumValues[attribute] = rows[attribute][datum];
+        }
+        for (std::size_t entry = sparseMemberships.datumOffsets[datum];
+             entry < sparseMemberships.datumOffsets[datum + 1]; ++entry) {
+            const double membership = sparseMemberships.memberships[entry];
+            const double weight = fuzzification == 2.0 ? membership * membership : std::pow(membership, fuzzification);
+            const std::size_t cluster = sparseMemberships.clusterIndices[entry];
+            double* clusterSums = weightedSums.data() + cluster * numberOfAttributes;
+            for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                clusterSums[attribute] += weight * datumValues[attribute];
+            }
+            weightSums[cluster] += weight;
+        }
+    }
+    // a cluster no datum kept its membership in stays where it is
+    for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+        if (weightSums[cluster] <= 0) {
+            continue;
+        }
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            partition.clusterCentres[cluster * numberOfAttributes + attribute] =
+                    weightedSums[cluster * numberOfAttributes + attribute] / weightSums[cluster];
+        }
+    }
+}
+
+double SparseFuzzyCMeans::selectMemberships(const MatrixView<const double>& attributeMajorData,
+                                            FuzzyPartition& partition,
+                                            SparseMembershipMatrix& previousMemberships) const {
+    const std::size_t numberOfData = partition.numberOfData;
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    const std::size_t numberOfClusters = partition.numberOfClusters;
+    const std::size_t keptLimit = maximalNumberOfMemberships == 0
+            ? numberOfClusters
+            : std::min(maximalNumberOfMemberships, numberOfClusters);
+    std::swap(previousMemberships, partition.sparseMemberships);
+    SparseMembershipMatrix& memberships = partition.sparseMemberships;
+    memberships.datumOffsets.assign(1, 0);
+    memberships.datumOffsets.reserve(numberOfData + 1);
+    memberships.clusterIndices.clear();
+    memberships.clusterIndices.reserve(previousMemberships.clusterIndices.size());
+    memberships.memberships.clear();
+    memberships.memberships.reserve(previousMemberships.memberships.size());
+
+    const FixedDimensionKernels::Table* kernels = FixedDimensionKernels::forDimension(numberOfAttributes);
+    const double distanceExponent = -1.0 / (fuzzification - 1.0);
+    std::vector<double> reciprocals(numberOfClusters * DATUM_BLOCK_SIZE);
+    std::vector<double> reciprocalSums(DATUM_BLOCK_SIZE);
+    // keptLimit highest reciprocals of every datum of the block and their clusters, one rank after another
+    const bool selectingHighest = keptLimit < numberOfClusters;
+    std::vector<double> highestReciprocals(selectingHighest ? keptLimit * DATUM_BLOCK_SIZE : 0);
+    std::vector<std::uint32_t> highestClusters(selectingHighest ? keptLimit * DATUM_BLOCK_SIZE : 0);
+    std::vector<std::uint32_t> keptClusters(numberOfClusters);
+    std::vector<double> keptReciprocals(numberOfClusters);
+    const bool firstSelection = previousMemberships.empty();
+    double squaredChange = 0;
+    for (std::size_t blockStart = 0; blockStart < numberOfData; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, numberOfData - blockStart);
+        std::fill(reciprocalSums.begin(), reciprocalSums.begin() + blockLength, 0.0);
+        for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+            double* clusterReciprocals = reciprocals.data() + cluster * DATUM_BLOCK_SIZE;
+            const double* centre = partition.clusterCentres.data() + cluster * numberOfAttributes;
+            if (kernels != nullptr && fuzzification == 2.0) {
+                kernels->reciprocalSquaredDistances(attributeMajorData, blockStart, blockLength, centre,
+                                                    clusterReciprocals, reciprocalSums.data());
+                continue;
+            }
+            if (kernels != nullptr) {
+                kernels->squaredDistances(attributeMajorData, blockStart, blockLength, centre, clusterReciprocals);
+            } else {
+                std::fill(clusterReciprocals, clusterReciprocals + blockLength, 0.0);
+                for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                    SimdKernels::accumulateSquaredDifferences(attributeMajorData.row(attribute) + blockStart,
+                                                              centre[attribute], clusterReciprocals, blockLength);
+                }
+            }
+            if (fuzzification == 2.0) {
+                SimdKernels::invertAndAccumulate(clusterReciprocals, reciprocalSums.data(), blockLength);
+            } else {
+                for (std::size_t i = 0; i < blockLength; ++i) {
+                    clusterReciprocals[i] = std::pow(std::max(clusterReciprocals[i], SimdKernels::MINIMAL_DISTANCE),
+                                                     distanceExponent);
+                    reciprocalSums[i] += clusterReciprocals[i];
+                }
+            }
+        }
+        if (selectingHighest) {
+            selectHighestReciprocals(reciprocals.data(), numberOfClusters, blockLength, keptLimit, previousMemberships,
+                                     blockStart, highestReciprocals.data(), highestClusters.data());
+        }
+        for (std::size_t i = 0; i < blockLength; ++i) {
+            const double minimalReciprocal = membershipThreshold * reciprocalSums[i];
+            std::size_t keptCount = 0;
+            if (selectingHighest) {
+                // ranks are sorted, the highest reciprocal is kept whatever the threshold
+                const double* datumReciprocals = highestReciprocals.data() + i * keptLimit;
+                const std::uint32_t* datumClusters = highestClusters.data() + i * keptLimit;
+                do {
+                    keptClusters[keptCount] = datumClusters[keptCount];
+                    keptReciprocals[keptCount] = datumReciprocals[keptCount];
+                    ++keptCount;
+                } while (keptCount < keptLimit && datumReciprocals[keptCount] >= minimalReciprocal);
+                for (std::size_t kept = 1; kept < keptCount; ++kept) {
+                    for (std::size_t position = kept; position > 0 && keptClusters[position - 1] > keptClusters[position];
+                         --position) {
+                        std::swap(keptClusters[position - 1], keptClusters[position]);
+                        std::swap(keptReciprocals[position - 1], keptReciprocals[position]);
+                    }
+                }
+            } else {
+                std::uint32_t highestCluster = 0;
+                for (std::uint32_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+                    const double reciprocal = reciprocals[cluster * DATUM_BLOCK_SIZE + i];
+                    if (reciprocal > reciprocals[highestCluster * DATUM_BLOCK_SIZE + i]) {
+                        highestCluster = cluster;
+                    }
+                    if (reciprocal >= minimalReciprocal) {
+                        keptClusters[keptCount] = cluster;
+                        keptReciprocals[keptCount++] = reciprocal;
+                    }
+                }
+                if (keptCount == 0) {
+                    keptClusters[0] = highestCluster;
+                    keptReciprocals[0] = reciprocals[highestCluster * DATUM_BLOCK_SIZE + i];
+                    keptCount = 1;
+                }
+            }
+            const double keptReciprocalSum = std::accumulate(keptReciprocals.begin(),
+                                                             keptReciprocals.begin() + (std::ptrdiff_t) keptCount, 0.0);
+
+            // both rows are sorted by cluster, memberships missing from one of them count as 0
+            const std::size_t datum = blockStart + i;
+            std::size_t previousEntry = firstSelection ? 0 : previousMemberships.datumOffsets[datum];
+            const std::size_t previousEnd = firstSelection ? 0 : previousMemberships.datumOffsets[datum + 1];
+            for (std::size_t kept = 0; kept < keptCount; ++kept) {
+                const std::uint32_t cluster = keptClusters[kept];
+                const double membership = keptReciprocals[kept] / keptReciprocalSum;
+                for (; previousEntry < previousEnd && previousMemberships.clusterIndices[previousEntry] < cluster;
+                       ++previousEntry) {
+                    squaredChange += previousMemberships.memberships[previousEntry]
+                                     * previousMemberships.memberships[previousEntry];
+                }
+                double previousMembership = 0;
+                if (previousEntry < previousEnd && previousMemberships.clusterIndices[previousEntry] == cluster) {
+                    previousMembership = previousMemberships.memberships[previousEntry++];
+                }
+                squaredChange += (membership - previousMembership) * (membership - previousMembership);
+                memberships.clusterIndices.push_back(cluster);
+                memberships.memberships.push_back(membership);
+            }
+            for (; previousEntry < previousEnd; ++previousEntry) {
+                squaredChange += previousMemberships.memberships[previousEntry]
+                                 * previousMemberships.memberships[previousEntry];
+            }
+            memberships.datumOffsets.push_back(memberships.memberships.size());
+        }
+    }
+    return squaredChange;
+}
+
+void SparseFuzzyCMeans::selectHighestReciprocals(const double* reciprocals,
+                                                 std::size_t numberOfClusters,
+                                                 std::size_t blockLength,
+                                                 std::size_t keptLimit,
+                                                 const SparseMembershipMatrix& previousMemberships,
+                                                 std::size_t blockStart,
+                                                 double* highestReciprocals,
+                                                 std::uint32_t* highestClusters) {
+    // reciprocals are positive, so every rank is taken by the first clusters seen
+    std::fill(highestReciprocals, highestReciprocals + keptLimit * blockLength, -1.0);
+    // keptLimit clusters kept before bound the lowest reciprocal of the new ones from below, so only
+    // reciprocals at least that high can get a rank; clusters come in index order, not by distance,
+    // and without the bound about keptLimit * (1 + ln(numberOfClusters / keptLimit)) would be ranked
+    double lowestKeptReciprocals[DATUM_BLOCK_SIZE];
+    std::fill(lowestKeptReciprocals, lowestKeptReciprocals + blockLength, -1.0);
+    for (std::size_t i = 0; i < blockLength && !previousMemberships.empty(); ++i) {
+        const std::size_t firstEntry = previousMemberships.datumOffsets[blockStart + i];
+        const std::size_t lastEntry = previousMemberships.datumOffsets[blockStart + i + 1];
+        if (lastEntry - firstEntry != keptLimit) {
+            continue;
+        }
+        double lowestReciprocal = reciprocals[previousMemberships.clusterIndices[firstEntry] * DATUM_BLOCK_SIZE + i];
+        for (std::size_t entry = firstEntry + 1; entry < lastEntry; ++entry) {
+            lowestReciprocal = std::min(lowestReciprocal,
+                                        reciprocals[previousMemberships.clusterIndices[entry] * DATUM_BLOCK_SIZE + i]);
+        }
+        lowestKeptReciprocals[i] = lowestReciprocal;
+    }
+    std::uint32_t candidates[DATUM_BLOCK_SIZE];
+    for (std::size_t cluster = 0; cluster < numberOfClusters; ++cluster) {
+        const double* clusterReciprocals = reciprocals + cluster * DATUM_BLOCK_SIZE;
+        // after the first clusters few datums get a new rank, they are collected without branches
+        // so that the test does not cost a misprediction for every one of them
+        std::size_t numberOfCandidates = 0;
+        for (std::size_t i = 0; i < blockLength; ++i) {
+            candidates[numberOfCandidates] = (std::uint32_t) i;
+            numberOfCandidates += clusterReciprocals[i] >= lowestKeptReciprocals[i];
+        }
+        for (std::size_t candidate = 0; candidate < numberOfCandidates; ++candidate) {
+            const std::size_t i = candidates[candidate];
+            const double reciprocal = clusterReciprocals[i];
+            double* datumReciprocals = highestReciprocals + i * keptLimit;
+            std::uint32_t* datumClusters = highestClusters + i * keptLimit;
+            std::size_t rank = keptLimit - 1;
+            for (; rank > 0 && datumReciprocals[rank - 1] < reciprocal; --rank) {
+                datumReciprocals[rank] = datumReciprocals[rank - 1];
+                datumClusters[rank] = datumClusters[rank - 1];
+            }
+            datumReciprocals[rank] = reciprocal;
+            datumClusters[rank] = (std::uint32_t) cluster;
+            lowestKeptReciprocals[i] = std::max(lowestKeptReciprocals[i], datumReciprocals[keptLimit - 1]);
+        }
+    }
+}
+
+double SparseFuzzyCMeans::updateKeptMemberships(const MatrixView<const double>& attributeMajorData,
+                                                FuzzyPartition& partition) const {
+    const std::size_t numberOfAttributes = partition.numberOfAttributes;
+    SparseMembershipMatrix& sparseMemberships = partition.sparseMemberships;
+    const std::vector<const double*> rows = collectRows(attributeMajorData);
+    std::vector<double> datumValues(numberOfAttributes);
+    std::vector<double> reciprocals(partition.numberOfClusters);
+    double squaredChange = 0;
+    for (std::size_t datum = 0; datum < partition.numberOfData; ++datum) {
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            datumValues[attribute] = rows[attribute][datum];
+        }
+        const std::size_t firstEntry = sparseMemberships.datumOffsets[datum];
+        const std::size_t lastEntry = sparseMemberships.datumOffsets[datum + 1];
+        double reciprocalSum = 0;
+        for (std::size_t entry = firstEntry; entry < lastEntry; ++entry) {
+            const double* centre = partition.clusterCentres.data()
+                                   + sparseMemberships.clusterIndices[entry] * numberOfAttributes;
+            double squaredDistance = 0;
+            for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+                const double difference = datumValues[attribute] - centre[attribute];
+                squaredDistance += difference * difference;
+            }
+            reciprocals[entry - firstEntry] = reciprocalOfDistance(squaredDistance);
+            reciprocalSum += reciprocals[entry - firstEntry];
+        }
+        for (std::size_t entry = firstEntry; entry < lastEntry; ++entry) {
+            const double membership = reciprocals[entry - firstEntry] / reciprocalSum;
+            const double change = membership - sparseMemberships.memberships[entry];
+            squaredChange += change * change;
+            sparseMemberships.memberships[entry] = membership;
+        }
+    }
+    return squaredChange;
+}
+
+double SparseFuzzyCMeans::reciprocalOfDistance(double squaredDistance) const {
+    const double distance = std::max(squaredDistance, SimdKernels::MINIMAL_DISTANCE);
+    return fuzzification == 2.0 ? 1.0 / distance : std::pow(distance, -1.0 / (fuzzification - 1.0));
+}
@@ -0,0 +1,62 @@
+#include "concurrency/ThreadPool.hpp"
+
+bool ThreadPool::LowerPriority::operator()(const QueuedTask& first, const QueuedTask& second) const {
+    if (first.expectedCost != second.expectedCost) {
+        return first.expectedCost < second.expectedCost;
+    }
+    return first.sequenceNumber > second.sequenceNumber;
+}
+
+ThreadPool::ThreadPool(unsigned int numberOfThreads) {
+    if (numberOfThreads == 0) {
+        numberOfThreads = defaultNumberOfThreads();
+    }
+    workers.reserve(numberOfThreads);
+    for (unsigned int i = 0; i < numberOfThreads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    tasksAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::getNumberOfThreads() const {
+    return (unsigned int) workers.size();
+}
+
+unsigned int ThreadPool::defaultNumberOfThreads() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads == 0 ? 1 : hardwareThreads;
+}
+
+void ThreadPool::enqueue(std::function<void()>&& task, double expectedCost) {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push(QueuedTask{expectedCost, submittedTasks++, std::move(task)});
+    }
+    tasksAvailable.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(const_cast<QueuedTask&>(tasks.top()).task);
+            tasks.pop();
+        }
+        task();
+    }
+}
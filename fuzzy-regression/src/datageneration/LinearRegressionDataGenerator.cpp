@@ -1,40 +1,66 @@
+#include <random>
+#include <stdexcept>
+
 #include "datageneration/LinearRegressionDataGenerator.hpp"
 
+namespace {
+    std::uint64_t drawRandomSeed() {
+        std::random_device randomDevice;
+        return ((std::uint64_t) randomDevice() << 32) | randomDevice();
+    }
+}
+
 LinearRegressionDataGenerator::LinearRegressionDataGenerator(const std::vector<double> &&slopeParameters,
                                                              const std::vector<double> &&slopeDeviations,
                                                              double interceptDeviation,
                                                              double domainMaxValue)
-        : slopeParameters(slopeParameters),
-          mersenneTwisterGenerator(std::mt19937(std::random_device()())),
-          uniformRealDistributionForIntercept(std::uniform_real_distribution<double>(-interceptDeviation, interceptDeviation)),
-          uniformRealDistributionsForDeviation(generateDistributionsForSlopeDeviations(slopeDeviations)),
-          uniformRealDistributionForDomain(std::uniform_real_distribution<double>(0, domainMaxValue)){
+        : LinearRegressionDataGenerator(std::move(slopeParameters),
+                                        std::move(slopeDeviations),
+                                        interceptDeviation,
+                                        domainMaxValue,
+                                        drawRandomSeed()){}
+
+LinearRegressionDataGenerator::LinearRegressionDataGenerator(const std::vector<double> &&slopeParameters,
+                                                             const std::vector<double> &&slopeDeviations,
+                                                             double interceptDeviation,
+                                                             double domainMaxValue,
+                                                             std::uint64_t seed)
+        : randomNumberGenerator(seed),
+          slopeParameters(slopeParameters),
+          slopeDeviations(slopeDeviations),
+          interceptDeviation(interceptDeviation),
+          domainMaxValue(domainMaxValue){
     if(slopeParameters.size() != slopeDeviations.size()){
-        throw "Incompatible number of parameters and deviations";
+        throw std::invalid_argument("Incompatible number of parameters and deviations");
     }
 }
 
-std::vector<std::uniform_real_distribution<double>>
-LinearRegressionDataGenerator::generateDistributionsForSlopeDeviations(const std::vector<double>& slopeDeviationsVector){
-    std::vector<std::uniform_real_distribution<double>> distributions(slopeDeviationsVector.size());
-    for (const auto &deviation : slopeDeviationsVector){
-        distributions.emplace_back(-deviation, deviation);
-    }
-    return distributions;
+std::vector<double> LinearRegressionDataGenerator::generateTupleValue() {
+    std::vector<double> describingAndDescribedParameters(getNumberOfAttributes());
+    generateTuples(nextTupleNumber++, 1, describingAndDescribedParameters.data());
+    return describingAndDescribedParameters;
 }
 
-std::vector<double> LinearRegressionDataGenerator::generateTupleValue() {
-    unsigned long describingValueAmount = slopeParameters.size();
-    std::vector<double> describingAndDescribedParameters(describingValueAmount + 1);
-    double describedValue = 0;
-    for (int i = 0; i < describingValueAmount; ++i) {
-        double x = uniformRealDistributionForDomain(mersenneTwisterGenerator);
-        auto distribution = uniformRealDistributionsForDeviation[i];
-        double ithDescribingParameterValue = (slopeParameters[i] * x) + distribution(mersenneTwisterGenerator);
-        describedValue += ithDescribingParameterValue;
-        describingAndDescribedParameters[i] = x;
+void LinearRegressionDataGenerator::generateTuples(std::size_t firstTupleNumber,
+                                                   std::size_t numberOfTuples,
+                                                   double* output) const {
+    const std::size_t describingValueAmount = slopeParameters.size();
+    for (std::size_t tupleNumber = firstTupleNumber; tupleNumber < firstTupleNumber + numberOfTuples; ++tupleNumber) {
+        // every describing value uses one block of random bits: its domain value and its deviation
+        double describedValue = 0;
+        for (std::size_t i = 0; i < describingValueAmount; ++i) {
+            const auto [domainSample, deviationSample] = randomNumberGenerator.uniformPair(tupleNumber, (std::uint32_t) i);
+            const double x = domainSample * domainMaxValue;
+            describedValue += slopeParameters[i] * x + (2 * deviationSample - 1) * slopeDeviations[i];
+            output[i] = x;
+        }
+        const double interceptSample = randomNumberGenerator.uniformPair(tupleNumber, (std::uint32_t) describingValueAmount)[0];
+        describedValue += (2 * interceptSample - 1) * interceptDeviation;
+        output[describingValueAmount] = describedValue;
+        output += describingValueAmount + 1;
     }
-    describedValue += uniformRealDistributionForIntercept(mersenneTwisterGenerator);
-    describingAndDescribedParameters[describingValueAmount] = describedValue;
-    return describingAndDescribedParameters;
+}
+
+std::size_t LinearRegressionDataGenerator::getNumberOfAttributes() const {
+    return slopeParameters.size() + 1;
 }
@@ -1,5 +1,12 @@
+#include <atomic>
 #include <cstring>
+#include <map>
+#include <set>
+#include <thread>
 
+#include "concurrency/BoundedQueue.hpp"
+#include "streams/BatchSource.hpp"
+#include "streams/TupleReader.hpp"
 #include "streams/TupleWriter.hpp"
 #include "readers/reader-complete.h"
 #include "regression/FuzzyRegression.hpp"
@@ -8,7 +15,17 @@
 
 Program::Program(int argument_count, char** argument_values)
 : arguments(generateArgumentSet(argument_count, argument_values)),
-MAX_PRECISION_COUT(std::setprecision(std::numeric_limits<long double>::digits10 + 1)){}
+MAX_PRECISION_COUT(std::setprecision(std::numeric_limits<long double>::digits10 + 1)),
+clusteringEngine(chooseClusteringEngine()),
+streaming(arguments.find("-streaming") != arguments.end()),
+coresetSize(streaming ? 0 : findUnsignedArgumentValue("-coreset", 0)),
+clusterCountSearchMode(chooseClusterCountSearchMode()),
+resultCache(createResultCache()),
+sweepThreadPool(createSweepThreadPool()),
+parsingThreadPool(createParsingThreadPool()),
+shardCoordinator(createShardCoordinator(argument_count > 0 ? argument_values[0] : "")),
+maximalNumberOfResidentDatasets(std::max(1u, findUnsignedArgumentValue("-residentfiles",
+                                                                       DEFAULT_NUMBER_OF_RESIDENT_DATASETS))){}
 
 int Program::run() {
     if (!arguments.empty()){
@@ -23,7 +40,38 @@ std::unordered_set<std::string> Program::generateArgumentSet(int argumentCount,
                   << "Provide correct for program to run\n"
                   << "To generate test data add -generate argument\n"
                   << "To run FCM algorithm and regression add -process argument\n"
+                  << "To convert text data files into memory-mapped binary columnar files add -convert argument\n"
+                  << "To answer regression jobs from standard input add -serve argument, -serve=PATH for a Unix socket\n"
                   << "Modes can be combined\n"
+                  << "To cluster with the built-in vectorised FCM instead of ksi::fcm add -native argument\n"
+                  << "To sweep cluster counts on N threads add -threads=N argument (0 uses all cores)\n"
+                  << "To set the number of file reading threads add -readers=N argument\n"
+                  << "To set the number of files processed at once add -compute=N argument\n"
+                  << "To set how many files may wait between pipeline stages add -queue=N argument\n"
+                  << "To limit the threads parsing one text file add -parsethreads=N argument\n"
+                  << "To check the checksum of binary files before processing them add -verify argument\n"
+                  << "To generate the same data on every run add -seed=N argument\n"
+                  << "To set the number of generated tuples in every file add -tuples=N argument\n"
+                  << "To seed every cluster count with the result for one cluster less add -warmstart argument\n"
+                  << "To cluster files batch by batch without holding them in memory add -streaming argument\n"
+                  << "To set the datums in a batch of -streaming add -batch=N argument\n"
+                  << "To set the passes over the file of -streaming add -epochs=N argument\n"
+                  << "To stop the sweep once the regression error stops improving add -adaptive argument\n"
+                  << "To search a coarse grid of cluster counts and refine around its best add -coarsetofine argument\n"
+                  << "To set the relative improvement that still counts add -searchtolerance=X argument (default 0.01)\n"
+                  << "To set the counts without improvement that end -adaptive add -searchwindow=N argument (default 3)\n"
+                  << "To keep results of unchanged files between runs add -cache or -cache=DIR argument\n"
+                  << "To bound the size of the result cache add -cachesize=MB argument (default 256)\n"
+                  << "To set how many data files -serve keeps in memory add -residentfiles=N argument (default 4)\n"
+                  << "To cluster a weighted sample of M draws from every file add -coreset=M argument\n"
+                  << "To keep only the K highest memberships of every datum add -sparse=K argument\n"
+                  << "To keep only memberships of at least X add -sparsethreshold=X argument\n"
+                  << "To run FCM in single precision with a double-precision polish add -mixed argument\n"
+                  << "To run the cluster counts in N local worker processes add -workers=N argument\n"
+                  << "To set the threads of every worker add -workerthreads=T argument\n"
+                  << "To record durations and counters of the hot paths add -telemetry=csv|jsonl|chrome argument\n"
+                  << "To set the file telemetry is written to add -telemetryoutput=PATH argument\n"
+                  << "To score every model on the whole data file add -evaluate argument\n"
                   << "Data files should be contained in \"data\" folder relative to program location\n";
         return {};
     }
@@ -35,13 +83,228 @@ std::unordered_set<std::string> Program::generateArgumentSet(int argumentCount,
     return argumentSet;
 }
 
+ClusteringEngine Program::chooseClusteringEngine() const {
+    if (arguments.find("-native") != arguments.end() || requiresNativeEngine()) {
+        return ClusteringEngine::NATIVE;
+    }
+    return ClusteringEngine::KSI;
+}
+
+bool Program::requiresNativeEngine() const {
+    return arguments.find("-warmstart") != arguments.end()
+           || arguments.find("-streaming") != arguments.end()
+           || findArgumentValue("-coreset").has_value()
+           || findArgumentValue("-sparse").has_value()
+           || findArgumentValue("-sparsethreshold").has_value()
+           || arguments.find("-mixed") != arguments.end();
+}
+
+ClusterCountSearchMode Program::chooseClusterCountSearchMode() const {
+    if (arguments.find("-coarsetofine") != arguments.end()) {
+        return ClusterCountSearchMode::COARSE_TO_FINE;
+    }
+    if (arguments.find("-adaptive") != arguments.end()) {
+        return ClusterCountSearchMode::PLATEAU;
+    }
+    return ClusterCountSearchMode::FULL_SWEEP;
+}
+
+std::optional<std::string> Program::findArgumentValue(const std::string& argumentName) const {
+    const std::string prefix = argumentName + "=";
+    for (const auto& argument : arguments) {
+        if (argument.compare(0, prefix.size(), prefix) == 0) {
+            return argument.substr(prefix.size());
+        }
+    }
+    return std::nullopt;
+}
+
+unsigned int Program::findUnsignedArgumentValue(const std::string& argumentName, unsigned int defaultValue) const {
+    auto argumentValue = findArgumentValue(argumentName);
+    if (!argumentValue.has_value()) {
+        return defaultValue;
+    }
+    try {
+        return (unsigned int) std::stoul(*argumentValue);
+    } catch (const std::exception&) {
+        std::cout << "Ignoring malformed " << argumentName << " value \"" << *argumentValue << "\"\n";
+        return defaultValue;
+    }
+}
+
+std::optional<std::uint64_t> Program::findUnsigned64ArgumentValue(const std::string& argumentName) const {
+    auto argumentValue = findArgumentValue(argumentName);
+    if (!argumentValue.has_value()) {
+        return std::nullopt;
+    }
+    try {
+        return (std::uint64_t) std::stoull(*argumentValue);
+    } catch (const std::exception&) {
+        std::cout << "Ignoring malformed " << argumentName << " value \"" << *argumentValue << "\"\n";
+        return std::nullopt;
+    }
+}
+
+double Program::findDoubleArgumentValue(const std::string& argumentName, double defaultValue) const {
+    auto argumentValue = findArgumentValue(argumentName);
+    if (!argumentValue.has_value()) {
+        return defaultValue;
+    }
+    try {
+        return std::stod(*argumentValue);
+    } catch (const std::exception&) {
+        std::cout << "Ignoring malformed " << argumentName << " value \"" << *argumentValue << "\"\n";
+        return defaultValue;
+    }
+}
+
+bool Program::isWarmStartSweep() const {
+    // streamed and coreset clustering keep no partition matrix of the data to split the worst-fitting cluster with
+    return arguments.find("-warmstart") != arguments.end() && !streaming && coresetSize == 0 && !isSparseClustering()
+           && !isMixedPrecisionClustering();
+}
+
+bool Program::isSparseClustering() const {
+    return !streaming && coresetSize == 0
+           && (findArgumentValue("-sparse").has_value() || findArgumentValue("-sparsethreshold").has_value());
+}
+
+bool Program::isMixedPrecisionClustering() const {
+    return arguments.find("-mixed") != arguments.end() && !streaming && coresetSize == 0 && !isSparseClustering();
+}
+
+std::unique_ptr<ThreadPool> Program::createSweepThreadPool() const {
+    // -serve runs the cluster counts of all its jobs on this pool, on all cores unless -threads says otherwise
+    const bool serving = isServing();
+    unsigned int numberOfThreads = findUnsignedArgumentValue("-threads", serving ? 0 : 1);
+    if (numberOfThreads == 1 && !serving) {
+        return nullptr;
+    }
+    return std::make_unique<ThreadPool>(numberOfThreads);
+}
+
+std::unique_ptr<ThreadPool> Program::createParsingThreadPool() const {
+    if (sweepThreadPool != nullptr) {
+        return nullptr;
+    }
+    // the reader parsing a file is one of the threads
+    const unsigned int numberOfThreads = findUnsignedArgumentValue("-parsethreads", 0);
+    const unsigned int numberOfHelpers = (numberOfThreads == 0 ? ThreadPool::defaultNumberOfThreads() : numberOfThreads) - 1;
+    if (numberOfHelpers == 0) {
+        return nullptr;
+    }
+    return std::make_unique<ThreadPool>(numberOfHelpers);
+}
+
+TupleReader Program::createTupleReader() const {
+    // readers running at once and the cluster counts of the sweep pool share its threads instead of adding their own
+    return TupleReader(sweepThreadPool != nullptr ? sweepThreadPool.get() : parsingThreadPool.get(),
+                       findUnsignedArgumentValue("-parsethreads", 0));
+}
+
+std::unique_ptr<ResultCache> Program::createResultCache() const {
+    const unsigned int DEFAULT_CACHE_SIZE_IN_MEGABYTES = 256;
+    const std::optional<std::string> cacheDirectory = findArgumentValue("-cache");
+    if (arguments.find("-cache") == arguments.end() && !cacheDirectory.has_value()) {
+        return nullptr;
+    }
+    const std::uintmax_t maximalSizeInBytes =
+            (std::uintmax_t) findUnsignedArgumentValue("-cachesize", DEFAULT_CACHE_SIZE_IN_MEGABYTES) << 20;
+    try {
+        return std::make_unique<ResultCache>(cacheDirectory.value_or("cache"), maximalSizeInBytes);
+    } catch (const std::exception& exception) {
+        std::cout << "Could not open result cache, results are not cached: " << exception.what() << "\n";
+        return nullptr;
+    }
+}
+
+std::unique_ptr<ShardCoordinator> Program::createShardCoordinator(const std::string& programPath) const {
+    const unsigned int numberOfWorkers = findUnsignedArgumentValue("-workers", 0);
+    if (numberOfWorkers == 0 || arguments.find("-process") == arguments.end()) {
+        return nullptr;
+    }
+    const unsigned int numberOfThreads = findUnsignedArgumentValue(
+            "-workerthreads", std::max(1u, ThreadPool::defaultNumberOfThreads() / numberOfWorkers));
+    if (arguments.find("-warmstart") != arguments.end()) {
+        std::cout << "Cluster counts run independently in the workers, -warmstart is ignored\n";
+    }
+    const std::vector<std::string> workerArguments = createWorkerArguments(programPath, numberOfThreads);
+    // every worker runs as many shards at once as it has threads
+    return std::make_unique<ShardCoordinator>(numberOfWorkers, numberOfThreads, [workerArguments](unsigned int) {
+        return std::make_unique<LocalWorkerProcess>(workerArguments);
+    });
+}
+
+std::vector<std::string> Program::createWorkerArguments(const std::string& programPath,
+                                                        unsigned int numberOfThreads) const {
+    const std::vector<std::string> FORWARDED_OPTIONS = {"-native", "-streaming", "-batch", "-epochs", "-coreset",
+                                                        "-sparse", "-sparsethreshold", "-mixed", "-cache",
+                                                        "-cachesize", "-parsethreads", "-verify", "-residentfiles"};
+    // a relative program path would be looked up in the working directory anyway, the link is exact
+    const std::filesystem::path PROCESS_EXECUTABLE_LINK("/proc/self/exe");
+    std::vector<std::string> workerArguments{std::filesystem::exists(PROCESS_EXECUTABLE_LINK)
+                                             ? std::filesystem::read_symlink(PROCESS_EXECUTABLE_LINK).string()
+                                             : programPath,
+                                             "-serve",
+                                             "-threads=" + std::to_string(numberOfThreads)};
+    for (const auto& argument : arguments) {
+        const std::string option = argument.substr(0, argument.find('='));
+        if (std::find(FORWARDED_OPTIONS.begin(), FORWARDED_OPTIONS.end(), option) != FORWARDED_OPTIONS.end()) {
+            workerArguments.push_back(argument);
+        }
+    }
+    return workerArguments;
+}
+
+std::optional<TelemetryFormat> Program::chooseTelemetryFormat() const {
+    const std::optional<std::string> formatName = findArgumentValue("-telemetry");
+    if (arguments.find("-telemetry") == arguments.end() && !formatName.has_value()) {
+        return std::nullopt;
+    }
+    if (!Telemetry::isCompiledIn()) {
+        std::cout << "Telemetry was compiled out (FUZZY_REGRESSION_TELEMETRY is off), ignoring -telemetry\n";
+        return std::nullopt;
+    }
+    try {
+        return Telemetry::parseFormat(formatName.value_or("csv"));
+    } catch (const std::invalid_argument& exception) {
+        std::cout << "Ignoring malformed -telemetry value: " << exception.what() << "\n";
+        return std::nullopt;
+    }
+}
+
+void Program::writeTelemetry(const Telemetry& telemetry, TelemetryFormat format) const {
+    const std::filesystem::path outputPath = findArgumentValue("-telemetryoutput")
+            .value_or("telemetry" + Telemetry::fileExtension(format));
+    std::ofstream outputStream(outputPath);
+    if (!outputStream) {
+        std::cout << "Could not write telemetry to " << outputPath.string() << "\n";
+        return;
+    }
+    telemetry.write(outputStream, format);
+}
+
 int Program::runMainProgram() {
+    const std::optional<TelemetryFormat> telemetryFormat = chooseTelemetryFormat();
+    std::optional<Telemetry> telemetry;
+    if (telemetryFormat.has_value()) {
+        telemetry.emplace();
+    }
     if (auto generationArgumentIterator = arguments.find("-generate"); generationArgumentIterator != arguments.end()) {
         generateTestData();
     }
+    if (auto convertArgumentIterator = arguments.find("-convert"); convertArgumentIterator != arguments.end()) {
+        convertData();
+    }
     if (auto processArgumentIterator = arguments.find("-process"); processArgumentIterator != arguments.end()){
         processData();
     }
+    if (isServing()) {
+        serveJobs();
+    }
+    if (telemetry.has_value()) {
+        writeTelemetry(*telemetry, *telemetryFormat);
+    }
     return 0;
 }
 
@@ -50,50 +313,60 @@ void Program::generateTestData() {
     if (!std::filesystem::exists(dataPath)) {
         std::filesystem::create_directories(dataPath);
     }
+    // with -seed=N every file is generated from its own seed derived from N, so the data can be generated again
+    const std::optional<std::uint64_t> seed = findUnsigned64ArgumentValue("-seed");
+    auto createGenerator = [&seed](std::vector<double>&& slopeParameters,
+                                   std::vector<double>&& slopeDeviations,
+                                   std::uint64_t fileNumber) {
+        return seed.has_value()
+                ? LinearRegressionDataGenerator(std::move(slopeParameters), std::move(slopeDeviations), 2.0, 1000.0,
+                                                *seed + fileNumber)
+                : LinearRegressionDataGenerator(std::move(slopeParameters), std::move(slopeDeviations), 2.0, 1000.0);
+    };
+    const unsigned int numberOfTuplesOverride = findUnsignedArgumentValue("-tuples", 0);
+    auto numberOfTuples = [numberOfTuplesOverride](std::size_t defaultNumberOfTuples) {
+        return numberOfTuplesOverride == 0 ? defaultNumberOfTuples : (std::size_t) numberOfTuplesOverride;
+    };
     {
-        auto generatorForFiveDescriptionVariables = LinearRegressionDataGenerator(
+        auto generatorForFiveDescriptionVariables = createGenerator(
                 std::vector<double>(std::initializer_list<double>{5.0, 3.0, 4.0, 5.0, 3.0}),
                 std::vector<double>(std::initializer_list<double>{0.001, 0.003, 0.004, 0.005, 0.003}),
-                2.0,
-                1000.0);
+                0);
 
-        auto tupleWriter = TupleWriter(generatorForFiveDescriptionVariables, 1000);
+        auto tupleWriter = TupleWriter(generatorForFiveDescriptionVariables, numberOfTuples(1000));
         tupleWriter.generateTuplesAndSaveWithFilename(
                 dataPath / "fiveDescriptionVariables.txt"
         );
     }
     {
-        auto generatorForTenDescriptionVariables = LinearRegressionDataGenerator(
+        auto generatorForTenDescriptionVariables = createGenerator(
                 std::vector<double>(std::initializer_list<double>{5.0, -23.0, 4.0, -8.0, 3.0, 53.1, 0.2, -1337.3, 90.0, 123.0}),
                 std::vector<double>(std::initializer_list<double>{0.001, 0.003, 0.004, 0.005, 0.003, 0.001, 0.001, 0.001, 0.001, 0.001}),
-                2.0,
-                1000.0);
+                1);
 
-        auto tupleWriter = TupleWriter(generatorForTenDescriptionVariables, 1000);
+        auto tupleWriter = TupleWriter(generatorForTenDescriptionVariables, numberOfTuples(1000));
         tupleWriter.generateTuplesAndSaveWithFilename(
                 dataPath/"tenDescriptionVariables.txt"
         );
     }
     {
-        auto generatorForTwoDescriptionVariables = LinearRegressionDataGenerator(
+        auto generatorForTwoDescriptionVariables = createGenerator(
                 std::vector<double>(std::initializer_list<double>{0.2, -1337.3}),
                 std::vector<double>(std::initializer_list<double>{0.001, 0.003}),
-                2.0,
-                1000.0);
+                2);
 
-        auto tupleWriter = TupleWriter(generatorForTwoDescriptionVariables, 400);
+        auto tupleWriter = TupleWriter(generatorForTwoDescriptionVariables, numberOfTuples(400));
         tupleWriter.generateTuplesAndSaveWithFilename(
                 dataPath/"twoDescriptionVariables.txt"
         );
     }
     {
-        auto generatorForFourDescriptionVariables = LinearRegressionDataGenerator(
+        auto generatorForFourDescriptionVariables = createGenerator(
                 std::vector<double>(std::initializer_list<double>{3.0, 53.1, 90.0, 123.0}),
                 std::vector<double>(std::initializer_list<double>{0.001, 0.003, 0.004, 0.005}),
-                2.0,
-                1000.0);
+                3);
 
-        auto tupleWriter = TupleWriter(generatorForFourDescriptionVariables, 300);
+        auto tupleWriter = TupleWriter(generatorForFourDescriptionVariables, numberOfTuples(300));
         tupleWriter.generateTuplesAndSaveWithFilename(
                 dataPath/"fourDescriptionVariables.txt"
         );
@@ -113,10 +386,123 @@ void Program::processData() {
     if(!std::filesystem::exists(resultsPath)){
         std::filesystem::create_directories(resultsPath);
     }
+    const std::vector<std::filesystem::path> dataFilePaths = listDataFiles(dataPath);
+
+    // reader stage parses files ahead of the compute stage, writer stage owns all output files,
+    // the queues bound how many parsed datasets and finished sweeps are held in memory at once
+    const unsigned int numberOfReaders = std::max(1u, findUnsignedArgumentValue("-readers", 1));
+    const unsigned int numberOfComputeStages = std::max(1u, findUnsignedArgumentValue("-compute", 1));
+    const unsigned int queueCapacity = std::max(1u, findUnsignedArgumentValue("-queue", 2));
+    BoundedQueue<LoadedDataset> loadedDatasets(queueCapacity);
+    BoundedQueue<FileSweepResult> sweepResults(queueCapacity);
+    std::atomic<std::size_t> nextDataFileIndex(0);
+
+    std::thread writer([this, &sweepResults, &resultsPath]() {
+        while (auto sweepResult = sweepResults.pop()) {
+            writeSweepResult(*sweepResult, resultsPath);
+        }
+    });
+    std::vector<std::thread> computeStages;
+    for (unsigned int i = 0; i < numberOfComputeStages; ++i) {
+        computeStages.emplace_back([this, &loadedDatasets, &sweepResults]() {
+            while (auto loadedDataset = loadedDatasets.pop()) {
+                try {
+                    sweepResults.push(sweepDataset(*loadedDataset));
+                } catch (const std::exception& exception) {
+                    std::cout << "Processing of " << loadedDataset->fileStem << " failed: " << exception.what() << "\n";
+                }
+            }
+        });
+    }
+    std::vector<std::thread> readers;
+    for (unsigned int i = 0; i < numberOfReaders; ++i) {
+        readers.emplace_back([this, &dataFilePaths, &nextDataFileIndex, &loadedDatasets]() {
+            for (std::size_t index = nextDataFileIndex++; index < dataFilePaths.size(); index = nextDataFileIndex++) {
+                auto loadedDataset = loadDataset(dataFilePaths[index], clusteringEngine);
+                if (loadedDataset.has_value()) {
+                    loadedDatasets.push(std::move(*loadedDataset));
+                }
+            }
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    loadedDatasets.close();
+    for (auto& computeStage : computeStages) {
+        computeStage.join();
+    }
+    sweepResults.close();
+    writer.join();
+    if (resultCache != nullptr) {
+        resultCache->evictLeastRecentlyUsed();
+    }
+}
+
+std::vector<std::filesystem::path> Program::listDataFiles(const std::filesystem::path& dataPath) const {
+    std::vector<std::filesystem::path> directoryFilePaths;
     auto dataDirectoryIterator = std::filesystem::directory_iterator(dataPath);
     for(auto const& directoryEntry: dataDirectoryIterator){
         if (!directoryEntry.is_directory()){
-            processSingleFile(directoryEntry, resultsPath);
+            directoryFilePaths.push_back(directoryEntry.path());
+        }
+    }
+    // a text file converted with -convert is processed from its binary counterpart, unless it changed since
+    std::set<std::filesystem::path> skippedFilePaths;
+    for (const auto& dataFilePath : directoryFilePaths) {
+        auto columnarFilePath = std::filesystem::path(dataFilePath).replace_extension(ColumnarDatasetFile::FILE_EXTENSION);
+        if (ColumnarDatasetFile::isColumnarDatasetFile(dataFilePath) || !std::filesystem::exists(columnarFilePath)) {
+            continue;
+        }
+        if (isUpToDateConversion(columnarFilePath, dataFilePath)) {
+            skippedFilePaths.insert(dataFilePath);
+        } else {
+            std::cout << columnarFilePath.string() << " is not a conversion of the current " << dataFilePath.string()
+                      << ", processing the text file\n";
+            skippedFilePaths.insert(columnarFilePath);
+        }
+    }
+    std::vector<std::filesystem::path> dataFilePaths;
+    for (const auto& dataFilePath : directoryFilePaths) {
+        if (skippedFilePaths.find(dataFilePath) == skippedFilePaths.end()) {
+            dataFilePaths.push_back(dataFilePath);
+        }
+    }
+    return dataFilePaths;
+}
+
+bool Program::isUpToDateConversion(const std::filesystem::path& columnarFilePath,
+                                   const std::filesystem::path& dataFilePath) {
+    try {
+        return ColumnarDatasetFile(columnarFilePath).isConvertedFrom(dataFilePath);
+    } catch (const std::exception&) {
+        // unreadable or written by an older version
+        return false;
+    }
+}
+
+void Program::convertData() {
+    auto dataPath = std::filesystem::path("data");
+    auto dataDirectoryIterator = std::filesystem::directory_iterator(dataPath);
+    for(auto const& directoryEntry: dataDirectoryIterator){
+        const auto& dataFilePath = directoryEntry.path();
+        if (directoryEntry.is_directory() || ColumnarDatasetFile::isColumnarDatasetFile(dataFilePath)){
+            continue;
+        }
+        auto columnarFilePath = std::filesystem::path(dataFilePath).replace_extension(ColumnarDatasetFile::FILE_EXTENSION);
+        try {
+            const ColumnarDatasetSource source = ColumnarDatasetSource::describe(dataFilePath);
+            const TupleReader tupleReader = createTupleReader();
+            const ParsedTuples parsedTuples = tupleReader.read(dataFilePath);
+            ColumnarDatasetFile::write(columnarFilePath, parsedTuples.getAttributeMajorData(), source);
+            // reading every page back is affordable here, -process only maps the pages it touches
+            if (!ColumnarDatasetFile(columnarFilePath).hasValidChecksum()) {
+                throw std::runtime_error("the written file does not match its checksum");
+            }
+            std::cout << "Converted " << dataFilePath.string() << " to " << columnarFilePath.string() << "\n";
+        } catch (const std::exception& exception) {
+            std::cout << "Could not convert " << dataFilePath.string() << ": " << exception.what() << "\n";
         }
     }
 }
@@ -134,23 +520,295 @@ std::string Program::printTime(const std::tm* timeStruct) {
     return outputStringStream.str();
 }
 
-void Program::processSingleFile(const std::filesystem::directory_entry& testDataDirectoryEntry,
-                                const std::filesystem::path& resultPath) {
-    const std::string& testFileStem = testDataDirectoryEntry.path().stem().string();
+bool Program::isServing() const {
+    return arguments.find("-serve") != arguments.end() || findArgumentValue("-serve").has_value();
+}
+
+void Program::serveJobs() {
+    // concurrent jobs and the parsing of their files share the sweep pool, which always exists when serving
+    JobServer jobServer(*sweepThreadPool,
+                        [this](const RegressionJob& job) { return prepareServedJob(job); },
+                        [this](const RegressionJob&) { finishServedJob(); });
+    const std::optional<std::string> socketPath = findArgumentValue("-serve");
+    if (socketPath.has_value()) {
+        try {
+            std::cout << "Serving regression jobs on " << *socketPath << std::endl;
+            jobServer.serveSocket(*socketPath);
+        } catch (const std::exception& exception) {
+            std::cout << "Could not serve regression jobs: " << exception.what() << "\n";
+        }
+        return;
+    }
+    // answers own standard output, messages printed while loading files go to standard error instead
+    std::ostream responseStream(std::cout.rdbuf());
+    std::streambuf* const standardOutputBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+    jobServer.serveStream(std::cin, responseStream);
+    std::cout.rdbuf(standardOutputBuffer);
+}
+
+JobServer::ClusterCountRunner Program::prepareServedJob(const RegressionJob& job) const {
+    const ClusteringEngine datasetEngine = job.clusteringEngine.value_or(clusteringEngine);
+    if (datasetEngine == ClusteringEngine::KSI && requiresNativeEngine()) {
+        throw std::invalid_argument("The server was started with options which need the native engine");
+    }
+    // relative paths name files in the data folder, like the files processed by -process
+    const std::filesystem::path dataFilePath = job.dataFilePath.is_absolute()
+            ? job.dataFilePath
+            : std::filesystem::path("data") / job.dataFilePath;
+    std::shared_ptr<ResidentDataset> residentDataset = findResidentDataset(dataFilePath, datasetEngine);
+    // rejected before any count is queued, every count above the number of data would only fail
+    if ((std::size_t) job.lastNumberOfClusters > residentDataset->loadedDataset->numberOfData) {
+        throw std::invalid_argument("Number of clusters has to be not greater than number of data ("
+                                    + std::to_string(residentDataset->loadedDataset->numberOfData) + ")");
+    }
+    const double epsilon = job.epsilon.value_or(FuzzyRegression::EPSILON_DEFAULT_VALUE);
+    return [this, residentDataset, epsilon](int numberOfClusters) {
+        const std::pair<int, double> clusterRunKey(numberOfClusters, epsilon);
+        {
+            std::lock_guard<std::mutex> lock(residentDataset->clusterRunsMutex);
+            const auto residentClusterRun = residentDataset->clusterRuns.find(clusterRunKey);
+            if (residentClusterRun != residentDataset->clusterRuns.end()) {
+                residentClusterRun->second.lastUse = ++residentDataset->clusterRunUses;
+                ServedClusterRun clusterRun = residentClusterRun->second.clusterRun;
+                clusterRun.servedFromCache = true;
+                return clusterRun;
+            }
+        }
+        // warm start needs the previous cluster count, cluster counts of served jobs run independently
+        const ClusterRunResult clusterRunResult = runSingleClusterCount(*residentDataset->loadedDataset,
+                                                                        numberOfClusters, nullptr, nullptr, epsilon);
+        ServedClusterRun clusterRun{clusterRunResult.regressionResult,
+                                    clusterRunResult.numberOfIterations,
+                                    clusterRunResult.servedFromCache,
+                                    clusterRunResult.performanceRecord};
+        std::lock_guard<std::mutex> lock(residentDataset->clusterRunsMutex);
+        auto& clusterRuns = residentDataset->clusterRuns;
+        if (clusterRuns.size() >= MAX_RESIDENT_CLUSTER_RUNS && clusterRuns.find(clusterRunKey) == clusterRuns.end()) {
+            clusterRuns.erase(std::min_element(clusterRuns.begin(), clusterRuns.end(),
+                                               [](const auto& first, const auto& second) {
+                                                   return first.second.lastUse < second.second.lastUse;
+                                               }));
+        }
+        clusterRuns.emplace(clusterRunKey, ResidentClusterRun{clusterRun, ++residentDataset->clusterRunUses});
+        return clusterRun;
+    };
+}
+
+void Program::finishServedJob() const {
+    // a long-running server would otherwise only grow its cache directory
+    if (resultCache != nullptr) {
+        resultCache->evictLeastRecentlyUsed();
+    }
+}
+
+std::shared_ptr<ResidentDataset> Program::findResidentDataset(const std::filesystem::path& dataFilePath,
+                                                              ClusteringEngine datasetEngine) const {
+    const std::filesystem::file_time_type modificationTime = std::filesystem::last_write_time(dataFilePath);
+    const std::string residentDatasetKey = std::filesystem::weakly_canonical(dataFilePath).string()
+                                           + (datasetEngine == ClusteringEngine::KSI ? ";ksi" : ";native");
+    std::shared_ptr<ResidentDataset> residentDataset;
+    {
+        std::lock_guard<std::mutex> lock(residentDatasetsMutex);
+        std::shared_ptr<ResidentDataset>& knownDataset = residentDatasets[residentDatasetKey];
+        if (knownDataset == nullptr || knownDataset->modificationTime != modificationTime) {
+            // jobs still running on the replaced dataset keep it alive until they finish
+            knownDataset = std::make_shared<ResidentDataset>();
+            knownDataset->modificationTime = modificationTime;
+        }
+        knownDataset->lastUse = ++residentDatasetUses;
+        residentDataset = knownDataset;
+        // dropped datasets stay alive until the jobs still running on them finish
+        while (residentDatasets.size() > maximalNumberOfResidentDatasets) {
+            residentDatasets.erase(std::min_element(residentDatasets.begin(), residentDatasets.end(),
+                                                    [](const auto& first, const auto& second) {
+                                                        return first.second->lastUse < second.second->lastUse;
+                                                    }));
+        }
+    }
+    std::lock_guard<std::mutex> lock(residentDataset->loadingMutex);
+    if (!residentDataset->loadedDataset.has_value()) {
+        residentDataset->loadedDataset = loadDataset(dataFilePath, datasetEngine);
+        if (!residentDataset->loadedDataset.has_value()) {
+            throw std::runtime_error("Could not read " + dataFilePath.string());
+        }
+    }
+    return residentDataset;
+}
+
+std::optional<LoadedDataset> Program::loadDataset(const std::filesystem::path& dataFilePath,
+                                                  ClusteringEngine datasetEngine) const {
+    FUZZY_REGRESSION_TELEMETRY_SCOPE("loadDataset");
+    try {
+        LoadedDataset loadedDataset{dataFilePath.stem().string(), dataFilePath, std::nullopt, {}, nullptr, {}, {}, 0, 0, 0, nullptr};
+        if (ColumnarDatasetFile::isColumnarDatasetFile(dataFilePath)) {
+            loadedDataset.columnarDatasetFile = std::make_shared<ColumnarDatasetFile>(dataFilePath);
+            if (arguments.find("-verify") != arguments.end()
+                && !loadedDataset.columnarDatasetFile->hasValidChecksum()) {
+                std::cout << "Checksum mismatch in " << dataFilePath.string() << ", skipping this file\n";
+                return std::nullopt;
+            }
+            if (datasetEngine == ClusteringEngine::KSI) {
+                std::cout << dataFilePath.string() << " is binary, it is clustered with the native engine\n";
+            }
+            loadedDataset.attributeMajorData = loadedDataset.columnarDatasetFile->getAttributeMajorData();
+        } else if (streaming || shardCoordinator != nullptr) {
+            // the workers parse the file themselves, only its shape is needed here
+            const TupleBatchReader tupleBatchReader(dataFilePath, 1);
+            loadedDataset.streamedFilePath = dataFilePath;
+            loadedDataset.attributeMajorData = MatrixView<const double>(nullptr,
+                                                                        tupleBatchReader.getNumberOfAttributes(),
+                                                                        tupleBatchReader.getNumberOfData(),
+                                                                        0);
+        } else if (datasetEngine == ClusteringEngine::NATIVE) {
+            const TupleReader tupleReader = createTupleReader();
+            ParsedTuples parsedTuples = tupleReader.read(dataFilePath);
+            loadedDataset.attributeMajorBuffer = std::move(parsedTuples.attributeMajorData);
+            loadedDataset.attributeMajorData = MatrixView<const double>::rowMajor(
+                    loadedDataset.attributeMajorBuffer.data(),
+                    parsedTuples.numberOfAttributes,
+                    parsedTuples.numberOfData);
+        } else {
+            ksi::reader_complete input;
+            ksi::dataset dataset = input.read(dataFilePath.string());
+            loadedDataset.attributeMajorData = MatrixView<const double>(nullptr,
+                                                                        dataset.getNumberOfAttributes(),
+                                                                        dataset.getNumberOfData(),
+                                                                        0);
+            loadedDataset.dataset = std::move(dataset);
+        }
+        loadedDataset.numberOfAttributes = loadedDataset.attributeMajorData.getNumberOfRows();
+        loadedDataset.numberOfData = loadedDataset.attributeMajorData.getNumberOfColumns();
+        if (coresetSize > 0 && shardCoordinator == nullptr) {
+            loadedDataset.coreset = std::make_shared<const Coreset>(
+                    Coreset::sample(loadedDataset.attributeMajorData, coresetSize));
+        }
+        if (resultCache != nullptr) {
+            // the header of a binary file carries the checksum of its columns
+            loadedDataset.contentHash = loadedDataset.columnarDatasetFile != nullptr
+                    ? ResultCache::hashBytes(reinterpret_cast<const char*>(&loadedDataset.columnarDatasetFile->getHeader()),
+                                             sizeof(ColumnarDatasetHeader))
+                    : ResultCache::hashFile(dataFilePath);
+        }
+        return loadedDataset;
+    } catch (const std::exception& exception) {
+        std::cout << "Could not read " << dataFilePath.string() << ": " << exception.what() << "\n";
+        return std::nullopt;
+    }
+}
+
+FileSweepResult Program::sweepDataset(const LoadedDataset& loadedDataset) const {
+    // for 1000 datums with 5 describing values this took processing from 1 to about 70 clusters with 5 increment
+    // took about 1-2 minutes, the bottleneck is FCM algorithm.doPartition(dataset)
+    const int MAX_CLUSTERS_AMOUNT = 50;
+
+    int maxNumberOfClusters = (int) (loadedDataset.numberOfData < MAX_CLUSTERS_AMOUNT ? loadedDataset.numberOfData : MAX_CLUSTERS_AMOUNT);
+    const bool parallelSweep = sweepThreadPool != nullptr && !isWarmStartSweep();
+    ClusterCountSearch clusterCountSearch(createClusterCountSearchSettings(loadedDataset, maxNumberOfClusters));
+    // keyed by cluster count, so both files keep the ascending layout whatever order the counts were evaluated in
+    std::map<int, ClusterRunResult> clusterRunResultsByCount;
+    std::optional<FuzzyPartition> previousPartition;
+    for (auto clusterCounts = clusterCountSearch.nextClusterCounts();
+         !clusterCounts.empty();
+         clusterCounts = clusterCountSearch.nextClusterCounts()) {
+        std::vector<ClusterRunResult> batchResults = shardCoordinator != nullptr
+                ? sweepClusterCountsOnWorkers(loadedDataset, clusterCounts)
+                : parallelSweep
+                ? sweepClusterCountsInParallel(loadedDataset, clusterCounts)
+                : sweepClusterCountsSequentially(loadedDataset, clusterCounts, previousPartition);
+        for (auto& clusterRunResult : batchResults) {
+            clusterCountSearch.reportRegressionError(clusterRunResult.numberOfClusters,
+                                                     clusterRunResult.regressionResult.coefficientOfDetermination);
+            clusterRunResultsByCount.emplace(clusterRunResult.numberOfClusters, std::move(clusterRunResult));
+        }
+    }
+    std::vector<ClusterRunResult> clusterRunResults;
+    clusterRunResults.reserve(clusterRunResultsByCount.size());
+    for (auto& [numberOfClusters, clusterRunResult] : clusterRunResultsByCount) {
+        clusterRunResults.push_back(std::move(clusterRunResult));
+    }
+    const std::optional<int> chosenNumberOfClusters = clusterCountSearchMode == ClusterCountSearchMode::FULL_SWEEP
+            ? std::nullopt
+            : clusterCountSearch.getChosenNumberOfClusters();
+    std::vector<ModelEvaluation> dataEvaluations = arguments.find("-evaluate") != arguments.end()
+            ? evaluateOnDataset(loadedDataset, clusterRunResults)
+            : std::vector<ModelEvaluation>();
+    return FileSweepResult{loadedDataset.fileStem, loadedDataset.numberOfAttributes, std::move(clusterRunResults),
+                           chosenNumberOfClusters, std::move(dataEvaluations)};
+}
+
+std::vector<ModelEvaluation> Program::evaluateOnDataset(const LoadedDataset& loadedDataset,
+                                                        const std::vector<ClusterRunResult>& clusterRunResults) const {
+    std::vector<RegressionModel> models;
+    models.reserve(clusterRunResults.size());
+    for (const auto& clusterRunResult : clusterRunResults) {
+        models.emplace_back(clusterRunResult.regressionResult);
+    }
+    std::vector<ModelEvaluation> dataEvaluations(models.size(), ModelEvaluation{0, 0.0, 0.0, 0.0});
+    // this runs on a pipeline stage, not on the sweep pool, so the pool can spread the datums of every batch
+    auto evaluateBatch = [this, &models, &dataEvaluations](const MatrixView<const double>& batch) {
+        for (std::size_t model = 0; model < models.size(); ++model) {
+            dataEvaluations[model].merge(models[model].evaluate(batch, sweepThreadPool.get()));
+        }
+    };
+    if (!loadedDataset.streamedFilePath.empty()) {
+        TupleBatchReader tupleBatchReader(loadedDataset.streamedFilePath,
+                                          findUnsignedArgumentValue("-batch", DEFAULT_BATCH_SIZE),
+                                          loadedDataset.numberOfData,
+                                          loadedDataset.numberOfAttributes);
+        for (auto batch = tupleBatchReader.nextBatch(); batch.getNumberOfColumns() > 0;
+             batch = tupleBatchReader.nextBatch()) {
+            evaluateBatch(batch);
+        }
+    } else if (loadedDataset.dataset.has_value()) {
+        const std::vector<double> attributeMajorBuffer = FuzzyCMeans::flattenDatasetByAttributes(*loadedDataset.dataset);
+        evaluateBatch(MatrixView<const double>::rowMajor(attributeMajorBuffer.data(),
+                                                         loadedDataset.numberOfAttributes,
+                                                         loadedDataset.numberOfData));
+    } else {
+        evaluateBatch(loadedDataset.attributeMajorData);
+    }
+    return dataEvaluations;
+}
+
+ClusterCountSearchSettings Program::createClusterCountSearchSettings(const LoadedDataset& loadedDataset,
+                                                                     int maxNumberOfClusters) const {
+    const double DEFAULT_SEARCH_TOLERANCE = 0.01;
+    const unsigned int DEFAULT_SEARCH_WINDOW = 3;
+    const int lastNumberOfClusters = maxNumberOfClusters - 1;
+    // with fewer centres than attributes the regression passes through every centre and its error is zero,
+    // so adaptive searches start where the error begins to say something about the fit
+    int firstNumberOfClusters = 2;
+    if (clusterCountSearchMode != ClusterCountSearchMode::FULL_SWEEP
+        && (int) loadedDataset.numberOfAttributes <= lastNumberOfClusters) {
+        firstNumberOfClusters = std::max(firstNumberOfClusters, (int) loadedDataset.numberOfAttributes);
+    }
+    double tolerance = findDoubleArgumentValue("-searchtolerance", DEFAULT_SEARCH_TOLERANCE);
+    if (!(tolerance >= 0 && tolerance < 1)) {
+        std::cout << "Search tolerance has to be in [0, 1), using " << DEFAULT_SEARCH_TOLERANCE << "\n";
+        tolerance = DEFAULT_SEARCH_TOLERANCE;
+    }
+    const int window = (int) std::max(1u, findUnsignedArgumentValue("-searchwindow", DEFAULT_SEARCH_WINDOW));
+    // parallel sweeps evaluate as many counts at once as there are workers, sequential ones a single count
+    const std::size_t batchSize = shardCoordinator != nullptr
+            ? shardCoordinator->getMaximalNumberOfShardsInFlight()
+            : sweepThreadPool != nullptr && !isWarmStartSweep()
+            ? sweepThreadPool->getNumberOfThreads()
+            : 1;
+    return ClusterCountSearchSettings{clusterCountSearchMode, firstNumberOfClusters, lastNumberOfClusters,
+                                      tolerance, window, batchSize};
+}
+
+void Program::writeSweepResult(const FileSweepResult& sweepResult, const std::filesystem::path& resultPath) {
+    const std::string& testFileStem = sweepResult.fileStem;
     const std::string performanceFileName = testFileStem + "_perf.txt";
     std::fstream performanceFile(resultPath / performanceFileName, std::ios::out);
     if (!performanceFile.is_open()){
-        std::cout << "Could not create performance file for " << testDataDirectoryEntry.path().string() << "\n";
+        std::cout << "Could not create performance file for " << testFileStem << "\n";
         std::cout << "Aborting processing of this file\n";
         std::cout << strerror(errno) << "\n";
         return;
     }
     printPerformanceFileHeader(performanceFile);
-    ksi::reader_complete input;
-    auto dataset = input.read(testDataDirectoryEntry.path());
-    // for 1000 datums with 5 describing values this took processing from 1 to about 70 clusters with 5 increment
-    // took about 1-2 minutes, the bottleneck is FCM algorithm.doPartition(dataset)
-    const int MAX_CLUSTERS_AMOUNT = 50;
 
     const std::string filename = testFileStem + "_results.txt";
     std::fstream regressionResultOutputFile((resultPath / filename).string(), std::ios::out);
@@ -159,53 +817,254 @@ void Program::processSingleFile(const std::filesystem::directory_entry& testData
         std::cout << strerror(errno) << "\n";
         return;
     }
-    printRegressionDataHeader(regressionResultOutputFile, dataset.getNumberOfAttributes());
-
-    unsigned long maxNumberOfClusters = dataset.getNumberOfData() < MAX_CLUSTERS_AMOUNT ? dataset.getNumberOfData() : MAX_CLUSTERS_AMOUNT;
-    for (int clusterSizeForIteration = 2; clusterSizeForIteration < maxNumberOfClusters; ++clusterSizeForIteration) {
-
-        auto fuzzyRegression = FuzzyRegression(dataset, clusterSizeForIteration);
-        auto regressionResults = fuzzyRegression.processDataset(performanceFile);
+    const bool withDataEvaluation = !sweepResult.dataEvaluations.empty();
+    printRegressionDataHeader(regressionResultOutputFile, sweepResult.numberOfAttributes, withDataEvaluation);
 
-        printRegressionData(regressionResultOutputFile, clusterSizeForIteration, regressionResults);
+    long totalNumberOfIterations = 0;
+    std::size_t numberOfCachedRuns = 0;
+    for (std::size_t index = 0; index < sweepResult.clusterRunResults.size(); ++index) {
+        const ClusterRunResult& clusterRunResult = sweepResult.clusterRunResults[index];
+        numberOfCachedRuns += clusterRunResult.servedFromCache ? 1 : 0;
+        performanceFile << clusterRunResult.performanceRecord;
+        printRegressionData(regressionResultOutputFile, clusterRunResult.numberOfClusters,
+                            clusterRunResult.regressionResult,
+                            withDataEvaluation ? &sweepResult.dataEvaluations[index] : nullptr);
+        totalNumberOfIterations += clusterRunResult.servedFromCache ? 0 : clusterRunResult.numberOfIterations;
+    }
+    if (resultCache != nullptr) {
+        std::cout << testFileStem << ": " << numberOfCachedRuns << " of " << sweepResult.clusterRunResults.size()
+                  << " cluster counts read from the result cache\n";
+    }
+    if (sweepResult.chosenNumberOfClusters.has_value()) {
+        regressionResultOutputFile << "Chosen cluster size;" << *sweepResult.chosenNumberOfClusters << "\n";
+        std::cout << testFileStem << ": chose " << *sweepResult.chosenNumberOfClusters << " clusters after "
+                  << sweepResult.clusterRunResults.size() << " cluster counts\n";
+    }
+    if (clusteringEngine == ClusteringEngine::NATIVE) {
+        std::cout << testFileStem << ": " << totalNumberOfIterations << " FCM iterations in cluster sweep\n";
     }
     regressionResultOutputFile.close();
     performanceFile.close();
 }
 
+ClusterRunResult Program::runSingleClusterCount(const LoadedDataset& loadedDataset,
+                                                int numberOfClusters,
+                                                const FuzzyPartition* warmStartPartition,
+                                                std::optional<FuzzyPartition>* convergedPartition,
+                                                double epsilon) const {
+    std::ostringstream performanceRecord;
+    // every run reads through a source of its own, so that cluster counts can be swept in parallel
+    const std::unique_ptr<BatchSource> batchSource = createBatchSource(loadedDataset);
+    // text files are only parsed into a ksi::dataset for ksi::fcm
+    auto fuzzyRegression = batchSource != nullptr
+            ? FuzzyRegression(*batchSource, numberOfClusters, (int) findUnsignedArgumentValue("-epochs", 0), epsilon)
+            : loadedDataset.dataset.has_value()
+            ? FuzzyRegression(*loadedDataset.dataset, numberOfClusters, ClusteringEngine::KSI, epsilon)
+            : FuzzyRegression(loadedDataset.attributeMajorData, numberOfClusters, epsilon);
+    const std::optional<std::string> cacheKey = createCacheKey(loadedDataset, numberOfClusters, fuzzyRegression);
+    if (cacheKey.has_value()) {
+        if (std::optional<CachedClusterRun> cachedClusterRun = resultCache->find(*cacheKey)) {
+            // nothing was timed, so the run is left out of the performance file
+            return ClusterRunResult{numberOfClusters,
+                                    RegressionResult{std::move(cachedClusterRun->regressionCoefficients),
+                                                     cachedClusterRun->regressionError},
+                                    std::string(),
+                                    cachedClusterRun->numberOfIterations,
+                                    true};
+        }
+    }
+    if (warmStartPartition != nullptr) {
+        fuzzyRegression.setWarmStartPartition(*warmStartPartition);
+    }
+    if (loadedDataset.coreset != nullptr) {
+        fuzzyRegression.setCoreset(*loadedDataset.coreset);
+    }
+    if (isSparseClustering()) {
+        fuzzyRegression.setMembershipSparsity(findUnsignedArgumentValue("-sparse", 0),
+                                              findDoubleArgumentValue("-sparsethreshold", 0));
+    }
+    if (isMixedPrecisionClustering()) {
+        fuzzyRegression.setClusteringPrecision(ClusteringPrecision::MIXED);
+    }
+    auto regressionResults = fuzzyRegression.processDataset(performanceRecord);
+    const FuzzyPartition& partition = fuzzyRegression.getPartition();
+    if (cacheKey.has_value()) {
+        resultCache->store(*cacheKey, CachedClusterRun{regressionResults.regressionDescribingParameters,
+                                                       regressionResults.coefficientOfDetermination,
+                                                       partition.clusterCentres,
+                                                       partition.numberOfAttributes,
+                                                       partition.numberOfIterations});
+    }
+    if (convergedPartition != nullptr) {
+        *convergedPartition = partition;
+    }
+    return ClusterRunResult{numberOfClusters,
+                            regressionResults,
+                            performanceRecord.str(),
+                            partition.numberOfIterations,
+                            false};
+}
+
+std::optional<std::string> Program::createCacheKey(const LoadedDataset& loadedDataset,
+                                                   int numberOfClusters,
+                                                   const FuzzyRegression& fuzzyRegression) const {
+    // a warm-started run depends on the partition of the previous one, which is not kept in the cache
+    if (resultCache == nullptr || isWarmStartSweep()) {
+        return std::nullopt;
+    }
+    std::ostringstream key;
+    key << "engine-version=" << ResultCache::ENGINE_VERSION
+        << ";content=" << std::hex << loadedDataset.contentHash << std::dec
+        << ";data=" << loadedDataset.numberOfData << "x" << loadedDataset.numberOfAttributes
+        << ";clusters=" << numberOfClusters
+        << ";epsilon=" << std::hexfloat << fuzzyRegression.getEpsilon() << std::defaultfloat
+        << ";engine=";
+    if (streaming) {
+        key << "streaming,batch=" << findUnsignedArgumentValue("-batch", DEFAULT_BATCH_SIZE)
+            << ",epochs=" << findUnsignedArgumentValue("-epochs", 0);
+    } else {
+        key << (loadedDataset.dataset.has_value() ? "ksi" : "native");
+    }
+    if (loadedDataset.coreset != nullptr) {
+        key << ";coreset=" << coresetSize;
+    }
+    if (isSparseClustering()) {
+        key << ";sparse=" << findUnsignedArgumentValue("-sparse", 0)
+            << ",threshold=" << std::hexfloat << findDoubleArgumentValue("-sparsethreshold", 0) << std::defaultfloat;
+    }
+    if (isMixedPrecisionClustering()) {
+        key << ";precision=mixed";
+    }
+    return key.str();
+}
+
+std::unique_ptr<BatchSource> Program::createBatchSource(const LoadedDataset& loadedDataset) const {
+    if (!streaming) {
+        return nullptr;
+    }
+    const std::size_t batchSize = findUnsignedArgumentValue("-batch", DEFAULT_BATCH_SIZE);
+    if (!loadedDataset.streamedFilePath.empty()) {
+        // the file was counted once when it was loaded, every cluster count reuses that shape
+        return std::make_unique<TupleBatchReader>(loadedDataset.streamedFilePath, batchSize,
+                                                  loadedDataset.numberOfData, loadedDataset.numberOfAttributes);
+    }
+    return std::make_unique<MatrixBatchSource>(loadedDataset.attributeMajorData, batchSize);
+}
+
+std::vector<ClusterRunResult> Program::sweepClusterCountsSequentially(const LoadedDataset& loadedDataset,
+                                                                      const std::vector<int>& clusterCounts,
+                                                                      std::optional<FuzzyPartition>& previousPartition) const {
+    const bool warmStartSweep = isWarmStartSweep();
+    std::vector<ClusterRunResult> clusterRunResults;
+    std::optional<FuzzyPartition> convergedPartition;
+    for (int clusterSizeForIteration : clusterCounts) {
+        // a partition can only seed the run for one cluster more, searches which skip counts start cold
+        const FuzzyPartition* warmStartPartition =
+                warmStartSweep && previousPartition.has_value()
+                && previousPartition->numberOfClusters + 1 == (std::size_t) clusterSizeForIteration
+                ? &*previousPartition : nullptr;
+        clusterRunResults.push_back(runSingleClusterCount(loadedDataset, clusterSizeForIteration, warmStartPartition,
+                                                          warmStartSweep ? &convergedPartition : nullptr));
+        if (warmStartSweep) {
+            previousPartition.swap(convergedPartition);
+        }
+    }
+    return clusterRunResults;
+}
+
+std::vector<ClusterRunResult> Program::sweepClusterCountsInParallel(const LoadedDataset& loadedDataset,
+                                                                    const std::vector<int>& clusterCounts) const {
+    std::vector<std::future<ClusterRunResult>> clusterRunResults;
+    clusterRunResults.reserve(clusterCounts.size());
+    // one FCM iteration costs O(n * c * d), the expected cost makes the pool start the largest cluster counts first
+    const double costPerCluster = (double) loadedDataset.numberOfData * (double) loadedDataset.numberOfAttributes;
+    for (int clusterCount : clusterCounts) {
+        clusterRunResults.push_back(sweepThreadPool->submit(
+                [this, &loadedDataset, clusterCount]() {
+                    return runSingleClusterCount(loadedDataset, clusterCount, nullptr, nullptr);
+                },
+                costPerCluster * clusterCount));
+    }
+    std::vector<ClusterRunResult> orderedClusterRunResults;
+    orderedClusterRunResults.reserve(clusterRunResults.size());
+    for (auto& futureResult : clusterRunResults) {
+        orderedClusterRunResults.push_back(futureResult.get());
+    }
+    return orderedClusterRunResults;
+}
+
+std::vector<ClusterRunResult> Program::sweepClusterCountsOnWorkers(const LoadedDataset& loadedDataset,
+                                                                   const std::vector<int>& clusterCounts) const {
+    std::vector<std::future<ServedClusterRun>> clusterRuns;
+    clusterRuns.reserve(clusterCounts.size());
+    // the workers may have another working directory in a later transport, the absolute path does not depend on it
+    const std::filesystem::path dataFilePath = std::filesystem::absolute(loadedDataset.dataFilePath);
+    const double costPerCluster = (double) loadedDataset.numberOfData * (double) loadedDataset.numberOfAttributes;
+    for (int clusterCount : clusterCounts) {
+        clusterRuns.push_back(shardCoordinator->submit(Shard{dataFilePath, clusterCount}, costPerCluster * clusterCount));
+    }
+    std::vector<ClusterRunResult> orderedClusterRunResults;
+    orderedClusterRunResults.reserve(clusterRuns.size());
+    for (std::size_t index = 0; index < clusterRuns.size(); ++index) {
+        const ServedClusterRun clusterRun = clusterRuns[index].get();
+        orderedClusterRunResults.push_back(ClusterRunResult{clusterCounts[index], clusterRun.regressionResult,
+                                                            clusterRun.performanceRecord,
+                                                            clusterRun.numberOfIterations,
+                                                            clusterRun.servedFromCache});
+    }
+    return orderedClusterRunResults;
+}
+
 void Program::prettyPrintRegressionData(std::fstream& outputFile,
                                         int clusterSizeForIteration,
                                         const RegressionResult& regressionResults) const {
     outputFile << "Got following results for regression with " << clusterSizeForIteration << " clusters\n";
     auto regressionCoefficients = regressionResults.regressionDescribingParameters;
-    for (int i = 0; i < regressionCoefficients.size(); ++i) {
+    for (std::size_t i = 0; i < regressionCoefficients.size(); ++i) {
         outputFile << "x" << i + 1 << " = " << MAX_PRECISION_COUT << regressionCoefficients[i] << " ";
     }
     outputFile << "\n";
     outputFile << "R-squared error: " << MAX_PRECISION_COUT << regressionResults.coefficientOfDetermination;
 }
 
-void Program::printRegressionDataHeader(std::fstream& outputFile, unsigned long numberOfAttributes) const {
+void Program::printRegressionDataHeader(std::fstream& outputFile,
+                                        unsigned long numberOfAttributes,
+                                        bool withDataEvaluation) const {
     outputFile << "Cluster size" << ";";
-    for (int i = 0; i < numberOfAttributes-1; ++i) {
+    for (unsigned long i = 0; i + 1 < numberOfAttributes; ++i) {
         outputFile << "X" << i+1 << ";";
     }
-    outputFile << "Regression Error" << "\n";
+    outputFile << "Regression Error";
+    if (withDataEvaluation) {
+        outputFile << ";" << "Data MSE" << ";" << "Data R2";
+    }
+    outputFile << "\n";
 }
 
 void Program::printRegressionData(std::fstream& outputFile,
                                   int clusterSizeForIteration,
-                                  const RegressionResult& regressionResults) const {
+                                  const RegressionResult& regressionResults,
+                                  const ModelEvaluation* dataEvaluation) const {
     outputFile << clusterSizeForIteration << ";";
     auto regressionCoefficients = regressionResults.regressionDescribingParameters;
     for (double regressionCoefficient : regressionCoefficients) {
         outputFile << MAX_PRECISION_COUT << regressionCoefficient << ";";
     }
-    outputFile << MAX_PRECISION_COUT << regressionResults.coefficientOfDetermination << std::endl;
+    outputFile << MAX_PRECISION_COUT << regressionResults.coefficientOfDetermination;
+    if (dataEvaluation != nullptr) {
+        outputFile << ";" << dataEvaluation->getMeanSquaredError()
+                   << ";" << dataEvaluation->getCoefficientOfDetermination();
+    }
+    outputFile << std::endl;
 }
 
-void Program::printPerformanceFileHeader(std::fstream& performanceFile) {
+void Program::printPerformanceFileHeader(std::fstream& performanceFile) const {
     performanceFile << "Number of Data;" << "Number of attributes;" << "Number of clusters;";
-    performanceFile << "FCM duration;" << "Data preparation duration;" << "Regression duration;" << "Error calculation duration" << "\n";
+    performanceFile << "FCM duration;" << "Data preparation duration;" << "Regression duration;" << "Error calculation duration;"
+                    << "Clustering precision";
+    if (coresetSize > 0) {
+        performanceFile << ";" << "Coreset objective error";
+    }
+    performanceFile << "\n";
 
 }
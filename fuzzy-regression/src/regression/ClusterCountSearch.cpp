@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <limits>
+#include <iterator>
+
+#include "regression/ClusterCountSearch.hpp"
+
+ClusterCountSearch::ClusterCountSearch(const ClusterCountSearchSettings& settings)
+: settings(settings),
+nextSequentialClusterCount(settings.firstNumberOfClusters){}
+
+std::vector<int> ClusterCountSearch::nextClusterCounts() {
+    switch (settings.mode) {
+        case ClusterCountSearchMode::FULL_SWEEP:
+            // the whole range at once, so that it is spread over the workers like before
+            return nextSequentialClusterCounts(std::numeric_limits<std::size_t>::max());
+        case ClusterCountSearchMode::PLATEAU:
+            return hasPlateaued() ? std::vector<int>() : nextSequentialClusterCounts(settings.batchSize);
+        case ClusterCountSearchMode::COARSE_TO_FINE:
+            if (!gridEvaluated) {
+                gridEvaluated = true;
+                return geometricGrid();
+            }
+            return refinementClusterCounts();
+    }
+    return {};
+}
+
+void ClusterCountSearch::reportRegressionError(int numberOfClusters, double regressionError) {
+    regressionErrors[numberOfClusters] = regressionError;
+}
+
+std::optional<int> ClusterCountSearch::getChosenNumberOfClusters() const {
+    if (regressionErrors.empty()) {
+        return std::nullopt;
+    }
+    double lowestError = std::numeric_limits<double>::infinity();
+    for (const auto& [numberOfClusters, regressionError] : regressionErrors) {
+        lowestError = std::min(lowestError, regressionError);
+    }
+    for (const auto& [numberOfClusters, regressionError] : regressionErrors) {
+        if (regressionError <= lowestError * (1 + settings.tolerance)) {
+            return numberOfClusters;
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t ClusterCountSearch::getNumberOfEvaluatedClusterCounts() const {
+    return regressionErrors.size();
+}
+
+std::vector<int> ClusterCountSearch::nextSequentialClusterCounts(std::size_t batchSize) {
+    std::vector<int> clusterCounts;
+    for (; nextSequentialClusterCount <= settings.lastNumberOfClusters && clusterCounts.size() < batchSize;
+           ++nextSequentialClusterCount) {
+        clusterCounts.push_back(nextSequentialClusterCount);
+    }
+    return clusterCounts;
+}
+
+bool ClusterCountSearch::hasPlateaued() const {
+    double lowestError = std::numeric_limits<double>::infinity();
+    int countsWithoutImprovement = 0;
+    for (const auto& [numberOfClusters, regressionError] : regressionErrors) {
+        if (regressionError < lowestError * (1 - settings.tolerance)) {
+            lowestError = regressionError;
+            countsWithoutImprovement = 0;
+        } else if (++countsWithoutImprovement >= settings.window) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> ClusterCountSearch::geometricGrid() const {
+    std::vector<int> grid;
+    for (int numberOfClusters = settings.firstNumberOfClusters; numberOfClusters <= settings.lastNumberOfClusters;
+         numberOfClusters *= 2) {
+        grid.push_back(numberOfClusters);
+    }
+    if (!grid.empty() && grid.back() != settings.lastNumberOfClusters) {
+        grid.push_back(settings.lastNumberOfClusters);
+    }
+    return grid;
+}
+
+std::vector<int> ClusterCountSearch::refinementClusterCounts() const {
+    const std::optional<int> chosenNumberOfClusters = getChosenNumberOfClusters();
+    if (!chosenNumberOfClusters.has_value()) {
+        return {};
+    }
+    // the evaluated neighbours of the chosen count bracket it, both halves of the bracket are bisected
+    const auto chosen = regressionErrors.find(*chosenNumberOfClusters);
+    std::vector<int> clusterCounts;
+    if (chosen != regressionErrors.begin()) {
+        const int lowerNeighbour = std::prev(chosen)->first;
+        if (chosen->first - lowerNeighbour > 1) {
+            clusterCounts.push_back(lowerNeighbour + (chosen->first - lowerNeighbour) / 2);
+        }
+    }
+    if (std::next(chosen) != regressionErrors.end()) {
+        const int upperNeighbour = std::next(chosen)->first;
+        if (upperNeighbour - chosen->first > 1) {
+            clusterCounts.push_back(chosen->first + (upperNeighbour - chosen->first) / 2);
+        }
+    }
+    return clusterCounts;
+}
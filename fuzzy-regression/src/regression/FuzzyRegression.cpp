@@ -1,92 +1,286 @@
 #include <chrono>
+#include <cmath>
+#include <stdexcept>
 
+#include <auxiliary/least-error-squares-regression.h>
+
+#include "clustering/MiniBatchFuzzyCMeans.hpp"
+#include "clustering/MixedPrecisionFuzzyCMeans.hpp"
+#include "clustering/SparseFuzzyCMeans.hpp"
 #include "regression/FuzzyRegression.hpp"
+#include "regression/WeightedLeastSquares.hpp"
+#include "telemetry/Telemetry.hpp"
+
+FuzzyRegression::FuzzyRegression(const ksi::dataset& dataset,
+                                 int numberOfClusters,
+                                 ClusteringEngine clusteringEngine,
+                                 double epsilon)
+: dataset(&dataset),
+numberOfClusters(numberOfClusters),
+clusteringEngine(clusteringEngine),
+epsilon(epsilon),
+attributeMajorBuffer(clusteringEngine == ClusteringEngine::NATIVE
+                     ? FuzzyCMeans::flattenDatasetByAttributes(dataset)
+                     : std::vector<double>()),
+attributeMajorData(MatrixView<const double>::rowMajor(attributeMajorBuffer.data(),
+                                                      dataset.getNumberOfAttributes(),
+                                                      dataset.getNumberOfData())){}
+
+FuzzyRegression::FuzzyRegression(const MatrixView<const double>& attributeMajorData,
+                                 int numberOfClusters,
+                                 double epsilon)
+: dataset(nullptr),
+numberOfClusters(numberOfClusters),
+clusteringEngine(ClusteringEngine::NATIVE),
+epsilon(epsilon),
+attributeMajorBuffer(attributeMajorData.hasContiguousRows()
+                     ? std::vector<double>()
+                     : FuzzyCMeans::copyToContiguousRows(attributeMajorData)),
+attributeMajorData(attributeMajorData.hasContiguousRows()
+                   ? attributeMajorData
+                   : MatrixView<const double>::rowMajor(attributeMajorBuffer.data(),
+                                                        attributeMajorData.getNumberOfRows(),
+                                                        attributeMajorData.getNumberOfColumns())){}
 
-FuzzyRegression::FuzzyRegression(const ksi::dataset& dataset, int numberOfClusters, double epsilon)
-: dataset(dataset),
+FuzzyRegression::FuzzyRegression(BatchSource& batchSource,
+                                 int numberOfClusters,
+                                 int numberOfEpochs,
+                                 double epsilon)
+: dataset(nullptr),
 numberOfClusters(numberOfClusters),
-epsilon(epsilon){}
+clusteringEngine(ClusteringEngine::NATIVE),
+epsilon(epsilon),
+attributeMajorData(nullptr, batchSource.getNumberOfAttributes(), batchSource.getNumberOfData(), 0),
+batchSource(&batchSource),
+numberOfEpochs(numberOfEpochs){}
+
+void FuzzyRegression::setWarmStartPartition(const FuzzyPartition& previousPartition) {
+    if (clusteringEngine != ClusteringEngine::NATIVE) {
+        throw std::invalid_argument("Warm start is supported only by the native clustering engine");
+    }
+    if (batchSource != nullptr) {
+        throw std::invalid_argument("Warm start is not supported when clustering batches");
+    }
+    if (previousPartition.numberOfClusters + 1 != (std::size_t) numberOfClusters) {
+        throw std::invalid_argument("Warm start partition has to have exactly one cluster less");
+    }
+    if (coreset != nullptr || sparseMemberships || clusteringPrecision != ClusteringPrecision::DOUBLE) {
+        throw std::invalid_argument("Warm start is supported only when clustering with the dense double-precision partition matrix");
+    }
+    warmStartPartition = &previousPartition;
+}
+
+void FuzzyRegression::setCoreset(const Coreset& coreset) {
+    if (clusteringEngine != ClusteringEngine::NATIVE || batchSource != nullptr) {
+        throw std::invalid_argument("Coreset is supported only by the native clustering engine on data in memory");
+    }
+    if (warmStartPartition != nullptr || sparseMemberships || clusteringPrecision != ClusteringPrecision::DOUBLE) {
+        throw std::invalid_argument("Coreset is not supported with warm start, sparse memberships or mixed precision");
+    }
+    if (coreset.getPoints().getNumberOfRows() != attributeMajorData.getNumberOfRows()) {
+        throw std::invalid_argument("Coreset has to have as many attributes as the data");
+    }
+    this->coreset = &coreset;
+}
+
+const FuzzyPartition& FuzzyRegression::getPartition() const {
+    return partition;
+}
+
+const StageDurations& FuzzyRegression::getStageDurations() const {
+    return stageDurations;
+}
+
+double FuzzyRegression::getEpsilon() const {
+    return epsilon;
+}
+
+void FuzzyRegression::setMembershipSparsity(std::size_t maximalNumberOfMemberships, double membershipThreshold) {
+    if (clusteringEngine != ClusteringEngine::NATIVE || batchSource != nullptr) {
+        throw std::invalid_argument("Sparse memberships are supported only by the native clustering engine on data in memory");
+    }
+    if (warmStartPartition != nullptr || coreset != nullptr || clusteringPrecision != ClusteringPrecision::DOUBLE) {
+        throw std::invalid_argument("Sparse memberships are not supported with warm start, coreset or mixed precision");
+    }
+    sparseMemberships = true;
+    this->maximalNumberOfMemberships = maximalNumberOfMemberships;
+    this->membershipThreshold = membershipThreshold;
+}
+
+void FuzzyRegression::setClusteringPrecision(ClusteringPrecision clusteringPrecision) {
+    if (clusteringPrecision != ClusteringPrecision::DOUBLE) {
+        if (clusteringEngine != ClusteringEngine::NATIVE || batchSource != nullptr) {
+            throw std::invalid_argument("Mixed precision is supported only by the native clustering engine on data in memory");
+        }
+        if (warmStartPartition != nullptr || coreset != nullptr || sparseMemberships) {
+            throw std::invalid_argument("Mixed precision is not supported with warm start, coreset or sparse memberships");
+        }
+    }
+    this->clusteringPrecision = clusteringPrecision;
+}
+
+ClusteringPrecision FuzzyRegression::getClusteringPrecision() const {
+    return clusteringPrecision;
+}
+
+const std::optional<double>& FuzzyRegression::getCoresetObjectiveError() const {
+    return coresetObjectiveError;
+}
 
 RegressionResult
 FuzzyRegression::processDataset(std::ostream& performanceLoggingStream) {
-    performanceLoggingStream << dataset.getNumberOfData() << ";"
-                             << dataset.getNumberOfAttributes() << ";"
+    performanceLoggingStream << attributeMajorData.getNumberOfColumns() << ";"
+                             << attributeMajorData.getNumberOfRows() << ";"
                              << numberOfClusters << ";";
-    ksi::fcm algorithm;
-    algorithm.setEpsilonForFrobeniusNorm(epsilon);
-    algorithm.setNumberOfClusters(numberOfClusters);
+    Telemetry::setNumberOfClusters(numberOfClusters);
+    FUZZY_REGRESSION_TELEMETRY_STAGE(processDatasetStage, "processDataset");
+    FUZZY_REGRESSION_TELEMETRY_STAGE(clusteringStage, "clustering");
     auto fcmStart = std::chrono::steady_clock::now();
-    auto partition = algorithm.doPartition(dataset);
+    partition = partitionDataset();
+    FUZZY_REGRESSION_TELEMETRY_COUNTER("fcm.iterations", partition.numberOfIterations);
+    if (coreset != nullptr) {
+        FuzzyCMeans algorithm;
+        const double coresetObjective = algorithm.calculateObjective(coreset->getPoints(), partition.clusterCentres,
+                                                                     coreset->getWeights());
+        const double objective = algorithm.calculateObjective(attributeMajorData, partition.clusterCentres);
+        coresetObjectiveError = objective > 0 ? std::abs(coresetObjective - objective) / objective : 0.0;
+    }
     auto fcmEnd = std::chrono::steady_clock::now();
-    long fcmNanosecondDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(fcmEnd - fcmStart).count();
-    performanceLoggingStream << fcmNanosecondDuration << ";";
+    FUZZY_REGRESSION_TELEMETRY_END_STAGE(clusteringStage);
+    stageDurations.clusteringNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(fcmEnd - fcmStart).count();
+    performanceLoggingStream << stageDurations.clusteringNanoseconds << ";";
 
+    FUZZY_REGRESSION_TELEMETRY_STAGE(dataPreparationStage, "dataPreparation");
     auto dataPrepStart = std::chrono::steady_clock::now();
-    const std::vector<std::vector<double>> clusterCenters = partition.getClusterCentres();
-    std::vector<double> clusterDescribedValues = getClustersDescribedValue(clusterCenters);
-    std::vector<std::vector<double>> clusterDescribingValues = getClustersDescribingValues(clusterCenters);
+    // the last attribute is the described one, both parts are views of the cluster centres
+    const MatrixView<const double> clusterCenters = partition.getClusterCentres();
+    const std::size_t numberOfDescribingValues = partition.numberOfAttributes - 1;
+    const MatrixView<const double> clusterDescribingValues = clusterCenters.block(0, 0, partition.numberOfClusters,
+                                                                                  numberOfDescribingValues);
+    const MatrixView<const double> clusterDescribedValues = clusterCenters.column(numberOfDescribingValues);
     const std::vector<double> clusterWeights = getClusterWeightsFromPartition(partition);
     auto dataPrepEnd = std::chrono::steady_clock::now();
+    FUZZY_REGRESSION_TELEMETRY_END_STAGE(dataPreparationStage);
+    stageDurations.dataPreparationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(dataPrepEnd - dataPrepStart).count();
+    performanceLoggingStream << stageDurations.dataPreparationNanoseconds << ";";
 
-    long dataPrepNanosecondDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(dataPrepEnd - dataPrepStart).count();
-    performanceLoggingStream << dataPrepNanosecondDuration << ";";
-
+    FUZZY_REGRESSION_TELEMETRY_STAGE(regressionStage, "regression");
     auto fuzzyRegressionStart = std::chrono::steady_clock::now();
-    const std::vector<double>& fuzzyRegressionCoefficients = ksi::least_square_error_regression::weighted_linear_regression(
-            clusterDescribingValues, clusterDescribedValues, clusterWeights);
+    const std::vector<double> fuzzyRegressionCoefficients = solveRegression(clusterDescribingValues,
+                                                                             clusterDescribedValues,
+                                                                             clusterWeights);
     auto fuzzyRegressionEnd = std::chrono::steady_clock::now();
-    long fuzzyRegressionNanosecondDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(fuzzyRegressionEnd- fuzzyRegressionStart).count();
-    performanceLoggingStream << fuzzyRegressionNanosecondDuration << ";";
+    FUZZY_REGRESSION_TELEMETRY_END_STAGE(regressionStage);
+    stageDurations.regressionNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(fuzzyRegressionEnd - fuzzyRegressionStart).count();
+    performanceLoggingStream << stageDurations.regressionNanoseconds << ";";
 
+    FUZZY_REGRESSION_TELEMETRY_STAGE(errorCalculationStage, "errorCalculation");
     auto rSquaredErrorStart = std::chrono::steady_clock::now();
     double regressionError = calculateRegressionError(clusterDescribingValues, clusterDescribedValues,
                                                       fuzzyRegressionCoefficients);
     auto rSquaredErrorEnd = std::chrono::steady_clock::now();
-    long rSquaredNanosecondDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(fuzzyRegressionEnd - fuzzyRegressionStart).count();
-    performanceLoggingStream << rSquaredNanosecondDuration << "\n";
+    FUZZY_REGRESSION_TELEMETRY_END_STAGE(errorCalculationStage);
+    stageDurations.errorCalculationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(rSquaredErrorEnd - rSquaredErrorStart).count();
+    performanceLoggingStream << stageDurations.errorCalculationNanoseconds << ";"
+                             << (clusteringPrecision == ClusteringPrecision::MIXED ? "mixed" : "double");
+    if (coresetObjectiveError.has_value()) {
+        performanceLoggingStream << ";" << *coresetObjectiveError;
+    }
+    performanceLoggingStream << "\n";
+    FUZZY_REGRESSION_TELEMETRY_END_STAGE(processDatasetStage);
+    FUZZY_REGRESSION_TELEMETRY_COUNTER("memory.peakResidentBytes", (double) Telemetry::peakResidentBytes());
+    Telemetry::setNumberOfClusters(0);
 
     return RegressionResult{fuzzyRegressionCoefficients, regressionError};
 }
 
-std::vector<std::vector<double>>
-FuzzyRegression::getClustersDescribingValues(const std::vector<std::vector<double>>& clusterCenters) const {
-    std::vector<std::vector<double>> clusterDescribingValues;
-    clusterDescribingValues.reserve(numberOfClusters);
-    for (const auto & singleClusterParameters : clusterCenters) {
-        std::vector<double> singleClusterDescribingValues;
-        unsigned long numberOfDescribingValuesInTuple = singleClusterParameters.size() - 1;
-        singleClusterDescribingValues.reserve(numberOfDescribingValuesInTuple);
-        for (int i = 0; i < numberOfDescribingValuesInTuple; ++i) {
-            singleClusterDescribingValues.push_back(singleClusterParameters[i]);
+FuzzyPartition FuzzyRegression::partitionDataset() const {
+    if (batchSource != nullptr) {
+        MiniBatchFuzzyCMeans algorithm;
+        algorithm.setEpsilonForFrobeniusNorm(epsilon);
+        algorithm.setNumberOfClusters(numberOfClusters);
+        if (numberOfEpochs > 0) {
+            algorithm.setNumberOfEpochs(numberOfEpochs);
         }
-        clusterDescribingValues.push_back(singleClusterDescribingValues);
+        return algorithm.doPartition(*batchSource);
     }
-    return clusterDescribingValues;
+    // when few memberships are pruned the vectorised dense iteration is faster
+    const bool pruning = membershipThreshold > 0
+                         || (maximalNumberOfMemberships > 0
+                             && maximalNumberOfMemberships * MINIMAL_PRUNING_RATIO <= (std::size_t) numberOfClusters);
+    if (sparseMemberships && pruning) {
+        SparseFuzzyCMeans algorithm;
+        algorithm.setEpsilonForFrobeniusNorm(epsilon);
+        algorithm.setNumberOfClusters(numberOfClusters);
+        algorithm.setMaximalNumberOfMemberships(maximalNumberOfMemberships);
+        algorithm.setMembershipThreshold(membershipThreshold);
+        return algorithm.doPartition(attributeMajorData);
+    }
+    if (clusteringPrecision == ClusteringPrecision::MIXED) {
+        MixedPrecisionFuzzyCMeans algorithm;
+        algorithm.setEpsilonForFrobeniusNorm(epsilon);
+        algorithm.setNumberOfClusters(numberOfClusters);
+        return algorithm.doPartition(attributeMajorData);
+    }
+    if (clusteringEngine == ClusteringEngine::NATIVE) {
+        FuzzyCMeans algorithm;
+        algorithm.setEpsilonForFrobeniusNorm(epsilon);
+        algorithm.setNumberOfClusters(numberOfClusters);
+        if (coreset != nullptr) {
+            // memberships of the coreset points say nothing about the datums, only the centres are kept
+            FuzzyPartition coresetPartition = algorithm.doWeightedPartition(coreset->getPoints(),
+                                                                            coreset->getWeights());
+            coresetPartition.numberOfData = attributeMajorData.getNumberOfColumns();
+            coresetPartition.partitionMatrix.clear();
+            FuzzyCMeans::countNearestDatums(attributeMajorData, coresetPartition.clusterCentres,
+                                            coresetPartition.datumCountsPerCluster);
+            return coresetPartition;
+        }
+        if (warmStartPartition == nullptr) {
+            return algorithm.doPartition(attributeMajorData);
+        }
+        const std::vector<double> initialClusterCentres =
+                algorithm.splitWorstFittingCluster(attributeMajorData, *warmStartPartition);
+        return algorithm.doPartition(attributeMajorData, initialClusterCentres);
+    }
+    ksi::fcm algorithm;
+    algorithm.setEpsilonForFrobeniusNorm(epsilon);
+    algorithm.setNumberOfClusters(numberOfClusters);
+    return FuzzyPartition::fromKsiPartition(algorithm.doPartition(*dataset));
 }
 
-std::vector<double>
-FuzzyRegression::getClustersDescribedValue(const std::vector<std::vector<double>>& clusterCenters) const {
-    std::vector<double> clusterDescribedValues(numberOfClusters);
-    for (int i = 0; i< numberOfClusters; ++i){
-        double describedValue = clusterCenters[i].back();
-        clusterDescribedValues[i] = describedValue;
+std::vector<double> FuzzyRegression::solveRegression(const MatrixView<const double>& describingValues,
+                                                     const MatrixView<const double>& describedValues,
+                                                     const std::vector<double>& weights) const {
+    if (clusteringEngine == ClusteringEngine::NATIVE || dataset == nullptr) {
+        return WeightedLeastSquares().solve(describingValues, describedValues, weights);
+    }
+    // the ksi engine keeps the ksi regression end to end
+    std::vector<std::vector<double>> describingRows(describingValues.getNumberOfRows());
+    std::vector<double> describedColumn(describedValues.getNumberOfRows());
+    for (std::size_t row = 0; row < describingRows.size(); ++row) {
+        for (std::size_t column = 0; column < describingValues.getNumberOfColumns(); ++column) {
+            describingRows[row].push_back(describingValues(row, column));
+        }
+        describedColumn[row] = describedValues(row, 0);
     }
-    return clusterDescribedValues;
+    return ksi::least_square_error_regression::weighted_linear_regression(describingRows, describedColumn, weights);
 }
 
 std::vector<double>
-FuzzyRegression::getClusterWeightsFromPartition(const ksi::partition& partition) const {
-    std::vector<int> clusterAmounts(numberOfClusters);
-    {
-        std::vector<AssociationStruct> datumAssociationInfo =
-                getPartitionAssociativityData(partition.getPartitionMatrix());
-        for (const auto& associationInfo: datumAssociationInfo) {
-            clusterAmounts[associationInfo.clusterNumber]++;
-        }
+FuzzyRegression::getClusterWeightsFromPartition(const FuzzyPartition& partition) const {
+    std::vector<std::size_t> clusterAmounts = partition.datumCountsPerCluster;
+    if (clusterAmounts.empty() && !partition.sparseMemberships.empty()) {
+        partition.sparseMemberships.countHighestMemberships(partition.numberOfClusters, clusterAmounts);
+    } else if (clusterAmounts.empty()) {
+        FuzzyCMeans::countHighestMemberships(MatrixView<const double>::rowMajor(partition.partitionMatrix.data(),
+                                                                                partition.numberOfClusters,
+                                                                                partition.numberOfData),
+                                             clusterAmounts);
     }
-    const size_t datumElementsNumber = partition.getPartitionMatrix()[0].size();
+    const size_t datumElementsNumber = partition.numberOfData;
     std::vector<double> clusterWeights;
-    auto calculateProportionOfDatumsBelongingToCluster = [datumElementsNumber] (int numberOfAssociatedDatums) {
+    auto calculateProportionOfDatumsBelongingToCluster = [datumElementsNumber] (std::size_t numberOfAssociatedDatums) {
         return numberOfAssociatedDatums/(double) datumElementsNumber;
     };
     std::transform(clusterAmounts.begin(), clusterAmounts.end(), std::back_inserter(clusterWeights),
@@ -94,46 +288,21 @@ FuzzyRegression::getClusterWeightsFromPartition(const ksi::partition& partition)
     return clusterWeights;
 }
 
-std::vector<AssociationStruct>
-FuzzyRegression::getPartitionAssociativityData(const std::vector<std::vector<double>>& partitionMatrix) const {
-    size_t elementCount = dataset.getNumberOfData();
-    std::vector<AssociationStruct> datumClusterAssociationInfo(elementCount);
-
-    const auto& firstClusterAssociationData = partitionMatrix[0];
-    for (int i = 0; i < elementCount; ++i) {
-        double firstClusterAssociationValue = firstClusterAssociationData[i];
-        auto& initialPartitionAssociationValue = datumClusterAssociationInfo[i];
-        initialPartitionAssociationValue.clusterAssociationValue = firstClusterAssociationValue;
-    }
-
-    for (int clusterNumber = 1; clusterNumber < numberOfClusters; ++clusterNumber) {
-        auto clusterAssociationValues = partitionMatrix[clusterNumber];
-        for (int elementNumber = 0; elementNumber < elementCount; ++elementNumber) {
-            double associationValue = clusterAssociationValues[elementNumber];
-            auto& datumAssociationInfo = datumClusterAssociationInfo[elementNumber];
-            if (datumAssociationInfo.clusterAssociationValue < associationValue){
-                datumAssociationInfo.clusterAssociationValue = associationValue;
-                datumAssociationInfo.clusterNumber = clusterNumber;
-            }
-        }
-    }
-    return datumClusterAssociationInfo;
-}
-
-double FuzzyRegression::calculateRegressionError(const std::vector<std::vector<double>>& rowsWithDescribingValues,
-                                                 const std::vector<double>& describedValues,
+double FuzzyRegression::calculateRegressionError(const MatrixView<const double>& rowsWithDescribingValues,
+                                                 const MatrixView<const double>& describedValues,
                                                  const std::vector<double>& regressionCoefficients) {
 //    double averageOfDescribedValues = std::accumulate(describedValues.begin(), describedValues.end(), 0.0)/(double) describedValues.size();
+    const std::size_t numberOfRows = describedValues.getNumberOfRows();
     double sumOfLineErrors = 0;
 //    double sumOfAvgErrors = 0;
-    for (int i = 0; i < describedValues.size(); ++i) {
-        const auto& describingValues = rowsWithDescribingValues[i];
+    for (std::size_t i = 0; i < numberOfRows; ++i) {
+        const double* describingValues = rowsWithDescribingValues.row(i);
         double predictedValue = 0;
-        for (int j = 0; j < describingValues.size(); ++j) {
+        for (std::size_t j = 0; j < rowsWithDescribingValues.getNumberOfColumns(); ++j) {
             predictedValue += regressionCoefficients[j] * describingValues[j];
         }
-        double sqrdLineError = (describedValues[i] - predictedValue) *
-                               (describedValues[i] - predictedValue);
+        double sqrdLineError = (describedValues(i, 0) - predictedValue) *
+                               (describedValues(i, 0) - predictedValue);
 //        double sqrdAvgError = (describedValues[i] - averageOfDescribedValues) *
 //                              (describedValues[i] - averageOfDescribedValues);
         sumOfLineErrors += sqrdLineError;
@@ -141,5 +310,5 @@ double FuzzyRegression::calculateRegressionError(const std::vector<std::vector<d
     }
 //    double d = sumOfLineErrors / sumOfAvgErrors ;
 //    return 1 - d;
-    return sumOfLineErrors / (double)describedValues.size();
-}
\ No newline at end of file
+    return sumOfLineErrors / (double) numberOfRows;
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+#include "clustering/SimdKernels.hpp"
+#include "regression/RegressionModel.hpp"
+
+namespace {
+    // calls processRange(first, last) for consecutive ranges of at most rangeLength datums, spread over the pool
+    // when one is given; the results are returned in the order of the ranges
+    template<typename RangeResult, typename ProcessRange>
+    std::vector<RangeResult> forEachRange(std::size_t numberOfData,
+                                          std::size_t rangeLength,
+                                          ThreadPool* threadPool,
+                                          const ProcessRange& processRange) {
+        const std::size_t numberOfRanges = (numberOfData + rangeLength - 1) / rangeLength;
+        std::vector<RangeResult> results;
+        results.reserve(numberOfRanges);
+        if (threadPool == nullptr || numberOfRanges < 2) {
+            for (std::size_t first = 0; first < numberOfData; first += rangeLength) {
+                results.push_back(processRange(first, std::min(numberOfData, first + rangeLength)));
+            }
+            return results;
+        }
+        std::vector<std::future<RangeResult>> processedRanges;
+        processedRanges.reserve(numberOfRanges);
+        for (std::size_t first = 0; first < numberOfData; first += rangeLength) {
+            const std::size_t last = std::min(numberOfData, first + rangeLength);
+            processedRanges.push_back(threadPool->submit([&processRange, first, last]() {
+                return processRange(first, last);
+            }));
+        }
+        for (auto& processedRange : processedRanges) {
+            results.push_back(processedRange.get());
+        }
+        return results;
+    }
+}
+
+void ModelEvaluation::merge(const ModelEvaluation& other) {
+    if (other.numberOfData == 0) {
+        return;
+    }
+    const double totalNumberOfData = (double) (numberOfData + other.numberOfData);
+    const double meanDifference = other.meanOfDescribedValues - meanOfDescribedValues;
+    totalSumOfSquares += other.totalSumOfSquares
+                         + meanDifference * meanDifference * (double) numberOfData * (double) other.numberOfData
+                           / totalNumberOfData;
+    meanOfDescribedValues += meanDifference * (double) other.numberOfData / totalNumberOfData;
+    residualSumOfSquares += other.residualSumOfSquares;
+    numberOfData += other.numberOfData;
+}
+
+double ModelEvaluation::getMeanSquaredError() const {
+    return numberOfData == 0 ? 0.0 : residualSumOfSquares / (double) numberOfData;
+}
+
+double ModelEvaluation::getCoefficientOfDetermination() const {
+    if (totalSumOfSquares == 0) {
+        return residualSumOfSquares == 0 ? 1.0 : 0.0;
+    }
+    return 1.0 - residualSumOfSquares / totalSumOfSquares;
+}
+
+RegressionModel::RegressionModel(std::vector<double> coefficients)
+: coefficients(std::move(coefficients)){
+    if (this->coefficients.empty()) {
+        throw std::invalid_argument("Regression model needs at least one coefficient");
+    }
+}
+
+RegressionModel::RegressionModel(const RegressionResult& regressionResult)
+: RegressionModel(regressionResult.regressionDescribingParameters){}
+
+const std::vector<double>& RegressionModel::getCoefficients() const {
+    return coefficients;
+}
+
+void RegressionModel::predict(const MatrixView<const double>& describingValues,
+                              double* predictions,
+                              ThreadPool* threadPool) const {
+    validate(describingValues);
+    (void) forEachRange<bool>(describingValues.getNumberOfColumns(), DATUMS_PER_TASK, threadPool,
+                              [this, &describingValues, predictions](std::size_t first, std::size_t last) {
+        for (std::size_t blockStart = first; blockStart < last; blockStart += DATUM_BLOCK_SIZE) {
+            predictBlock(describingValues, blockStart, std::min(DATUM_BLOCK_SIZE, last - blockStart),
+                         predictions + blockStart);
+        }
+        return true;
+    });
+}
+
+std::vector<double> RegressionModel::predict(const MatrixView<const double>& describingValues,
+                                             ThreadPool* threadPool) const {
+    std::vector<double> predictions(describingValues.getNumberOfColumns());
+    predict(describingValues, predictions.data(), threadPool);
+    return predictions;
+}
+
+ModelEvaluation RegressionModel::evaluate(const MatrixView<const double>& attributeMajorData,
+                                          ThreadPool* threadPool) const {
+    if (attributeMajorData.getNumberOfRows() != coefficients.size() + 1) {
+        throw std::invalid_argument("Data has to hold one attribute per coefficient and the described attribute");
+    }
+    const std::vector<ModelEvaluation> rangeEvaluations = forEachRange<ModelEvaluation>(
+            attributeMajorData.getNumberOfColumns(), DATUMS_PER_TASK, threadPool,
+            [this, &attributeMajorData](std::size_t first, std::size_t last) {
+                return evaluateRange(attributeMajorData, first, last);
+            });
+    ModelEvaluation evaluation{0, 0.0, 0.0, 0.0};
+    for (const auto& rangeEvaluation : rangeEvaluations) {
+        evaluation.merge(rangeEvaluation);
+    }
+    return evaluation;
+}
+
+ModelEvaluation RegressionModel::evaluate(BatchSource& batchSource, ThreadPool* threadPool) const {
+    ModelEvaluation evaluation{0, 0.0, 0.0, 0.0};
+    batchSource.rewind();
+    for (auto batch = batchSource.nextBatch(); batch.getNumberOfColumns() > 0; batch = batchSource.nextBatch()) {
+        evaluation.merge(evaluate(batch, threadPool));
+    }
+    return evaluation;
+}
+
+void RegressionModel::validate(const MatrixView<const double>& describingValues) const {
+    if (describingValues.getNumberOfRows() != coefficients.size()) {
+        throw std::invalid_argument("Data has to hold one describing attribute per coefficient");
+    }
+}
+
+void RegressionModel::predictBlock(const MatrixView<const double>& describingValues,
+                                   std::size_t blockStart,
+                                   std::size_t blockLength,
+                                   double* predictions) const {
+    const std::size_t numberOfCoefficients = coefficients.size();
+    if (describingValues.hasContiguousRows()) {
+        // attribute-major: one pass over the block per attribute, vectorised across datums
+        std::fill(predictions, predictions + blockLength, 0.0);
+        for (std::size_t attribute = 0; attribute < numberOfCoefficients; ++attribute) {
+            SimdKernels::accumulateScaled(describingValues.row(attribute) + blockStart, coefficients[attribute],
+                                          predictions, blockLength);
+        }
+    } else if (describingValues.getRowStride() == 1) {
+        // transposed row buffer: the attributes of a datum are contiguous
+        for (std::size_t i = 0; i < blockLength; ++i) {
+            predictions[i] = SimdKernels::dotProduct(&describingValues(0, blockStart + i), coefficients.data(),
+                                                     numberOfCoefficients);
+        }
+    } else {
+        for (std::size_t i = 0; i < blockLength; ++i) {
+            double prediction = 0;
+            for (std::size_t attribute = 0; attribute < numberOfCoefficients; ++attribute) {
+                prediction += coefficients[attribute] * describingValues(attribute, blockStart + i);
+            }
+            predictions[i] = prediction;
+        }
+    }
+}
+
+ModelEvaluation RegressionModel::evaluateRange(const MatrixView<const double>& attributeMajorData,
+                                               std::size_t first,
+                                               std::size_t last) const {
+    const std::size_t numberOfCoefficients = coefficients.size();
+    const MatrixView<const double> describingValues = attributeMajorData.block(0, 0, numberOfCoefficients,
+                                                                               attributeMajorData.getNumberOfColumns());
+    const bool contiguousDescribedValues = attributeMajorData.hasContiguousRows();
+    std::vector<double> predictions(DATUM_BLOCK_SIZE);
+    std::vector<double> describedValuesBuffer(contiguousDescribedValues ? 0 : DATUM_BLOCK_SIZE);
+    std::vector<double> deviations(DATUM_BLOCK_SIZE);
+    ModelEvaluation evaluation{0, 0.0, 0.0, 0.0};
+    for (std::size_t blockStart = first; blockStart < last; blockStart += DATUM_BLOCK_SIZE) {
+        const std::size_t blockLength = std::min(DATUM_BLOCK_SIZE, last - blockStart);
+        predictBlock(describingValues, blockStart, blockLength, predictions.data());
+        const double* describedValues = attributeMajorData.row(numberOfCoefficients) + blockStart;
+        if (!contiguousDescribedValues) {
+            for (std::size_t i = 0; i < blockLength; ++i) {
+                describedValuesBuffer[i] = attributeMajorData(numberOfCoefficients, blockStart + i);
+            }
+            describedValues = describedValuesBuffer.data();
+        }
+        const double blockMean = SimdKernels::sum(describedValues, blockLength) / (double) blockLength;
+        std::fill(deviations.begin(), deviations.begin() + (std::ptrdiff_t) blockLength, 0.0);
+        SimdKernels::accumulateSquaredDifferences(describedValues, blockMean, deviations.data(), blockLength);
+        evaluation.merge(ModelEvaluation{blockLength,
+                                         blockMean,
+                                         SimdKernels::sum(deviations.data(), blockLength),
+                                         SimdKernels::sumOfSquaredDifferences(describedValues, predictions.data(),
+                                                                              blockLength)});
+    }
+    return evaluation;
+}
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+#include "regression/WeightedLeastSquares.hpp"
+
+namespace {
+    // smallest pivot of the unit-diagonal normal matrix accepted by Cholesky, about 1 / condition number
+    constexpr double CHOLESKY_PIVOT_TOLERANCE = 1e-6;
+
+    // Cholesky of the scaled normal matrix S A S, whose lower triangle is overwritten with L, followed by
+    // L z = S r, L^T u = z and b = S u; FixedSize 0 reads the size at run time, any other value lets the
+    // compiler unroll every loop
+    template<std::size_t FixedSize>
+    bool factoriseAndSolve(std::size_t size, double* matrix, const double* normalVector, const double* scales,
+                           double* coefficients) {
+        const std::size_t numberOfCoefficients = FixedSize == 0 ? size : FixedSize;
+        for (std::size_t column = 0; column < numberOfCoefficients; ++column) {
+            double* columnRow = matrix + column * numberOfCoefficients;
+            double pivot = columnRow[column];
+            for (std::size_t k = 0; k < column; ++k) {
+                pivot -= columnRow[k] * columnRow[k];
+            }
+            if (!(pivot > CHOLESKY_PIVOT_TOLERANCE)) {
+                return false;
+            }
+            const double diagonal = std::sqrt(pivot);
+            columnRow[column] = diagonal;
+            for (std::size_t row = column + 1; row < numberOfCoefficients; ++row) {
+                double* lowerRow = matrix + row * numberOfCoefficients;
+                double value = lowerRow[column];
+                for (std::size_t k = 0; k < column; ++k) {
+                    value -= lowerRow[k] * columnRow[k];
+                }
+                lowerRow[column] = value / diagonal;
+            }
+        }
+
+        for (std::size_t row = 0; row < numberOfCoefficients; ++row) {
+            double value = normalVector[row] * scales[row];
+            for (std::size_t k = 0; k < row; ++k) {
+                value -= matrix[row * numberOfCoefficients + k] * coefficients[k];
+            }
+            coefficients[row] = value / matrix[row * numberOfCoefficients + row];
+        }
+        for (std::size_t row = numberOfCoefficients; row-- > 0;) {
+            double value = coefficients[row];
+            for (std::size_t k = row + 1; k < numberOfCoefficients; ++k) {
+                value -= matrix[k * numberOfCoefficients + row] * coefficients[k];
+            }
+            coefficients[row] = value / matrix[row * numberOfCoefficients + row];
+        }
+        for (std::size_t i = 0; i < numberOfCoefficients; ++i) {
+            coefficients[i] *= scales[i];
+        }
+        return true;
+    }
+
+    using Factorisation = bool (*)(std::size_t, double*, const double*, const double*, double*);
+
+    template<std::size_t... Sizes>
+    constexpr std::array<Factorisation, sizeof...(Sizes)> createUnrolledFactorisations(std::index_sequence<Sizes...>) {
+        return {&factoriseAndSolve<Sizes + 2>...};
+    }
+
+    // unrolledFactorisations[n - 2] solves systems of n coefficients, a single coefficient needs no factorisation
+    constexpr auto unrolledFactorisations = createUnrolledFactorisations(
+            std::make_index_sequence<WeightedLeastSquares::MAX_UNROLLED_COEFFICIENTS - 1>());
+}
+
+std::vector<double> WeightedLeastSquares::solve(const MatrixView<const double>& describingValues,
+                                                const MatrixView<const double>& describedValues,
+                                                const std::vector<double>& weights) {
+    validate(describingValues, describedValues, weights);
+    const std::size_t numberOfCoefficients = describingValues.getNumberOfColumns();
+    std::vector<double> coefficients(numberOfCoefficients, 0.0);
+    usedQr = false;
+    if (numberOfCoefficients == 0) {
+        return coefficients;
+    }
+    accumulateNormalEquations(describingValues, describedValues, weights);
+    if (numberOfCoefficients == 1) {
+        // a single coefficient is the ratio of the sums, no factorisation needed
+        if (normalMatrix[0] > 0) {
+            coefficients[0] = normalVector[0] / normalMatrix[0];
+        }
+        return coefficients;
+    }
+    if (!solveByCholesky(coefficients)) {
+        usedQr = true;
+        solveByQr(describingValues, describedValues, weights, coefficients);
+    }
+    return coefficients;
+}
+
+bool WeightedLeastSquares::lastSolveUsedQr() const {
+    return usedQr;
+}
+
+std::vector<std::vector<double>> WeightedLeastSquares::solveBatch(const std::vector<Problem>& problems,
+                                                                  ThreadPool* threadPool) {
+    std::vector<std::vector<double>> coefficients(problems.size());
+    // every range has a solver of its own, so the workspace is allocated once per range, not per problem
+    auto solveRange = [&problems, &coefficients](std::size_t first, std::size_t last) {
+        WeightedLeastSquares solver;
+        for (std::size_t problem = first; problem < last; ++problem) {
+            coefficients[problem] = solver.solve(problems[problem].describingValues,
+                                                 problems[problem].describedValues,
+                                                 problems[problem].weights);
+        }
+    };
+    if (threadPool == nullptr || problems.size() < 2) {
+        solveRange(0, problems.size());
+        return coefficients;
+    }
+    const std::size_t numberOfRanges = std::min<std::size_t>(threadPool->getNumberOfThreads(), problems.size());
+    std::vector<std::future<void>> solvedRanges;
+    solvedRanges.reserve(numberOfRanges);
+    for (std::size_t range = 0; range < numberOfRanges; ++range) {
+        const std::size_t first = problems.size() * range / numberOfRanges;
+        const std::size_t last = problems.size() * (range + 1) / numberOfRanges;
+        solvedRanges.push_back(threadPool->submit([&solveRange, first, last]() { solveRange(first, last); }));
+    }
+    for (auto& solvedRange : solvedRanges) {
+        solvedRange.get();
+    }
+    return coefficients;
+}
+
+void WeightedLeastSquares::validate(const MatrixView<const double>& describingValues,
+                                    const MatrixView<const double>& describedValues,
+                                    const std::vector<double>& weights) {
+    const std::size_t numberOfRows = describingValues.getNumberOfRows();
+    if (describedValues.getNumberOfColumns() != 1 || describedValues.getNumberOfRows() != numberOfRows) {
+        throw std::invalid_argument("Described values have to be a single column with one value per row");
+    }
+    if (weights.size() != numberOfRows) {
+        throw std::invalid_argument("Number of weights has to be equal to number of rows");
+    }
+    if (std::any_of(weights.begin(), weights.end(), [](double weight) { return !(weight >= 0); })) {
+        throw std::invalid_argument("Weights have to be non-negative numbers");
+    }
+}
+
+void WeightedLeastSquares::accumulateNormalEquations(const MatrixView<const double>& describingValues,
+                                                     const MatrixView<const double>& describedValues,
+                                                     const std::vector<double>& weights) {
+    const std::size_t numberOfRows = describingValues.getNumberOfRows();
+    const std::size_t numberOfCoefficients = describingValues.getNumberOfColumns();
+    normalMatrix.assign(numberOfCoefficients * numberOfCoefficients, 0.0);
+    normalVector.assign(numberOfCoefficients, 0.0);
+    // only the upper triangle is accumulated, it is mirrored afterwards
+    for (std::size_t row = 0; row < numberOfRows; ++row) {
+        const double weight = weights[row];
+        if (weight == 0) {
+            continue;
+        }
+        const double describedValue = describedValues(row, 0);
+        for (std::size_t first = 0; first < numberOfCoefficients; ++first) {
+            const double weightedValue = weight * describingValues(row, first);
+            double* normalRow = normalMatrix.data() + first * numberOfCoefficients;
+            for (std::size_t second = first; second < numberOfCoefficients; ++second) {
+                normalRow[second] += weightedValue * describingValues(row, second);
+            }
+            normalVector[first] += weightedValue * describedValue;
+        }
+    }
+    for (std::size_t first = 0; first < numberOfCoefficients; ++first) {
+        for (std::size_t second = 0; second < first; ++second) {
+            normalMatrix[first * numberOfCoefficients + second] = normalMatrix[second * numberOfCoefficients + first];
+        }
+    }
+}
+
+bool WeightedLeastSquares::solveByCholesky(std::vector<double>& coefficients) {
+    const std::size_t numberOfCoefficients = normalVector.size();
+    double* matrix = normalMatrix.data();
+    // scaling to a unit diagonal makes the pivots comparable with a single tolerance
+    scales.resize(numberOfCoefficients);
+    for (std::size_t i = 0; i < numberOfCoefficients; ++i) {
+        const double diagonal = matrix[i * numberOfCoefficients + i];
+        if (!(diagonal > 0) || !std::isfinite(diagonal)) {
+            return false;
+        }
+        scales[i] = 1.0 / std::sqrt(diagonal);
+    }
+    for (std::size_t row = 0; row < numberOfCoefficients; ++row) {
+        for (std::size_t column = 0; column <= row; ++column) {
+            matrix[row * numberOfCoefficients + column] *= scales[row] * scales[column];
+        }
+    }
+    if (numberOfCoefficients <= MAX_UNROLLED_COEFFICIENTS) {
+        return unrolledFactorisations[numberOfCoefficients - 2](numberOfCoefficients, matrix, normalVector.data(),
+                                                                 scales.data(), coefficients.data());
+    }
+    return factoriseAndSolve<0>(numberOfCoefficients, matrix, normalVector.data(), scales.data(), coefficients.data());
+}
+
+void WeightedLeastSquares::solveByQr(const MatrixView<const double>& describingValues,
+                                     const MatrixView<const double>& describedValues,
+                                     const std::vector<double>& weights,
+                                     std::vector<double>& coefficients) {
+    const std::size_t numberOfCoefficients = describingValues.getNumberOfColumns();
+    std::fill(coefficients.begin(), coefficients.end(), 0.0);
+
+    // column-major sqrt(W) [X | y] without the rows of zero weight, the last column is the right-hand side
+    std::size_t numberOfRows = 0;
+    for (double weight : weights) {
+        numberOfRows += weight > 0 ? 1 : 0;
+    }
+    const std::size_t numberOfColumns = numberOfCoefficients + 1;
+    weightedRows.resize(numberOfRows * numberOfColumns);
+    for (std::size_t row = 0, weightedRow = 0; row < weights.size(); ++row) {
+        if (!(weights[row] > 0)) {
+            continue;
+        }
+        const double rootOfWeight = std::sqrt(weights[row]);
+        for (std::size_t column = 0; column < numberOfCoefficients; ++column) {
+            weightedRows[column * numberOfRows + weightedRow] = rootOfWeight * describingValues(row, column);
+        }
+        weightedRows[numberOfCoefficients * numberOfRows + weightedRow] = rootOfWeight * describedValues(row, 0);
+        ++weightedRow;
+    }
+    columnOrder.resize(numberOfCoefficients);
+    for (std::size_t column = 0; column < numberOfCoefficients; ++column) {
+        columnOrder[column] = column;
+    }
+
+    auto columnData = [this, numberOfRows](std::size_t column) { return weightedRows.data() + column * numberOfRows; };
+    auto remainingSquaredNorm = [&columnData](std::size_t column, std::size_t firstRow, std::size_t lastRow) {
+        const double* values = columnData(column);
+        double squaredNorm = 0;
+        for (std::size_t row = firstRow; row < lastRow; ++row) {
+            squaredNorm += values[row] * values[row];
+        }
+        return squaredNorm;
+    };
+
+    const std::size_t maximalRank = std::min(numberOfRows, numberOfCoefficients);
+    std::size_t rank = 0;
+    double firstDiagonal = 0;
+    for (std::size_t step = 0; step < maximalRank; ++step) {
+        // the column with the largest remaining norm goes next, dependent columns end up last
+        std::size_t pivotColumn = step;
+        double pivotSquaredNorm = remainingSquaredNorm(step, step, numberOfRows);
+        for (std::size_t column = step + 1; column < numberOfCoefficients; ++column) {
+            const double squaredNorm = remainingSquaredNorm(column, step, numberOfRows);
+            if (squaredNorm > pivotSquaredNorm) {
+                pivotColumn = column;
+                pivotSquaredNorm = squaredNorm;
+            }
+        }
+        if (pivotColumn != step) {
+            std::swap_ranges(columnData(step), columnData(step) + numberOfRows, columnData(pivotColumn));
+            std::swap(columnOrder[step], columnOrder[pivotColumn]);
+        }
+        const double norm = std::sqrt(pivotSquaredNorm);
+        if (step == 0) {
+            firstDiagonal = norm;
+        }
+        if (!(norm > RANK_TOLERANCE * firstDiagonal) || norm == 0) {
+            break;
+        }
+
+        // Householder reflection H = I - v v^T / (v^T v / 2) with v stored in place of the column
+        double* reflector = columnData(step);
+        const double diagonal = reflector[step] > 0 ? -norm : norm;
+        reflector[step] -= diagonal;
+        double reflectorSquaredNorm = 0;
+        for (std::size_t row = step; row < numberOfRows; ++row) {
+            reflectorSquaredNorm += reflector[row] * reflector[row];
+        }
+        for (std::size_t column = step + 1; column < numberOfColumns; ++column) {
+            double* values = columnData(column);
+            double projection = 0;
+            for (std::size_t row = step; row < numberOfRows; ++row) {
+                projection += reflector[row] * values[row];
+            }
+            const double factor = 2 * projection / reflectorSquaredNorm;
+            for (std::size_t row = step; row < numberOfRows; ++row) {
+                values[row] -= factor * reflector[row];
+            }
+        }
+        reflector[step] = diagonal;
+        ++rank;
+    }
+
+    // R b = Q^T y on the leading independent columns, coefficients of the others stay zero
+    const double* rightHandSide = columnData(numberOfCoefficients);
+    std::vector<double> permutedCoefficients(rank);
+    for (std::size_t row = rank; row-- > 0;) {
+        double value = rightHandSide[row];
+        for (std::size_t column = row + 1; column < rank; ++column) {
+            value -= columnData(column)[row] * permutedCoefficients[column];
+        }
+        permutedCoefficients[row] = value / columnData(row)[row];
+    }
+    for (std::size_t column = 0; column < rank; ++column) {
+        coefficients[columnOrder[column]] = permutedCoefficients[column];
+    }
+}
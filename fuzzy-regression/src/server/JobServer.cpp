@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define FUZZY_REGRESSION_HAS_UNIX_SOCKETS 1
+#endif
+
+#include "server/JobServer.hpp"
+
+namespace {
+    const char* const WHITESPACE = " \t\r\n";
+
+    std::string trim(const std::string& text) {
+        const std::size_t first = text.find_first_not_of(WHITESPACE);
+        if (first == std::string::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(WHITESPACE) - first + 1);
+    }
+
+    std::string escapeJson(const std::string& text) {
+        std::ostringstream escaped;
+        for (const char character : text) {
+            switch (character) {
+                case '"': escaped << "\\\""; break;
+                case '\\': escaped << "\\\\"; break;
+                case '\n': escaped << "\\n"; break;
+                case '\t': escaped << "\\t"; break;
+                default:
+                    if ((unsigned char) character < 0x20) {
+                        escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) character
+                                << std::dec << std::setfill(' ');
+                    } else {
+                        escaped << character;
+                    }
+            }
+        }
+        return escaped.str();
+    }
+
+    // only what jobs and their answers need: one object of string, number and literal values, no nesting;
+    // with numberArrays an array of numbers is kept as its text including the brackets
+    std::map<std::string, std::string> parseFlatJsonObject(const std::string& text, bool numberArrays = false) {
+        std::map<std::string, std::string> fields;
+        std::size_t position = 1;
+        auto skipWhitespace = [&text, &position]() {
+            position = std::min(text.find_first_not_of(WHITESPACE, position), text.size());
+        };
+        auto readString = [&text, &position]() {
+            std::string value;
+            for (++position; position < text.size() && text[position] != '"'; ++position) {
+                if (text[position] == '\\' && position + 1 < text.size()) {
+                    ++position;
+                    value += text[position] == 'n' ? '\n' : text[position] == 't' ? '\t' : text[position];
+                } else {
+                    value += text[position];
+                }
+            }
+            if (position >= text.size()) {
+                throw std::invalid_argument("Unterminated string");
+            }
+            ++position;
+            return value;
+        };
+        skipWhitespace();
+        while (position < text.size() && text[position] != '}') {
+            if (text[position] != '"') {
+                throw std::invalid_argument("Expected a quoted key");
+            }
+            const std::string key = readString();
+            skipWhitespace();
+            if (position >= text.size() || text[position] != ':') {
+                throw std::invalid_argument("Expected ':' after \"" + key + "\"");
+            }
+            ++position;
+            skipWhitespace();
+            if (position < text.size() && text[position] == '"') {
+                fields[key] = readString();
+            } else if (numberArrays && position < text.size() && text[position] == '[') {
+                const std::size_t end = text.find(']', position);
+                if (end == std::string::npos) {
+                    throw std::invalid_argument("Unterminated array");
+                }
+                fields[key] = text.substr(position, end + 1 - position);
+                position = end + 1;
+            } else {
+                const std::size_t end = std::min(text.find_first_of(",}", position), text.size());
+                fields[key] = trim(text.substr(position, end - position));
+                if (fields[key].empty() || fields[key].front() == '{' || fields[key].front() == '[') {
+                    throw std::invalid_argument("Value of \"" + key + "\" has to be a string or a number");
+                }
+                position = end;
+            }
+            skipWhitespace();
+            if (position < text.size() && text[position] == ',') {
+                ++position;
+                skipWhitespace();
+            }
+        }
+        if (position >= text.size()) {
+            throw std::invalid_argument("Expected '}'");
+        }
+        return fields;
+    }
+
+    std::map<std::string, std::string> parseKeyValuePairs(const std::string& text) {
+        std::map<std::string, std::string> fields;
+        std::istringstream pairs(text);
+        for (std::string pair; pairs >> pair;) {
+            const std::size_t separator = pair.find('=');
+            if (separator == std::string::npos || separator == 0) {
+                throw std::invalid_argument("Expected key=value instead of \"" + pair + "\"");
+            }
+            fields[pair.substr(0, separator)] = pair.substr(separator + 1);
+        }
+        return fields;
+    }
+
+    int parseNumberOfClusters(const std::string& text) {
+        std::size_t parsedLength = 0;
+        const int numberOfClusters = std::stoi(text, &parsedLength);
+        if (parsedLength != text.size()) {
+            throw std::invalid_argument("Malformed number of clusters \"" + text + "\"");
+        }
+        return numberOfClusters;
+    }
+
+    std::vector<double> parseNumberArray(const std::string& text) {
+        std::vector<double> numbers;
+        std::istringstream values(text.substr(1, text.size() - 2));
+        for (std::string value; std::getline(values, value, ',');) {
+            std::size_t parsedLength = 0;
+            const std::string trimmedValue = trim(value);
+            numbers.push_back(std::stod(trimmedValue, &parsedLength));
+            if (parsedLength != trimmedValue.size()) {
+                throw std::invalid_argument("Malformed number \"" + trimmedValue + "\"");
+            }
+        }
+        return numbers;
+    }
+}
+
+JobServer::JobServer(ThreadPool& workers, JobPreparation prepareJob, JobCompletion finishJob)
+: workers(workers),
+prepareJob(std::move(prepareJob)),
+finishJob(std::move(finishJob)){}
+
+void JobServer::serveStream(std::istream& input, std::ostream& output) {
+    serveConnection([&input](std::string& line) { return (bool) std::getline(input, line); },
+                    [&output](const std::string& line) { output << line << std::endl; });
+}
+
+void JobServer::serveSocket(const std::filesystem::path& socketPath) {
+#ifdef FUZZY_REGRESSION_HAS_UNIX_SOCKETS
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.string().size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path " + socketPath.string() + " is too long");
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    // a socket left behind by a server which did not shut down cleanly would make bind fail
+    if (std::filesystem::is_socket(socketPath)) {
+        std::filesystem::remove(socketPath);
+    }
+    const int serverSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (serverSocket < 0) {
+        throw std::runtime_error(std::string("Could not create socket: ") + strerror(errno));
+    }
+    if (::bind(serverSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(serverSocket, SOMAXCONN) != 0) {
+        const std::string error = strerror(errno);
+        ::close(serverSocket);
+        throw std::runtime_error("Could not listen on " + socketPath.string() + ": " + error);
+    }
+    {
+        std::lock_guard<std::mutex> lock(socketsMutex);
+        listeningSocket = serverSocket;
+    }
+
+    while (!stopping) {
+        const int clientSocket = ::accept(serverSocket, nullptr, nullptr);
+        if (clientSocket < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(socketsMutex);
+            if (stopping) {
+                ::close(clientSocket);
+                break;
+            }
+            clientSockets.insert(clientSocket);
+            ++numberOfConnections;
+        }
+        std::thread([this, clientSocket]() {
+            std::string pendingInput;
+            auto readLine = [clientSocket, &pendingInput](std::string& line) {
+                std::size_t lineEnd;
+                while ((lineEnd = pendingInput.find('\n')) == std::string::npos) {
+                    char buffer[4096];
+                    const ssize_t received = ::recv(clientSocket, buffer, sizeof(buffer), 0);
+                    if (received < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (received <= 0) {
+                        line = std::move(pendingInput);
+                        pendingInput.clear();
+                        return !line.empty();
+                    }
+                    pendingInput.append(buffer, (std::size_t) received);
+                }
+                line = pendingInput.substr(0, lineEnd);
+                pendingInput.erase(0, lineEnd + 1);
+                return true;
+            };
+            auto writeLine = [clientSocket](const std::string& line) {
+#ifdef MSG_NOSIGNAL
+                const int flags = MSG_NOSIGNAL;
+#else
+                const int flags = 0;
+#endif
+                const std::string terminatedLine = line + "\n";
+                // a client which went away only loses its answers
+                for (std::size_t sent = 0; sent < terminatedLine.size();) {
+                    const ssize_t written = ::send(clientSocket, terminatedLine.data() + sent,
+                                                   terminatedLine.size() - sent, flags);
+                    if (written < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (written <= 0) {
+                        return;
+                    }
+                    sent += (std::size_t) written;
+                }
+            };
+            serveConnection(readLine, writeLine);
+            // closed while still in clientSockets, so accept cannot hand out the same descriptor before it is erased;
+            // notifying under the lock keeps the server alive until this thread no longer touches it
+            std::lock_guard<std::mutex> lock(socketsMutex);
+            ::close(clientSocket);
+            clientSockets.erase(clientSocket);
+            --numberOfConnections;
+            connectionFinished.notify_all();
+        }).detach();
+    }
+    {
+        std::unique_lock<std::mutex> lock(socketsMutex);
+        connectionFinished.wait(lock, [this]() { return numberOfConnections == 0; });
+        listeningSocket = -1;
+    }
+    ::close(serverSocket);
+    std::filesystem::remove(socketPath);
+#else
+    (void) socketPath;
+    throw std::runtime_error("Unix domain sockets are not available on this platform, serve standard input instead");
+#endif
+}
+
+RegressionJob JobServer::parseJob(const std::string& line) {
+    const std::string trimmedLine = trim(line);
+    const std::map<std::string, std::string> fields = !trimmedLine.empty() && trimmedLine.front() == '{'
+            ? parseFlatJsonObject(trimmedLine)
+            : parseKeyValuePairs(trimmedLine);
+    RegressionJob job{{}, {}, 0, 0, std::nullopt, std::nullopt};
+    for (const auto& [key, value] : fields) {
+        if (key == "id") {
+            job.id = value;
+        } else if (key == "file") {
+            job.dataFilePath = value;
+        } else if (key == "clusters") {
+            const std::size_t separator = value.find('-', 1);
+            job.firstNumberOfClusters = parseNumberOfClusters(value.substr(0, separator));
+            job.lastNumberOfClusters = separator == std::string::npos
+                    ? job.firstNumberOfClusters
+                    : parseNumberOfClusters(value.substr(separator + 1));
+        } else if (key == "epsilon") {
+            job.epsilon = std::stod(value);
+            if (!(*job.epsilon > 0)) {
+                throw std::invalid_argument("Epsilon has to be positive");
+            }
+        } else if (key == "engine") {
+            if (value != "native" && value != "ksi") {
+                throw std::invalid_argument("Engine has to be native or ksi");
+            }
+            job.clusteringEngine = value == "native" ? ClusteringEngine::NATIVE : ClusteringEngine::KSI;
+        } else {
+            throw std::invalid_argument("Unknown key \"" + key + "\"");
+        }
+    }
+    if (job.dataFilePath.empty()) {
+        throw std::invalid_argument("Job has no file");
+    }
+    if (job.firstNumberOfClusters < 1 || job.lastNumberOfClusters < job.firstNumberOfClusters) {
+        throw std::invalid_argument("Clusters have to be a positive count N or a range N-M with N <= M");
+    }
+    if (job.lastNumberOfClusters - job.firstNumberOfClusters >= MAX_CLUSTER_COUNTS_PER_JOB) {
+        throw std::invalid_argument("A job can ask for at most " + std::to_string(MAX_CLUSTER_COUNTS_PER_JOB)
+                                    + " cluster counts");
+    }
+    return job;
+}
+
+std::string JobServer::formatJob(const RegressionJob& job) {
+    std::ostringstream request;
+    request << std::setprecision(std::numeric_limits<double>::max_digits10)
+            << "{\"id\": \"" << escapeJson(job.id) << "\", \"file\": \"" << escapeJson(job.dataFilePath.string())
+            << "\", \"clusters\": \"" << job.firstNumberOfClusters;
+    if (job.lastNumberOfClusters != job.firstNumberOfClusters) {
+        request << "-" << job.lastNumberOfClusters;
+    }
+    request << "\"";
+    if (job.epsilon.has_value()) {
+        request << ", \"epsilon\": " << *job.epsilon;
+    }
+    if (job.clusteringEngine.has_value()) {
+        request << ", \"engine\": \"" << (*job.clusteringEngine == ClusteringEngine::KSI ? "ksi" : "native") << "\"";
+    }
+    request << "}";
+    return request.str();
+}
+
+std::string JobServer::formatClusterRun(const std::string& jobId, int numberOfClusters, const ServedClusterRun& clusterRun) {
+    std::ostringstream response;
+    response << std::setprecision(std::numeric_limits<double>::max_digits10)
+             << "{\"id\": \"" << escapeJson(jobId) << "\", \"clusters\": " << numberOfClusters << ", \"coefficients\": [";
+    const std::vector<double>& coefficients = clusterRun.regressionResult.regressionDescribingParameters;
+    for (std::size_t i = 0; i < coefficients.size(); ++i) {
+        response << (i > 0 ? ", " : "") << coefficients[i];
+    }
+    response << "], \"regressionError\": " << clusterRun.regressionResult.coefficientOfDetermination
+             << ", \"iterations\": " << clusterRun.numberOfIterations
+             << ", \"cached\": " << (clusterRun.servedFromCache ? "true" : "false")
+             << ", \"performance\": \"" << escapeJson(clusterRun.performanceRecord) << "\"}";
+    return response.str();
+}
+
+std::string JobServer::formatError(const std::string& jobId, const std::string& message) {
+    return "{\"id\": \"" + escapeJson(jobId) + "\", \"error\": \"" + escapeJson(message) + "\"}";
+}
+
+JobResponse JobServer::parseResponse(const std::string& line) {
+    const std::string trimmedLine = trim(line);
+    if (trimmedLine.empty() || trimmedLine.front() != '{') {
+        throw std::invalid_argument("Answer has to be a JSON object");
+    }
+    const std::map<std::string, std::string> fields = parseFlatJsonObject(trimmedLine, true);
+    auto field = [&fields](const std::string& key) -> const std::string* {
+        const auto value = fields.find(key);
+        return value == fields.end() ? nullptr : &value->second;
+    };
+    JobResponse response{field("id") != nullptr ? *field("id") : std::string(), std::nullopt, std::nullopt,
+                         std::nullopt, field("done") != nullptr && *field("done") == "true"};
+    if (const std::string* error = field("error")) {
+        response.error = *error;
+    } else if (field("coefficients") != nullptr) {
+        if (field("clusters") == nullptr || field("regressionError") == nullptr || field("iterations") == nullptr) {
+            throw std::invalid_argument("Answer for a cluster count is incomplete");
+        }
+        response.numberOfClusters = parseNumberOfClusters(*field("clusters"));
+        response.clusterRun.emplace(ServedClusterRun{
+                RegressionResult{parseNumberArray(*field("coefficients")), std::stod(*field("regressionError"))},
+                std::stoi(*field("iterations")),
+                field("cached") != nullptr && *field("cached") == "true",
+                field("performance") != nullptr ? *field("performance") : std::string()});
+    } else if (!response.done) {
+        throw std::invalid_argument("Answer is neither a result, an error nor the end of a job");
+    }
+    return response;
+}
+
+void JobServer::serveConnection(const std::function<bool(std::string&)>& readLine,
+                                const std::function<void(const std::string&)>& writeLine) {
+    std::mutex writeMutex;
+    const std::function<void(const std::string&)> respond = [&writeMutex, &writeLine](const std::string& response) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        writeLine(response);
+    };
+    // cluster counts still running answer through respond, so the connection waits for them before it ends
+    std::vector<std::future<void>> runningClusterCounts;
+    std::string line;
+    while (!stopping && readLine(line)) {
+        const std::string request = trim(line);
+        if (request.empty()) {
+            continue;
+        }
+        if (request == "shutdown") {
+            stop();
+            break;
+        }
+        startJob(request, respond, runningClusterCounts);
+        runningClusterCounts.erase(std::remove_if(runningClusterCounts.begin(), runningClusterCounts.end(),
+                                                  [](const std::future<void>& clusterCount) {
+                                                      return clusterCount.wait_for(std::chrono::seconds(0))
+                                                             == std::future_status::ready;
+                                                  }),
+                                   runningClusterCounts.end());
+    }
+    for (auto& clusterCount : runningClusterCounts) {
+        clusterCount.wait();
+    }
+}
+
+void JobServer::startJob(const std::string& line,
+                         const std::function<void(const std::string&)>& respond,
+                         std::vector<std::future<void>>& runningClusterCounts) {
+    RegressionJob job{{}, {}, 0, 0, std::nullopt, std::nullopt};
+    ClusterCountRunner runCount;
+    try {
+        job = parseJob(line);
+        runCount = prepareJob(job);
+    } catch (const std::exception& exception) {
+        respond(formatError(job.id, exception.what()));
+        return;
+    }
+    struct JobProgress{
+        std::atomic<int> remainingClusterCounts;
+        std::atomic<int> failedClusterCounts{0};
+    };
+    const int numberOfClusterCounts = job.lastNumberOfClusters - job.firstNumberOfClusters + 1;
+    const auto progress = std::make_shared<JobProgress>();
+    progress->remainingClusterCounts = numberOfClusterCounts;
+    const auto sharedJob = std::make_shared<const RegressionJob>(std::move(job));
+    // largest cluster counts take longest, queued first they do not end up at the tail of the job
+    for (int numberOfClusters = sharedJob->lastNumberOfClusters;
+         numberOfClusters >= sharedJob->firstNumberOfClusters;
+         --numberOfClusters) {
+        runningClusterCounts.push_back(workers.submit(
+                [this, sharedJob, runCount, numberOfClusters, numberOfClusterCounts, progress, &respond]() {
+                    try {
+                        respond(formatClusterRun(sharedJob->id, numberOfClusters, runCount(numberOfClusters)));
+                    } catch (const std::exception& exception) {
+                        progress->failedClusterCounts++;
+                        respond(formatError(sharedJob->id, std::to_string(numberOfClusters) + " clusters: "
+                                                           + exception.what()));
+                    }
+                    if (--progress->remainingClusterCounts == 0) {
+                        respond("{\"id\": \"" + escapeJson(sharedJob->id) + "\", \"done\": true, \"clusterCounts\": "
+                                + std::to_string(numberOfClusterCounts) + ", \"failed\": "
+                                + std::to_string(progress->failedClusterCounts) + "}");
+                        if (finishJob) {
+                            try {
+                                finishJob(*sharedJob);
+                            } catch (const std::exception&) {
+                                // the job was answered already, a failed clean-up is retried after the next one
+                            }
+                        }
+                    }
+                }));
+    }
+}
+
+void JobServer::stop() {
+    stopping = true;
+#ifdef FUZZY_REGRESSION_HAS_UNIX_SOCKETS
+    // wakes accept and the reads of other connections, answers to queued jobs are still written
+    std::lock_guard<std::mutex> lock(socketsMutex);
+    if (listeningSocket >= 0) {
+        ::shutdown(listeningSocket, SHUT_RDWR);
+    }
+    for (const int clientSocket : clientSockets) {
+        ::shutdown(clientSocket, SHUT_RD);
+    }
+#endif
+}
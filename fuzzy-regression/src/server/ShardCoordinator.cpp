@@ -0,0 +1,178 @@
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "server/ShardCoordinator.hpp"
+
+bool ShardCoordinator::LowerPriority::operator()(const QueuedShard& first, const QueuedShard& second) const {
+    if (first.expectedCost != second.expectedCost) {
+        return first.expectedCost < second.expectedCost;
+    }
+    // equally expensive shards are handed out in submission order
+    return first.shardNumber > second.shardNumber;
+}
+
+ShardCoordinator::ShardCoordinator(unsigned int numberOfWorkers,
+                                   unsigned int shardsPerWorker,
+                                   ConnectWorker connectWorker)
+: connectWorker(std::move(connectWorker)),
+numberOfWorkers(numberOfWorkers == 0 ? 1 : numberOfWorkers),
+shardsPerWorker(shardsPerWorker == 0 ? 1 : shardsPerWorker),
+runningWorkers(this->numberOfWorkers) {
+    workers.reserve(this->numberOfWorkers);
+    for (unsigned int workerNumber = 0; workerNumber < this->numberOfWorkers; ++workerNumber) {
+        workers.emplace_back([this, workerNumber]() { runWorker(workerNumber); });
+    }
+}
+
+ShardCoordinator::~ShardCoordinator() {
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        stopping = true;
+    }
+    shardsChanged.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::future<ServedClusterRun> ShardCoordinator::submit(const Shard& shard, double expectedCost) {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    std::promise<ServedClusterRun> result;
+    std::future<ServedClusterRun> futureResult = result.get_future();
+    if (runningWorkers == 0) {
+        result.set_exception(std::make_exception_ptr(std::runtime_error("No worker is left to run the shard")));
+        return futureResult;
+    }
+    const unsigned long shardNumber = submittedShards++;
+    pendingShards.emplace(shardNumber, PendingShard{shard, std::move(result), expectedCost, 0});
+    queuedShards.push(QueuedShard{expectedCost, shardNumber});
+    shardsChanged.notify_all();
+    return futureResult;
+}
+
+unsigned int ShardCoordinator::getMaximalNumberOfShardsInFlight() const {
+    return numberOfWorkers * shardsPerWorker;
+}
+
+void ShardCoordinator::runWorker(unsigned int workerNumber) {
+    int connectionsWithoutAnswer = 0;
+    while (connectionsWithoutAnswer < MAXIMAL_NUMBER_OF_ATTEMPTS) {
+        try {
+            const std::unique_ptr<WorkerConnection> connection = connectWorker(workerNumber);
+            connectionsWithoutAnswer = serveConnection(*connection) > 0 ? 0 : connectionsWithoutAnswer + 1;
+        } catch (const std::exception& exception) {
+            std::cout << "Could not connect worker " << workerNumber << ": " << exception.what() << "\n";
+            ++connectionsWithoutAnswer;
+        }
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        if (stopping) {
+            return;
+        }
+        std::cout << "Worker " << workerNumber << " ended its connection, connecting it again\n";
+    }
+    std::cout << "Worker " << workerNumber << " keeps failing, it is not connected again\n";
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    if (--runningWorkers > 0) {
+        return;
+    }
+    for (auto& [shardNumber, pendingShard] : pendingShards) {
+        pendingShard.result.set_exception(std::make_exception_ptr(
+                std::runtime_error("No worker is left to run the shard")));
+    }
+    pendingShards.clear();
+    queuedShards = decltype(queuedShards)();
+}
+
+std::size_t ShardCoordinator::serveConnection(WorkerConnection& connection) {
+    std::set<unsigned long> shardsInFlight;
+    bool connectionLost = false;
+    std::thread sender([this, &connection, &shardsInFlight, &connectionLost]() {
+        std::unique_lock<std::mutex> lock(shardsMutex);
+        while (true) {
+            shardsChanged.wait(lock, [this, &shardsInFlight, &connectionLost]() {
+                return stopping || connectionLost
+                       || (!queuedShards.empty() && shardsInFlight.size() < shardsPerWorker);
+            });
+            if (stopping || connectionLost) {
+                break;
+            }
+            const unsigned long shardNumber = queuedShards.top().shardNumber;
+            queuedShards.pop();
+            shardsInFlight.insert(shardNumber);
+            const Shard& shard = pendingShards.at(shardNumber).shard;
+            const std::string job = JobServer::formatJob(RegressionJob{std::to_string(shardNumber), shard.dataFilePath,
+                                                                       shard.numberOfClusters, shard.numberOfClusters,
+                                                                       std::nullopt, std::nullopt});
+            lock.unlock();
+            const bool written = connection.writeLine(job);
+            lock.lock();
+            // the shards in flight are queued again once the reader sees the connection end
+            if (!written) {
+                break;
+            }
+        }
+        lock.unlock();
+        // the worker answers the shards in flight and ends the connection, which ends the reader
+        connection.closeForWriting();
+    });
+
+    std::size_t numberOfAnswers = 0;
+    std::string line;
+    while (connection.readLine(line)) {
+        std::optional<JobResponse> response;
+        try {
+            response.emplace(JobServer::parseResponse(line));
+        } catch (const std::exception& exception) {
+            std::cout << "Ignoring answer of a worker: " << exception.what() << "\n";
+            continue;
+        }
+        // a shard is answered by its result or error, the end of its job says nothing more
+        if (response->done && !response->error.has_value()) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        const auto shardInFlight = shardsInFlight.find(std::strtoul(response->id.c_str(), nullptr, 10));
+        if (shardInFlight == shardsInFlight.end()) {
+            continue;
+        }
+        resolveShard(*shardInFlight, *response);
+        shardsInFlight.erase(shardInFlight);
+        ++numberOfAnswers;
+        shardsChanged.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        connectionLost = true;
+        for (const unsigned long shardNumber : shardsInFlight) {
+            PendingShard& pendingShard = pendingShards.at(shardNumber);
+            if (++pendingShard.numberOfAttempts < MAXIMAL_NUMBER_OF_ATTEMPTS) {
+                queuedShards.push(QueuedShard{pendingShard.expectedCost, shardNumber});
+                continue;
+            }
+            pendingShard.result.set_exception(std::make_exception_ptr(std::runtime_error(
+                    "Workers died " + std::to_string(pendingShard.numberOfAttempts) + " times running "
+                    + std::to_string(pendingShard.shard.numberOfClusters) + " clusters of "
+                    + pendingShard.shard.dataFilePath.string())));
+            pendingShards.erase(shardNumber);
+        }
+        shardsInFlight.clear();
+    }
+    shardsChanged.notify_all();
+    sender.join();
+    return numberOfAnswers;
+}
+
+void ShardCoordinator::resolveShard(unsigned long shardNumber, const JobResponse& response) {
+    const auto pendingShard = pendingShards.find(shardNumber);
+    if (response.clusterRun.has_value()) {
+        pendingShard->second.result.set_value(*response.clusterRun);
+    } else {
+        pendingShard->second.result.set_exception(std::make_exception_ptr(
+                std::runtime_error(response.error.value_or("Worker gave no result"))));
+    }
+    pendingShards.erase(pendingShard);
+}
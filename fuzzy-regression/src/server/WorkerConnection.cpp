@@ -0,0 +1,122 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define FUZZY_REGRESSION_HAS_UNIX_SOCKETS 1
+extern char** environ;
+#endif
+
+#include "server/WorkerConnection.hpp"
+
+#ifdef FUZZY_REGRESSION_HAS_UNIX_SOCKETS
+LocalWorkerProcess::LocalWorkerProcess(const std::vector<std::string>& arguments) {
+    if (arguments.empty()) {
+        throw std::invalid_argument("Worker needs an executable");
+    }
+    // workers started later must not inherit the coordinator's ends of earlier pairs,
+    // dup2 below clears the flag on the standard input and output of the worker
+#ifdef SOCK_CLOEXEC
+    const int socketType = SOCK_STREAM | SOCK_CLOEXEC;
+#else
+    const int socketType = SOCK_STREAM;
+#endif
+    int sockets[2];
+    if (::socketpair(AF_UNIX, socketType, 0, sockets) != 0) {
+        throw std::runtime_error(std::string("Could not create socket pair: ") + strerror(errno));
+    }
+    ::fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init(&fileActions);
+    posix_spawn_file_actions_adddup2(&fileActions, sockets[1], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&fileActions, sockets[1], STDOUT_FILENO);
+    std::vector<char*> argumentValues;
+    for (const auto& argument : arguments) {
+        argumentValues.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argumentValues.push_back(nullptr);
+    pid_t spawnedProcessId;
+    const int spawnError = ::posix_spawn(&spawnedProcessId, arguments[0].c_str(), &fileActions, nullptr,
+                                         argumentValues.data(), environ);
+    posix_spawn_file_actions_destroy(&fileActions);
+    ::close(sockets[1]);
+    if (spawnError != 0) {
+        ::close(sockets[0]);
+        throw std::runtime_error("Could not start worker " + arguments[0] + ": " + strerror(spawnError));
+    }
+    workerSocket = sockets[0];
+    processId = spawnedProcessId;
+}
+
+LocalWorkerProcess::~LocalWorkerProcess() {
+    ::close(workerSocket);
+    int status;
+    while (::waitpid((pid_t) processId, &status, 0) < 0 && errno == EINTR) {}
+}
+
+bool LocalWorkerProcess::writeLine(const std::string& line) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    const std::string terminatedLine = line + "\n";
+    for (std::size_t sent = 0; sent < terminatedLine.size();) {
+        const ssize_t written = ::send(workerSocket, terminatedLine.data() + sent, terminatedLine.size() - sent, flags);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        sent += (std::size_t) written;
+    }
+    return true;
+}
+
+bool LocalWorkerProcess::readLine(std::string& line) {
+    std::size_t lineEnd;
+    while ((lineEnd = pendingInput.find('\n')) == std::string::npos) {
+        char buffer[4096];
+        const ssize_t received = ::recv(workerSocket, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            // an unterminated last line is cut off by a dying worker, it is not an answer
+            return false;
+        }
+        pendingInput.append(buffer, (std::size_t) received);
+    }
+    line = pendingInput.substr(0, lineEnd);
+    pendingInput.erase(0, lineEnd + 1);
+    return true;
+}
+
+void LocalWorkerProcess::closeForWriting() {
+    ::shutdown(workerSocket, SHUT_WR);
+}
+#else
+LocalWorkerProcess::LocalWorkerProcess(const std::vector<std::string>& arguments) {
+    (void) arguments;
+    throw std::runtime_error("Local workers need Unix domain sockets, which are not available on this platform");
+}
+
+LocalWorkerProcess::~LocalWorkerProcess() = default;
+
+bool LocalWorkerProcess::writeLine(const std::string&) {
+    return false;
+}
+
+bool LocalWorkerProcess::readLine(std::string&) {
+    return false;
+}
+
+void LocalWorkerProcess::closeForWriting() {}
+#endif
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "streams/BatchSource.hpp"
+#include "streams/TupleLines.hpp"
+
+MatrixBatchSource::MatrixBatchSource(const MatrixView<const double>& attributeMajorData, std::size_t batchSize)
+: attributeMajorData(attributeMajorData),
+batchSize(batchSize == 0 ? 1 : batchSize){}
+
+MatrixView<const double> MatrixBatchSource::nextBatch() {
+    const std::size_t numberOfData = attributeMajorData.getNumberOfColumns();
+    if (nextDatum >= numberOfData) {
+        return {};
+    }
+    const std::size_t batchLength = std::min(batchSize, numberOfData - nextDatum);
+    MatrixView<const double> batch(&attributeMajorData(0, nextDatum),
+                                   attributeMajorData.getNumberOfRows(),
+                                   batchLength,
+                                   attributeMajorData.getRowStride(),
+                                   attributeMajorData.getColumnStride());
+    nextDatum += batchLength;
+    return batch;
+}
+
+void MatrixBatchSource::rewind() {
+    nextDatum = 0;
+}
+
+std::size_t MatrixBatchSource::getNumberOfData() const {
+    return attributeMajorData.getNumberOfColumns();
+}
+
+std::size_t MatrixBatchSource::getNumberOfAttributes() const {
+    return attributeMajorData.getNumberOfRows();
+}
+
+TupleBatchReader::TupleBatchReader(const std::filesystem::path& inputPath, std::size_t batchSize)
+: inputPath(inputPath),
+batchSize(batchSize == 0 ? 1 : batchSize) {
+    countTuples();
+    batchBuffer.resize(this->batchSize * numberOfAttributes);
+    rewind();
+}
+
+TupleBatchReader::TupleBatchReader(const std::filesystem::path& inputPath, std::size_t batchSize,
+                                   std::size_t numberOfData, std::size_t numberOfAttributes)
+: inputPath(inputPath),
+batchSize(batchSize == 0 ? 1 : batchSize),
+numberOfData(numberOfData),
+numberOfAttributes(numberOfAttributes) {
+    batchBuffer.resize(this->batchSize * numberOfAttributes);
+    rewind();
+}
+
+MatrixView<const double> TupleBatchReader::nextBatch() {
+    std::size_t batchLength = 0;
+    while (batchLength < batchSize && std::getline(inputFile, line)) {
+        ++lineNumber;
+        const char* end = line.data() + line.size();
+        if (TupleLines::isBlank(line.data(), end)) {
+            continue;
+        }
+        std::string problem = TupleLines::parseValues(line.data(), end, numberOfAttributes,
+                                                      batchBuffer.data() + batchLength, batchSize);
+        if (!problem.empty()) {
+            throw std::runtime_error(inputPath.string() + " contains malformed lines\n"
+                                     + TupleLines::describeMalformedLine(lineNumber, problem));
+        }
+        ++batchLength;
+    }
+    if (batchLength == 0) {
+        return {};
+    }
+    return MatrixView<const double>(batchBuffer.data(), numberOfAttributes, batchLength, batchSize);
+}
+
+void TupleBatchReader::rewind() {
+    inputFile.close();
+    inputFile.clear();
+    inputFile.open(inputPath);
+    if (!inputFile.is_open()) {
+        throw std::runtime_error("Could not open " + inputPath.string());
+    }
+    lineNumber = 0;
+}
+
+std::size_t TupleBatchReader::getNumberOfData() const {
+    return numberOfData;
+}
+
+std::size_t TupleBatchReader::getNumberOfAttributes() const {
+    return numberOfAttributes;
+}
+
+void TupleBatchReader::countTuples() {
+    std::ifstream countingFile(inputPath);
+    if (!countingFile.is_open()) {
+        throw std::runtime_error("Could not open " + inputPath.string());
+    }
+    while (std::getline(countingFile, line)) {
+        const char* end = line.data() + line.size();
+        if (TupleLines::isBlank(line.data(), end)) {
+            continue;
+        }
+        if (numberOfData == 0) {
+            numberOfAttributes = TupleLines::countValues(line.data(), end);
+        }
+        ++numberOfData;
+    }
+}
@@ -0,0 +1,116 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "streams/ColumnarDatasetFile.hpp"
+
+namespace {
+    const char COLUMNAR_DATASET_MAGIC[8] = {'F', 'R', 'C', 'O', 'L', 'U', 'M', 'N'};
+    const std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    const std::uint64_t FNV_PRIME = 1099511628211ull;
+
+    std::uint64_t alignedColumnStride(std::uint64_t numberOfData) {
+        const std::uint64_t valuesPerAlignment = ColumnarDatasetFile::COLUMN_ALIGNMENT / sizeof(double);
+        return (numberOfData + valuesPerAlignment - 1) / valuesPerAlignment * valuesPerAlignment;
+    }
+}
+
+ColumnarDatasetSource ColumnarDatasetSource::describe(const std::filesystem::path& sourceFilePath) {
+    return ColumnarDatasetSource{(std::uint64_t) std::filesystem::file_size(sourceFilePath),
+                                 (std::int64_t) std::filesystem::last_write_time(sourceFilePath)
+                                         .time_since_epoch().count()};
+}
+
+ColumnarDatasetFile::ColumnarDatasetFile(const std::filesystem::path& filePath)
+: mappedFile(std::make_unique<MappedFile>(filePath)) {
+    if (mappedFile->getSize() < sizeof(ColumnarDatasetHeader)) {
+        throw std::runtime_error(filePath.string() + " is too small to be a columnar dataset");
+    }
+    std::memcpy(&header, mappedFile->getData(), sizeof(ColumnarDatasetHeader));
+    if (std::memcmp(header.magic, COLUMNAR_DATASET_MAGIC, sizeof(COLUMNAR_DATASET_MAGIC)) != 0) {
+        throw std::runtime_error(filePath.string() + " is not a columnar dataset");
+    }
+    if (header.version != FORMAT_VERSION || header.dataType != FLOAT64_DATA_TYPE) {
+        throw std::runtime_error(filePath.string() + " uses an unsupported columnar dataset version or data type");
+    }
+    if (header.numberOfAttributes == 0 || header.columnStride < header.numberOfData
+        || header.columnStride % (COLUMN_ALIGNMENT / sizeof(double)) != 0) {
+        throw std::runtime_error(filePath.string() + " has a malformed column layout");
+    }
+    // compared by division, the product of the header values could wrap around
+    const std::uint64_t storedValues = (mappedFile->getSize() - sizeof(ColumnarDatasetHeader)) / sizeof(double);
+    if (header.columnStride > storedValues / header.numberOfAttributes) {
+        throw std::runtime_error(filePath.string() + " is truncated");
+    }
+}
+
+MatrixView<const double> ColumnarDatasetFile::getAttributeMajorData() const {
+    const auto* columns = reinterpret_cast<const double*>(mappedFile->getData() + sizeof(ColumnarDatasetHeader));
+    return MatrixView<const double>(columns,
+                                    header.numberOfAttributes,
+                                    header.numberOfData,
+                                    header.columnStride);
+}
+
+const ColumnarDatasetHeader& ColumnarDatasetFile::getHeader() const {
+    return header;
+}
+
+bool ColumnarDatasetFile::hasValidChecksum() const {
+    return calculateChecksum(getAttributeMajorData()) == header.checksum;
+}
+
+bool ColumnarDatasetFile::isConvertedFrom(const std::filesystem::path& sourceFilePath) const {
+    const ColumnarDatasetSource source = ColumnarDatasetSource::describe(sourceFilePath);
+    return header.sourceFileSize == source.fileSize && header.sourceModificationTime == source.modificationTime;
+}
+
+void ColumnarDatasetFile::write(const std::filesystem::path& filePath,
+                                const MatrixView<const double>& attributeMajorData,
+                                const ColumnarDatasetSource& source) {
+    ColumnarDatasetHeader fileHeader{};
+    std::memcpy(fileHeader.magic, COLUMNAR_DATASET_MAGIC, sizeof(COLUMNAR_DATASET_MAGIC));
+    fileHeader.version = FORMAT_VERSION;
+    fileHeader.dataType = FLOAT64_DATA_TYPE;
+    fileHeader.numberOfData = attributeMajorData.getNumberOfColumns();
+    fileHeader.numberOfAttributes = attributeMajorData.getNumberOfRows();
+    fileHeader.columnStride = alignedColumnStride(fileHeader.numberOfData);
+    fileHeader.checksum = calculateChecksum(attributeMajorData);
+    fileHeader.sourceFileSize = source.fileSize;
+    fileHeader.sourceModificationTime = source.modificationTime;
+
+    std::ofstream outputFile(filePath, std::ios::binary | std::ios::trunc);
+    if (!outputFile.is_open()) {
+        throw std::runtime_error("Could not create " + filePath.string());
+    }
+    outputFile.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+    std::vector<double> column(fileHeader.columnStride, 0.0);
+    for (std::size_t attribute = 0; attribute < fileHeader.numberOfAttributes; ++attribute) {
+        for (std::size_t datum = 0; datum < fileHeader.numberOfData; ++datum) {
+            column[datum] = attributeMajorData(attribute, datum);
+        }
+        outputFile.write(reinterpret_cast<const char*>(column.data()),
+                         (std::streamsize) (column.size() * sizeof(double)));
+    }
+    if (!outputFile.good()) {
+        throw std::runtime_error("Could not write " + filePath.string());
+    }
+}
+
+std::uint64_t ColumnarDatasetFile::calculateChecksum(const MatrixView<const double>& attributeMajorData) {
+    // FNV-1a over whole 64 bit words, one multiplication per value keeps it far below parsing cost
+    std::uint64_t checksum = FNV_OFFSET_BASIS;
+    for (std::size_t attribute = 0; attribute < attributeMajorData.getNumberOfRows(); ++attribute) {
+        for (std::size_t datum = 0; datum < attributeMajorData.getNumberOfColumns(); ++datum) {
+            std::uint64_t word;
+            std::memcpy(&word, &attributeMajorData(attribute, datum), sizeof(word));
+            checksum = (checksum ^ word) * FNV_PRIME;
+        }
+    }
+    return checksum;
+}
+
+bool ColumnarDatasetFile::isColumnarDatasetFile(const std::filesystem::path& filePath) {
+    return filePath.extension() == FILE_EXTENSION;
+}
@@ -0,0 +1,65 @@
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FUZZY_REGRESSION_HAS_MMAP 1
+#endif
+
+#include "streams/MappedFile.hpp"
+
+MappedFile::MappedFile(const std::filesystem::path& filePath) {
+#ifdef FUZZY_REGRESSION_HAS_MMAP
+    int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Could not open " + filePath.string() + ": " + strerror(errno));
+    }
+    struct stat fileStatus{};
+    if (::fstat(fileDescriptor, &fileStatus) != 0) {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Could not stat " + filePath.string() + ": " + strerror(errno));
+    }
+    size = (std::size_t) fileStatus.st_size;
+    if (size > 0) {
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fileDescriptor);
+            throw std::runtime_error("Could not map " + filePath.string() + ": " + strerror(errno));
+        }
+        data = static_cast<const char*>(mapping);
+        mapped = true;
+    }
+    ::close(fileDescriptor);
+#else
+    std::ifstream inputFile(filePath, std::ios::binary | std::ios::ate);
+    if (!inputFile.is_open()) {
+        throw std::runtime_error("Could not open " + filePath.string());
+    }
+    size = (std::size_t) inputFile.tellg();
+    fallbackBuffer.resize(size);
+    inputFile.seekg(0);
+    inputFile.read(fallbackBuffer.data(), (std::streamsize) size);
+    data = fallbackBuffer.data();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef FUZZY_REGRESSION_HAS_MMAP
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+const char* MappedFile::getData() const {
+    return data;
+}
+
+std::size_t MappedFile::getSize() const {
+    return size;
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "concurrency/ThreadPool.hpp"
+#include "streams/MappedFile.hpp"
+#include "streams/TupleLines.hpp"
+#include "streams/TupleReader.hpp"
+
+namespace {
+    // chunks smaller than this are not worth a thread of their own
+    const std::size_t MINIMAL_CHUNK_SIZE = 1 << 20;
+
+    inline const char* findLineEnd(const char* lineBegin, const char* end) {
+        const void* newline = std::memchr(lineBegin, '\n', (std::size_t) (end - lineBegin));
+        return newline == nullptr ? end : static_cast<const char*>(newline);
+    }
+
+    inline const char* findNextLineBegin(const char* lineEnd, const char* end) {
+        return lineEnd < end ? lineEnd + 1 : end;
+    }
+
+    // the calling thread takes chunks as well, so a pool busy with other tasks only slows parsing down;
+    // helpers starting after every chunk was taken return without touching chunks, which may be gone by then
+    template<typename Chunk, typename Work>
+    void forEachChunkInParallel(std::vector<Chunk>& chunks, ThreadPool* threadPool, const Work& work) {
+        struct Progress{
+            std::atomic<std::size_t> nextChunk{0};
+            std::size_t finishedChunks = 0;
+            std::exception_ptr failure;
+            std::mutex mutex;
+            std::condition_variable allFinished;
+        };
+        const auto progress = std::make_shared<Progress>();
+        const std::size_t numberOfChunks = chunks.size();
+        auto takeChunks = [progress, numberOfChunks, &chunks, &work]() {
+            for (std::size_t chunk = progress->nextChunk++; chunk < numberOfChunks; chunk = progress->nextChunk++) {
+                std::exception_ptr failure;
+                try {
+                    work(chunks[chunk]);
+                } catch (...) {
+                    failure = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(progress->mutex);
+                if (failure != nullptr) {
+                    progress->failure = failure;
+                }
+                if (++progress->finishedChunks == numberOfChunks) {
+                    progress->allFinished.notify_all();
+                }
+            }
+        };
+        if (threadPool != nullptr && numberOfChunks > 1) {
+            const std::size_t numberOfHelpers = std::min<std::size_t>(numberOfChunks - 1,
+                                                                      threadPool->getNumberOfThreads());
+            for (std::size_t helper = 0; helper < numberOfHelpers; ++helper) {
+                threadPool->submit(takeChunks);
+            }
+        }
+        takeChunks();
+        std::unique_lock<std::mutex> lock(progress->mutex);
+        progress->allFinished.wait(lock, [&progress, numberOfChunks]() {
+            return progress->finishedChunks == numberOfChunks;
+        });
+        if (progress->failure != nullptr) {
+            std::rethrow_exception(progress->failure);
+        }
+    }
+}
+
+MatrixView<const double> ParsedTuples::getAttributeMajorData() const {
+    return MatrixView<const double>::rowMajor(attributeMajorData.data(), numberOfAttributes, numberOfData);
+}
+
+TupleReader::TupleReader(ThreadPool* threadPool, unsigned int numberOfThreads) noexcept
+: threadPool(threadPool),
+numberOfThreads(threadPool == nullptr ? 1
+                : numberOfThreads == 0 ? threadPool->getNumberOfThreads() + 1
+                : std::min(numberOfThreads, threadPool->getNumberOfThreads() + 1)){}
+
+ParsedTuples TupleReader::read(const std::filesystem::path& inputPath) const {
+    const MappedFile inputFile(inputPath);
+    std::vector<Chunk> chunks = splitIntoChunks(inputFile.getData(), inputFile.getSize());
+
+    forEachChunkInParallel(chunks, threadPool, [](Chunk& chunk) { countTuples(chunk); });
+    std::size_t numberOfData = 0;
+    std::size_t numberOfLines = 0;
+    for (auto& chunk : chunks) {
+        chunk.firstDatum = numberOfData;
+        chunk.firstLineNumber = numberOfLines + 1;
+        numberOfData += chunk.numberOfData;
+        numberOfLines += chunk.numberOfLines;
+    }
+
+    const std::size_t numberOfAttributes = countValuesInFirstTuple(chunks);
+    ParsedTuples parsedTuples{numberOfData, numberOfAttributes, std::vector<double>(numberOfData * numberOfAttributes)};
+    forEachChunkInParallel(chunks, threadPool, [&parsedTuples](Chunk& chunk) { parseTuples(chunk, parsedTuples); });
+
+    std::size_t numberOfMalformedLines = 0;
+    std::string errorMessage = inputPath.string() + " contains malformed lines";
+    for (const auto& chunk : chunks) {
+        for (const auto& malformedLine : chunk.malformedLines) {
+            if (numberOfMalformedLines++ < MAX_REPORTED_MALFORMED_LINES) {
+                errorMessage += "\n" + malformedLine;
+            }
+        }
+    }
+    if (numberOfMalformedLines > 0) {
+        if (numberOfMalformedLines > MAX_REPORTED_MALFORMED_LINES) {
+            errorMessage += "\nand " + std::to_string(numberOfMalformedLines - MAX_REPORTED_MALFORMED_LINES) + " more";
+        }
+        throw std::runtime_error(errorMessage);
+    }
+    return parsedTuples;
+}
+
+std::vector<TupleReader::Chunk> TupleReader::splitIntoChunks(const char* data, std::size_t size) const {
+    const std::size_t numberOfChunks = std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads,
+                                                                                       size / MINIMAL_CHUNK_SIZE));
+    std::vector<Chunk> chunks;
+    chunks.reserve(numberOfChunks);
+    const char* end = data + size;
+    const char* chunkBegin = data;
+    for (std::size_t i = 1; i <= numberOfChunks && chunkBegin < end; ++i) {
+        const char* chunkEnd = i == numberOfChunks ? end : data + size / numberOfChunks * i;
+        if (chunkEnd < chunkBegin) {
+            chunkEnd = chunkBegin;
+        }
+        chunkEnd = chunkEnd == end ? end : findLineEnd(chunkEnd, end);
+        if (chunkEnd < end) {
+            ++chunkEnd;
+        }
+        chunks.push_back(Chunk{chunkBegin, chunkEnd, 0, 0, 0, 0, {}});
+        chunkBegin = chunkEnd;
+    }
+    return chunks;
+}
+
+void TupleReader::countTuples(Chunk& chunk) {
+    for (const char* lineBegin = chunk.begin; lineBegin < chunk.end;) {
+        const char* lineEnd = findLineEnd(lineBegin, chunk.end);
+        chunk.numberOfLines++;
+        if (!TupleLines::isBlank(lineBegin, lineEnd)) {
+            chunk.numberOfData++;
+        }
+        lineBegin = findNextLineBegin(lineEnd, chunk.end);
+    }
+}
+
+void TupleReader::parseTuples(Chunk& chunk, ParsedTuples& parsedTuples) {
+    const std::size_t numberOfData = parsedTuples.numberOfData;
+    const std::size_t numberOfAttributes = parsedTuples.numberOfAttributes;
+    double* values = parsedTuples.attributeMajorData.data();
+    std::size_t datum = chunk.firstDatum;
+    std::size_t lineNumber = chunk.firstLineNumber;
+    for (const char* lineBegin = chunk.begin; lineBegin < chunk.end; ++lineNumber) {
+        const char* lineEnd = findLineEnd(lineBegin, chunk.end);
+        if (!TupleLines::isBlank(lineBegin, lineEnd)) {
+            std::string problem = TupleLines::parseValues(lineBegin, lineEnd, numberOfAttributes,
+                                                          values + datum, numberOfData);
+            if (!problem.empty()) {
+                chunk.malformedLines.push_back(TupleLines::describeMalformedLine(lineNumber, problem));
+            }
+            ++datum;
+        }
+        lineBegin = findNextLineBegin(lineEnd, chunk.end);
+    }
+}
+
+std::size_t TupleReader::countValuesInFirstTuple(const std::vector<Chunk>& chunks) {
+    for (const auto& chunk : chunks) {
+        for (const char* lineBegin = chunk.begin; lineBegin < chunk.end;) {
+            const char* lineEnd = findLineEnd(lineBegin, chunk.end);
+            const std::size_t numberOfValues = TupleLines::countValues(lineBegin, lineEnd);
+            if (numberOfValues > 0) {
+                return numberOfValues;
+            }
+            lineBegin = findNextLineBegin(lineEnd, chunk.end);
+        }
+    }
+    return 0;
+}
@@ -1,25 +1,70 @@
 #include <streams/TupleWriter.hpp>
 #include <datageneration/LinearRegressionDataGenerator.hpp>
+#include <concurrency/ThreadPool.hpp>
 
+#include <algorithm>
+#include <charconv>
+#include <deque>
 #include <iostream>
+#include <vector>
 
-TupleWriter::TupleWriter(LinearRegressionDataGenerator& dataGenerator,
-                         const unsigned int numberOfTuplesToGenerate) noexcept
+namespace {
+    // longest shortest-round-trip representation of a double, e.g. -2.2250738585072014e-308, and a separator
+    const std::size_t MAX_FORMATTED_VALUE_LENGTH = 25;
+}
+
+TupleWriter::TupleWriter(const LinearRegressionDataGenerator& dataGenerator,
+                         const std::size_t numberOfTuplesToGenerate,
+                         const unsigned int numberOfThreads) noexcept
                          : dataGenerator(dataGenerator),
-                           numberOfTuplesToGenerate(numberOfTuplesToGenerate){}
+                           numberOfTuplesToGenerate(numberOfTuplesToGenerate),
+                           numberOfThreads(numberOfThreads == 0 ? ThreadPool::defaultNumberOfThreads() : numberOfThreads){}
 
 void TupleWriter::generateTuplesAndSaveWithFilename(const std::filesystem::path&& outputPath) {
-    std::ofstream outputFile(outputPath);
+    std::ofstream outputFile(outputPath, std::ios::binary);
     if (!outputFile.is_open()){
         std::cout << "File was not opened correctly";
         throw "File was not opened correctly";
     }
-    for (int i = 0; i < numberOfTuplesToGenerate; ++i) {
-        auto tuple = dataGenerator.generateTupleValue();
-        for (const auto &item : tuple){
-            outputFile << item << " ";
+    ThreadPool threadPool(numberOfThreads);
+    // at most two chunks per thread are kept in memory while the file is written
+    const std::size_t maxChunksInFlight = 2 * (std::size_t) numberOfThreads;
+    std::deque<std::future<std::string>> formattedChunks;
+    std::size_t nextTupleNumber = 0;
+    while (nextTupleNumber < numberOfTuplesToGenerate || !formattedChunks.empty()) {
+        while (nextTupleNumber < numberOfTuplesToGenerate && formattedChunks.size() < maxChunksInFlight) {
+            const std::size_t numberOfTuples = std::min(TUPLES_PER_CHUNK, numberOfTuplesToGenerate - nextTupleNumber);
+            formattedChunks.push_back(threadPool.submit([this, nextTupleNumber, numberOfTuples]() {
+                return formatChunk(nextTupleNumber, numberOfTuples);
+            }));
+            nextTupleNumber += numberOfTuples;
         }
-        outputFile << "\n";
+        const std::string formattedChunk = formattedChunks.front().get();
+        formattedChunks.pop_front();
+        outputFile.write(formattedChunk.data(), (std::streamsize) formattedChunk.size());
     }
     outputFile.close();
+    if (outputFile.fail()) {
+        std::cout << "File was not written correctly";
+        throw "File was not written correctly";
+    }
+}
+
+std::string TupleWriter::formatChunk(std::size_t firstTupleNumber, std::size_t numberOfTuples) const {
+    const std::size_t numberOfAttributes = dataGenerator.getNumberOfAttributes();
+    std::vector<double> tuples(numberOfTuples * numberOfAttributes);
+    dataGenerator.generateTuples(firstTupleNumber, numberOfTuples, tuples.data());
+
+    std::string formattedChunk(numberOfTuples * (numberOfAttributes * MAX_FORMATTED_VALUE_LENGTH + 1), '\0');
+    char* position = formattedChunk.data();
+    char* const end = formattedChunk.data() + formattedChunk.size();
+    for (std::size_t tuple = 0; tuple < numberOfTuples; ++tuple) {
+        for (std::size_t attribute = 0; attribute < numberOfAttributes; ++attribute) {
+            position = std::to_chars(position, end, tuples[tuple * numberOfAttributes + attribute]).ptr;
+            *position++ = ' ';
+        }
+        *position++ = '\n';
+    }
+    formattedChunk.resize((std::size_t) (position - formattedChunk.data()));
+    return formattedChunk;
 }
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define FUZZY_REGRESSION_HAS_GETRUSAGE 1
+#endif
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "telemetry/Telemetry.hpp"
+
+namespace {
+    thread_local int numberOfClustersOnThisThread = 0;
+#ifdef FUZZY_REGRESSION_TELEMETRY
+    // plain thread-local counters keep operator new free of synchronisation
+    thread_local std::uint64_t allocationCount = 0;
+    thread_local std::uint64_t allocatedByteCount = 0;
+
+    // without a recorder nobody reads the counters, so an allocation only pays for one atomic load
+    inline void countAllocation(std::size_t size) {
+        if (Telemetry::active() != nullptr) {
+            ++allocationCount;
+            allocatedByteCount += size;
+        }
+    }
+#endif
+
+    // the trace event format counts microseconds, written with exactly three decimals
+    void writeMicroseconds(std::ostream& outputStream, std::uint64_t nanoseconds) {
+        outputStream << nanoseconds / 1000 << "." << std::setw(3) << std::setfill('0') << nanoseconds % 1000
+                     << std::setfill(' ');
+    }
+}
+
+#ifdef FUZZY_REGRESSION_TELEMETRY
+// replaced so that scopes can report the allocations made inside them; memory still comes from malloc
+// the nothrow forms are not replaced, by default they call these
+void* operator new(std::size_t size) {
+    countAllocation(size);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    countAllocation(size);
+    const auto alignmentBytes = static_cast<std::size_t>(alignment);
+    // aligned_alloc takes only sizes which are a multiple of the alignment
+    const std::size_t alignedSize = ((size == 0 ? 1 : size) + alignmentBytes - 1) / alignmentBytes * alignmentBytes;
+#ifdef _WIN32
+    void* memory = _aligned_malloc(alignedSize, alignmentBytes);
+#else
+    void* memory = std::aligned_alloc(alignmentBytes, alignedSize);
+#endif
+    if (memory != nullptr) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    ::operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    ::operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    ::operator delete(memory, alignment);
+}
+#endif
+
+std::atomic<Telemetry*> Telemetry::activeRecorder{nullptr};
+
+Telemetry::Telemetry()
+: originNanoseconds(now()) {
+    Telemetry* expected = nullptr;
+    if (!activeRecorder.compare_exchange_strong(expected, this)) {
+        throw std::logic_error("Only one telemetry recorder can be active");
+    }
+}
+
+Telemetry::~Telemetry() {
+    activeRecorder.store(nullptr);
+}
+
+TelemetryFormat Telemetry::parseFormat(const std::string& formatName) {
+    if (formatName == "csv") {
+        return TelemetryFormat::CSV;
+    }
+    if (formatName == "jsonl") {
+        return TelemetryFormat::JSON_LINES;
+    }
+    if (formatName == "chrome") {
+        return TelemetryFormat::CHROME_TRACE;
+    }
+    throw std::invalid_argument("Telemetry format has to be csv, jsonl or chrome");
+}
+
+std::string Telemetry::fileExtension(TelemetryFormat format) {
+    switch (format) {
+        case TelemetryFormat::CSV:
+            return ".csv";
+        case TelemetryFormat::JSON_LINES:
+            return ".jsonl";
+        default:
+            return ".json";
+    }
+}
+
+std::uint64_t Telemetry::now() {
+    return (std::uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::uint64_t Telemetry::allocationsOnThisThread() {
+#ifdef FUZZY_REGRESSION_TELEMETRY
+    return allocationCount;
+#else
+    return 0;
+#endif
+}
+
+std::uint64_t Telemetry::allocatedBytesOnThisThread() {
+#ifdef FUZZY_REGRESSION_TELEMETRY
+    return allocatedByteCount;
+#else
+    return 0;
+#endif
+}
+
+std::uint64_t Telemetry::peakResidentBytes() {
+#ifdef FUZZY_REGRESSION_HAS_GETRUSAGE
+    struct rusage usage{};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return (std::uint64_t) usage.ru_maxrss;
+#else
+    // kilobytes on Linux and the BSDs
+    return (std::uint64_t) usage.ru_maxrss * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void Telemetry::setNumberOfClusters(int numberOfClusters) {
+    numberOfClustersOnThisThread = numberOfClusters;
+}
+
+void Telemetry::recordDuration(const char* name,
+                               std::uint64_t startNanoseconds,
+                               std::uint64_t endNanoseconds,
+                               std::uint64_t allocations,
+                               std::uint64_t allocatedBytes) {
+    const Event event{name, false, threadNumber(), numberOfClustersOnThisThread,
+                      startNanoseconds - originNanoseconds, endNanoseconds - startNanoseconds, 0.0,
+                      allocations, allocatedBytes};
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    events.push_back(event);
+}
+
+void Telemetry::recordCounter(const char* name, double value) {
+    const Event event{name, true, threadNumber(), numberOfClustersOnThisThread,
+                      now() - originNanoseconds, 0, value, 0, 0};
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    events.push_back(event);
+}
+
+void Telemetry::write(std::ostream& outputStream, TelemetryFormat format) const {
+    std::vector<Event> sortedEvents;
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        sortedEvents = events;
+    }
+    // scopes are recorded when they end, sorting by start puts enclosing scopes before the ones inside them
+    std::stable_sort(sortedEvents.begin(), sortedEvents.end(), [](const Event& first, const Event& second) {
+        return first.startNanoseconds < second.startNanoseconds;
+    });
+    const auto previousPrecision = outputStream.precision(std::numeric_limits<double>::max_digits10);
+    switch (format) {
+        case TelemetryFormat::CSV:
+            writeCsv(outputStream, sortedEvents);
+            break;
+        case TelemetryFormat::JSON_LINES:
+            writeJsonLines(outputStream, sortedEvents);
+            break;
+        case TelemetryFormat::CHROME_TRACE:
+            writeChromeTrace(outputStream, sortedEvents);
+            break;
+    }
+    outputStream.precision(previousPrecision);
+}
+
+std::uint32_t Telemetry::threadNumber() {
+    static std::atomic<std::uint32_t> nextThreadNumber{1};
+    thread_local const std::uint32_t number = nextThreadNumber++;
+    return number;
+}
+
+void Telemetry::writeCsv(std::ostream& outputStream, const std::vector<Event>& sortedEvents) const {
+    outputStream << "name;type;thread;numberOfClusters;startNs;durationNs;value;allocations;allocatedBytes\n";
+    for (const auto& event : sortedEvents) {
+        outputStream << event.name << ";"
+                     << (event.counter ? "counter" : "duration") << ";"
+                     << event.threadNumber << ";"
+                     << event.numberOfClusters << ";"
+                     << event.startNanoseconds << ";"
+                     << event.durationNanoseconds << ";"
+                     << event.value << ";"
+                     << event.allocations << ";"
+                     << event.allocatedBytes << "\n";
+    }
+}
+
+void Telemetry::writeJsonLines(std::ostream& outputStream, const std::vector<Event>& sortedEvents) const {
+    for (const auto& event : sortedEvents) {
+        outputStream << "{\"name\": \"" << event.name << "\""
+                     << ", \"thread\": " << event.threadNumber
+                     << ", \"numberOfClusters\": " << event.numberOfClusters
+                     << ", \"startNs\": " << event.startNanoseconds;
+        if (event.counter) {
+            outputStream << ", \"value\": " << event.value;
+        } else {
+            outputStream << ", \"durationNs\": " << event.durationNanoseconds
+                         << ", \"allocations\": " << event.allocations
+                         << ", \"allocatedBytes\": " << event.allocatedBytes;
+        }
+        outputStream << "}\n";
+    }
+}
+
+void Telemetry::writeChromeTrace(std::ostream& outputStream, const std::vector<Event>& sortedEvents) const {
+    outputStream << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    for (std::size_t i = 0; i < sortedEvents.size(); ++i) {
+        const auto& event = sortedEvents[i];
+        outputStream << "{\"name\": \"" << event.name << "\", \"pid\": 1, \"tid\": " << event.threadNumber
+                     << ", \"ts\": ";
+        writeMicroseconds(outputStream, event.startNanoseconds);
+        if (event.counter) {
+            outputStream << ", \"ph\": \"C\", \"args\": {\"value\": " << event.value << "}";
+        } else {
+            outputStream << ", \"ph\": \"X\", \"dur\": ";
+            writeMicroseconds(outputStream, event.durationNanoseconds);
+            outputStream << ", \"args\": {\"numberOfClusters\": " << event.numberOfClusters
+                         << ", \"allocations\": " << event.allocations
+                         << ", \"allocatedBytes\": " << event.allocatedBytes << "}";
+        }
+        outputStream << "}" << (i + 1 < sortedEvents.size() ? "," : "") << "\n";
+    }
+    outputStream << "]}\n";
+}